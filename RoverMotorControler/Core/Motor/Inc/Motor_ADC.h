@@ -0,0 +1,120 @@
+/*Motor_ADC.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+
+/*
+ * Current sensing of the wheel bridges and battery voltage on ADC1 and ADC2
+ *
+ * HARDWARE
+ * 1. Current amplifiers of the bridges (output at mid-scale for zero current), injected channels:
+ * 		- wheel 0: ADC1 IN3 PA2, wheel 1: ADC1 IN4 PA3
+ * 		- wheel 2: ADC2 IN17 PA4, wheel 3: ADC2 IN13 PA5
+ * 2. Battery voltage through divider MOTOR_ADC_BATTERY_DIVIDER: ADC1 IN12 PB1, VREFINT (ADC1 IN18) measures VDDA
+ * 3. ADC clock is synchronous HCLK / 4, so delay from trigger to sampling is always the same number of cycles
+ *
+ * ALGORITHM
+ * 1. TIM1 TRGO2 (OC4REF, active only at the valley of the center-aligned counter, middle of the on-time of all wheels,
+ *    TIM8 runs in phase) starts injected conversions of both ADCs at once, switching noise of the bridges is far away
+ * 2. End of injected sequence of ADC2 (same length and sampling time as ADC1, so both are finished) raises ADC1_2 interrupt,
+ *    Motor_ADC_Interrupt_Callback() copies the results to the back buffer and flips Index, Motor_ADC_Get_Currents()
+ *    reads the front buffer, so control tick never sees currents of two different periods
+ * 		- writer runs once per PWM period and reader copies four values, so the buffer being read can't be rewritten
+ * 3. Analog watchdog 1 of both ADCs checks every injected conversion against Offset +- CurrentLimit,
+ *    over-current forces break of TIM1 and TIM8 (BG), bridges turn off like on the break input and
+ *    Motor_PWM_Check_Fault() reports it
+ * 4. Regular channels (battery, VREFINT) of ADC1 are converted continuously in the gaps between injected conversions,
+ *    hardware oversampling averages 256 samples to 16bit result and DMA1 channel 5 (DMAMUX1 channel 4) writes them
+ *    to Regular circularly, CPU never touches them until Motor_ADC_Get_Battery() is called
+ *
+ * Currents are Q15 fractions of the full scale of the amplifier, MOTOR_ADC_CURRENT_OFFSET is zero.
+ * In host build (HOST_BUILD) currents come from the virtual rover and battery voltage is constant
+ * */
+#ifndef MOTOR_ADC_H_
+#define MOTOR_ADC_H_
+
+/*Number of current channels, one per wheel*/
+#define MOTOR_ADC_CURRENT_CHANNELS 4U
+/*Number of regular channels: battery, VREFINT*/
+#define MOTOR_ADC_REGULAR_CHANNELS 2U
+
+/*12bit result of zero current*/
+#define MOTOR_ADC_CURRENT_OFFSET 2048U
+/*Default over-current threshold, 12bit distance from the offset (about 90% of full scale)*/
+#define MOTOR_ADC_CURRENT_LIMIT 1843U
+
+/*Ratio of the battery voltage divider*/
+#define MOTOR_ADC_BATTERY_DIVIDER 11U
+
+/*Priority of ADC interrupt, it only copies results, so it preempts the control tick*/
+#define MOTOR_ADC_IRQ_PRIORITY 0U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_ADC_OK, //Everything fine
+	MOTOR_ADC_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_ADC_RANGE_ERROR, //current limit out of range
+	MOTOR_ADC_TIMEOUT_ERROR //ADC didn't finish calibration or didn't become ready
+} Motor_ADCStatusTypeDef;
+
+/*
+ * Results of all conversions
+ * */
+typedef struct {
+	//currents of all wheels (Q15), Index is the buffer with the newest complete set
+	volatile int16_t Current[2][MOTOR_ADC_CURRENT_CHANNELS];
+	volatile uint8_t Index;
+	//number of finished injected sequences
+	volatile uint32_t SampleCount;
+
+	//oversampled battery and VREFINT (16bit), written by DMA
+	volatile uint16_t Regular[MOTOR_ADC_REGULAR_CHANNELS];
+
+	//12bit distance from MOTOR_ADC_CURRENT_OFFSET which turns the bridges off
+	uint16_t CurrentLimit;
+	//number of over-current trips
+	volatile uint32_t OverCurrentCount;
+} Motor_ADCTypeDef;
+
+/*
+ * @brief Calibrates and enables ADC1 and ADC2, injected conversions wait for TIM1 TRGO2 (Motor_PWM_Init()),
+ * regular conversions start at once
+ *
+ * @param pADC pointer to results
+ * @param current_limit over-current threshold, 12bit distance from the offset (1 - MOTOR_ADC_CURRENT_OFFSET - 1)
+ *
+ * @retval Motor_ADCStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ADCStatusTypeDef Motor_ADC_Init(Motor_ADCTypeDef* pADC, uint16_t current_limit);
+
+/*
+ * @brief Copies the newest currents of all wheels, no argument checks, it is called from control interrupt
+ *
+ * @param pADC pointer to results
+ * @param pCurrent currents (MOTOR_ADC_CURRENT_CHANNELS values, Q15)
+ * */
+extern void Motor_ADC_Get_Currents(Motor_ADCTypeDef* pADC, int16_t* pCurrent);
+
+/*
+ * @brief Battery voltage, VDDA is measured with VREFINT and its factory calibration
+ *
+ * @param pADC pointer to results
+ *
+ * @retval uint32_t battery voltage in millivolts, 0 if no regular conversion finished yet
+ * */
+extern uint32_t Motor_ADC_Get_Battery(Motor_ADCTypeDef* pADC);
+
+/*
+ * @brief callback that should be called in ADC1_2_IRQHandler(), stores injected results and handles over-current
+ *
+ * @param pADC pointer to results
+ *
+ * @retval Motor_ADCStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ADCStatusTypeDef Motor_ADC_Interrupt_Callback(Motor_ADCTypeDef* pADC);
+
+#endif
@@ -0,0 +1,241 @@
+/*Motor_Control.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_PID.h"
+#include "Motor_Encoder.h"
+#include "Motor_PWM.h"
+#include "Motor_Trajectory.h"
+#include "Motor_Filter.h"
+#include "Motor_ADC.h"
+#include "Motor_Telemetry.h"
+
+/*
+ * Velocity control of the rover wheels
+ *
+ * ALGORITHM
+ * 1. Motor_Control_Init() configures basic timer TIM6 to overflow at the control rate (1-20kHz),
+ *    Motor_Control_Start() enables the counter and its update interrupt
+ * 2. TIM6 interrupt has higher priority than USART1, so control rate doesn't depend on UART traffic,
+ *    TIM6_DAC_IRQHandler() calls Motor_Control_Timer_Interrupt_Callback()
+ * 3. Every tick estimates speed of each wheel with Motor_Encoder_Update(), speeds of all wheels are filtered
+ *    by Motor_Filter (FMAC, bypass until Motor_Control_Set_Filter() is called) while position setpoints are calculated,
+ *    then Motor_PID_Update() runs with setpoint and filtered speed, output (Q15 duty, negative means reverse) is written to Motor_PWM
+ * 		- currents sampled by Motor_ADC in the middle of the last PWM period are copied to the wheels
+ * 		- when break input of the bridges or over-current detected by Motor_ADC turned the outputs off, controllers are held in reset until
+ * 		  Motor_Control_Start() enables the outputs again
+ * 		- speed, current, duty and speed error of all wheels are passed to Motor_Telemetry at the end of the tick
+ * 4. Speed setpoints of all wheels are one block, triple buffered between commands and the control tick without locking:
+ * 		- Motor_Control_Set_Speed() / Motor_Control_Set_Speeds() copy the last published block to the back block, change it
+ * 		  and publish it by one exclusive exchange of the shared index (LDREXB/STREXB, retried if the tick took the block meanwhile)
+ * 		- the tick takes the published block with one index swap at its start, so all wheels of one command
+ * 		  change in the same tick, duties of all wheels are written with update events of TIM1/TIM8 held
+ * 		  (Motor_PWM_Hold_Update()), so they start together in the next PWM period
+ * 		- every speed command increments the sequence number of its wheel, tick returns only those wheels to speed mode,
+ * 		  so commands of other wheels don't interrupt position mode
+ * 		- writer is the main loop (frame callbacks), functions must not be called from interrupts
+ * 5. Motor_Control_Set_Position() switches the wheel to position mode and queues the waypoint, then every tick
+ *    Motor_Trajectory_Update() gives reference position and velocity and the setpoint is
+ *    velocity + MOTOR_CONTROL_POSITION_GAIN * (reference position - encoder position),
+ *    Motor_Control_Set_Speed() returns the wheel to speed mode
+ *
+ * Speeds are Q15 fractions of the maximum wheel speed (encoder counts per second given to Motor_Control_Init()).
+ * In host build (HOST_BUILD) there is no timer, virtual rover calls the interrupt callback on every SysTick
+ * */
+#ifndef MOTOR_CONTROL_H_
+#define MOTOR_CONTROL_H_
+
+/*Number of driven wheels*/
+#define MOTOR_WHEEL_COUNT 4U
+
+/*Range of the control rate in Hz, duty is applied once per PWM period so faster loop is useless*/
+#define MOTOR_CONTROL_RATE_MIN 1000U
+#define MOTOR_CONTROL_RATE_MAX MOTOR_PWM_FREQUENCY
+
+/*Q15 speed added per count of position error in position mode*/
+#define MOTOR_CONTROL_POSITION_GAIN 64
+
+/*Priority of the control interrupt, USART1 has 7 so control loop preempts communication*/
+#define MOTOR_CONTROL_IRQ_PRIORITY 1U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_CONTROL_OK, //Everything fine
+	MOTOR_CONTROL_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_CONTROL_RANGE_ERROR, //wheel index or control rate out of range
+	MOTOR_CONTROL_FULL_ERROR, //waypoint queue of the wheel is full
+	MOTOR_CONTROL_FAULT_ERROR //break input of the bridges is still active, outputs stay off
+} Motor_ControlStatusTypeDef;
+
+/*
+ * State of a single wheel
+ * */
+typedef struct {
+	//speed controller
+	Motor_PIDTypeDef PID;
+	//desired speed (Q15), taken from the setpoint block or computed by the control tick in position mode
+	volatile int16_t Setpoint;
+	//sequence number of the last speed command applied by the tick
+	uint8_t SpeedSequence;
+	//position trajectory, it is used only in position mode
+	Motor_TrajectoryTypeDef Trajectory;
+	//Flag if the setpoint comes from the trajectory
+	volatile bool PositionMode;
+	//speed and position feedback
+	Motor_EncoderTypeDef Encoder;
+	//measured speed (Q15)
+	int16_t Measured;
+	//duty computed on the last tick (Q15)
+	int16_t Output;
+	//current of the bridge sampled in the last PWM period (Q15)
+	int16_t Current;
+} Motor_WheelTypeDef;
+
+/*Number of setpoint blocks: one read by the tick, one edited by commands, one handed over*/
+#define MOTOR_CONTROL_SETPOINTS_BUFFERS 3U
+/*Flag in the shared setpoint index, block was published and the tick hasn't taken it yet*/
+#define MOTOR_CONTROL_SETPOINTS_FRESH 0x80U
+
+/*
+ * Speed setpoints of all wheels published at once
+ * */
+typedef struct {
+	//desired speed (Q15)
+	int16_t Speed[MOTOR_WHEEL_COUNT];
+	//incremented by every speed command of the wheel
+	uint8_t Sequence[MOTOR_WHEEL_COUNT];
+} Motor_SetpointsTypeDef;
+
+/*
+ * Structure that handles all wheels and the control timer
+ * */
+typedef struct {
+	Motor_WheelTypeDef Wheels[MOTOR_WHEEL_COUNT];
+
+	//H-bridge outputs of all wheels
+	Motor_PWMTypeDef PWM;
+	//filter of measured speeds, one channel per wheel
+	Motor_FilterTypeDef SpeedFilter;
+	//currents of the bridges and battery voltage
+	Motor_ADCTypeDef ADC;
+	//decimated signals of the wheels, sampled by the tick and sent by the main loop
+	Motor_TelemetryTypeDef Telemetry;
+
+	//setpoint blocks: Front is read by the tick, Back is edited by commands, Shared is handed over between them
+	Motor_SetpointsTypeDef Setpoints[MOTOR_CONTROL_SETPOINTS_BUFFERS];
+	uint8_t SetpointsFront;
+	volatile uint8_t SetpointsShared;
+	uint8_t SetpointsBack;
+	//block published last, the next command starts from its copy
+	uint8_t SetpointsLast;
+
+	//control rate in Hz the timer was configured for
+	uint32_t Rate;
+	//encoder counts per second at full speed
+	uint32_t MaxSpeed;
+	//Rate * MOTOR_Q15_ONE / MaxSpeed, converts trajectory velocity (Q24 counts per tick) to Q15 speed
+	uint32_t VelocityScale;
+	//number of control ticks since start
+	volatile uint32_t TickCount;
+	//Flag if control timer is running
+	bool Running;
+} Motor_ControlTypeDef;
+
+/*
+ * @brief Initializes wheels with default PID gains, encoders, PWM, current sensing and control timer, timer is not started
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param rate control rate in Hz (MOTOR_CONTROL_RATE_MIN - MOTOR_CONTROL_RATE_MAX)
+ * @param max_speed encoder counts per second of the wheel at full speed
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Init(Motor_ControlTypeDef* pControl, uint32_t rate, uint32_t max_speed);
+
+/*
+ * @brief Enables bridge outputs (clears fault) and starts control timer and its interrupt
+ *
+ * @param pControl pointer to Motor_Control handle
+ *
+ * @retval Motor_ControlStatusTypeDef MOTOR_CONTROL_FAULT_ERROR if break input is still active, timer is then not started
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Start(Motor_ControlTypeDef* pControl);
+
+/*
+ * @brief Stops control timer, bridge outputs are disabled and controllers are reset
+ *
+ * @param pControl pointer to Motor_Control handle
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Stop(Motor_ControlTypeDef* pControl);
+
+/*
+ * @brief Sets desired speed of the wheel, it is used from the next control tick, wheel leaves position mode,
+ * call it only from the main loop
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param wheel index of the wheel
+ * @param speed desired speed (Q15 fraction of the maximum speed)
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Set_Speed(Motor_ControlTypeDef* pControl, uint8_t wheel, int16_t speed);
+
+/*
+ * @brief Sets desired speed of all wheels, they change in the same control tick and leave position mode,
+ * call it only from the main loop
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param pSpeed desired speeds (MOTOR_WHEEL_COUNT values, Q15 fractions of the maximum speed)
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Set_Speeds(Motor_ControlTypeDef* pControl, const int16_t* pSpeed);
+
+/*
+ * @brief Queues waypoint of the wheel, wheel in speed mode switches to position mode and the profile starts
+ * from its current position and speed, interrupts are disabled for the time of the update
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param wheel index of the wheel
+ * @param position target position (encoder counts)
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Set_Position(Motor_ControlTypeDef* pControl, uint8_t wheel, int32_t position);
+
+/*
+ * @brief Replaces gains and limits of the wheel controller, interrupts are disabled for the time of the copy
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param wheel index of the wheel
+ * @param pConfig pointer to gains and limits
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Set_Gains(Motor_ControlTypeDef* pControl, uint8_t wheel, const Motor_PIDConfigTypeDef* pConfig);
+
+/*
+ * @brief Replaces filter of measured speeds (same for all wheels), interrupts are disabled while FMAC is configured
+ *
+ * @param pControl pointer to Motor_Control handle
+ * @param pConfig pointer to filter coefficients
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Set_Filter(Motor_ControlTypeDef* pControl, const Motor_FilterConfigTypeDef* pConfig);
+
+/*
+ * @brief callback that should be called in TIM6_DAC_IRQHandler(), clears update flag and runs one control tick
+ *
+ * @param pControl pointer to Motor_Control handle
+ *
+ * @retval Motor_ControlStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_ControlStatusTypeDef Motor_Control_Timer_Interrupt_Callback(Motor_ControlTypeDef* pControl);
+
+#endif
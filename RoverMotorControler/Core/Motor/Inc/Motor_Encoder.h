@@ -0,0 +1,101 @@
+/*Motor_Encoder.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+
+/*
+ * Quadrature encoders of the wheels with M/T method velocity estimation
+ *
+ * HARDWARE (no interrupt per encoder edge)
+ * 1. TIM2-TIM5 work in encoder mode (x4, every edge of A and B is counted), one timer per wheel:
+ * 		- wheel 0: TIM2 PA15 (A) PB3 (B), wheel 1: TIM3 PB4 PB5, wheel 2: TIM4 PB6 PB7, wheel 3: TIM5 PA0 PA1
+ * 2. Channel 1 of the encoder timer also captures the counter on every rising edge of A,
+ *    so CCR1 holds position of the last edge
+ * 3. The same capture event requests DMA, which copies counter of free running TIM7 (1MHz time base)
+ *    into EdgeTime, so time of the last edge is known with 1us resolution
+ *
+ * ALGORITHM (Motor_Encoder_Update(), called on every control tick)
+ * 1. Position is advanced by the difference of the counter since the previous tick
+ * 2. If there were edges since the previous tick, speed = (edge position - previous edge position) / (edge time - previous edge time)
+ * 		- both values come from the same edges, so the result is exact at crawl (few edges) and at full speed (many edges)
+ * 		- when previous edge is older than 16bit time base can measure, time of the ticks is used instead
+ * 3. If there were no edges, speed can't be higher than one edge over the time since the last one,
+ *    so the estimate decays to 0 when wheel stops
+ *
+ * Speed is Q15 fraction of MaxSpeed (counts per second), calculated with one 32bit division
+ * */
+#ifndef MOTOR_ENCODER_H_
+#define MOTOR_ENCODER_H_
+
+/*Frequency of the edge time base (TIM7)*/
+#define MOTOR_ENCODER_TIME_BASE_HZ 1000000U
+/*Time base wraps after 65.5ms, intervals longer than that are measured with control ticks*/
+#define MOTOR_ENCODER_TIME_BASE_LIMIT_US 60000U
+/*Counts between two captured edges (rising edges of A in x4 mode)*/
+#define MOTOR_ENCODER_COUNTS_PER_EDGE 4
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_ENCODER_OK, //Everything fine
+	MOTOR_ENCODER_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_ENCODER_RANGE_ERROR //index of the encoder, rate or max speed out of range
+} Motor_EncoderStatusTypeDef;
+
+/*
+ * State of a single encoder
+ * */
+typedef struct {
+	//index of the encoder (and its timer)
+	uint8_t Index;
+
+	//counts per second which give speed MOTOR_Q15_ONE
+	uint32_t MaxSpeed;
+	//MOTOR_Q15_ONE * MOTOR_ENCODER_TIME_BASE_HZ / MaxSpeed, speed = counts * SpeedScale / microseconds
+	uint32_t SpeedScale;
+	//length of the control tick in microseconds
+	uint32_t TickTime;
+
+	//written by DMA, time base counter captured on the last edge
+	volatile uint16_t EdgeTime;
+
+	//counter value read on the previous tick
+	uint16_t PreviousCount;
+	//absolute position in counts
+	int32_t Position;
+
+	//position and time of the last edge used for the estimate
+	uint16_t EdgePosition;
+	uint16_t PreviousEdgeTime;
+	//ticks since that edge (saturated)
+	uint32_t TicksSinceEdge;
+
+	//last estimate (Q15)
+	int16_t Speed;
+} Motor_EncoderTypeDef;
+
+/*
+ * @brief Configures encoder timer, its pins and DMA of edge time, starts time base timer
+ *
+ * @param pEncoder pointer to encoder
+ * @param index index of the wheel (0-3)
+ * @param rate control rate in Hz
+ * @param max_speed counts per second which give speed MOTOR_Q15_ONE
+ *
+ * @retval Motor_EncoderStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_EncoderStatusTypeDef Motor_Encoder_Init(Motor_EncoderTypeDef* pEncoder, uint8_t index, uint32_t rate, uint32_t max_speed);
+
+/*
+ * @brief Updates position and speed estimate, no argument checks, it is called from control interrupt
+ *
+ * @param pEncoder pointer to encoder
+ *
+ * @retval int16_t speed (Q15)
+ * */
+extern int16_t Motor_Encoder_Update(Motor_EncoderTypeDef* pEncoder);
+
+#endif
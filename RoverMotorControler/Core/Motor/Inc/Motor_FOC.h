@@ -0,0 +1,106 @@
+/*Motor_FOC.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+#include "Motor_PID.h"
+#include "Motor_PWM.h"
+
+/*
+ * Field oriented current control of BLDC motors, trigonometry runs on the CORDIC coprocessor
+ *
+ * ALGORITHM (Motor_FOC_Update(), once per PWM period for all motors)
+ * 1. Clarke: alpha = a, beta = (a + 2b) / sqrt(3)
+ * 2. Park with cos/sin of the electrical angle: d = alpha*cos + beta*sin, q = beta*cos - alpha*sin
+ * 3. PI controllers of d (flux, usually 0) and q (torque) current give voltages Vd, Vq
+ * 4. Inverse Park gives Valpha, Vbeta
+ * 5. Space vector modulation (min-max injection): phase voltages are shifted by the mean of the largest and the smallest,
+ *    which gives the same line voltages as SVM sectors, voltage 1 (MOTOR_Q15_ONE) is the largest one without distortion
+ *    (Vdc / sqrt(3)), longer vectors are clipped, duty 50% is zero voltage
+ * 6. Duties are written with Motor_PWM_Set_Phases() by the caller (MOTOR_PWM_THREE_PHASE)
+ *
+ * CORDIC (zero-overhead mode, no interrupt or DMA)
+ * 		- q1.15 arguments and results, both arguments in one 32bit write and both results in one 32bit read,
+ * 		  angle is int16_t where 32768 is pi, so it wraps like the angle itself
+ * 		- reading result before it is ready stalls the bus instead of polling, so there is no flag checking
+ * 		- angle of the next motor is written as soon as result of the previous one is read, CORDIC computes it
+ * 		  while CPU runs controllers and SVM of the previous motor, so only the first motor waits for CORDIC
+ * 		- Motor_FOC_Estimate_Angle() uses phase function (atan2) of the angle sensor signals the same way
+ * 		- host build (HOST_BUILD) computes the same functions with software CORDIC
+ *
+ * Currents are Q15 fractions of full scale of current sensing, voltages Q15 fractions of Vdc / sqrt(3)
+ * */
+#ifndef MOTOR_FOC_H_
+#define MOTOR_FOC_H_
+
+/*CORDIC iterations / 4, 6 cycles give error below 1 LSB of q1.15*/
+#define MOTOR_FOC_CORDIC_PRECISION 6U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_FOC_OK, //Everything fine
+	MOTOR_FOC_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_FOC_RANGE_ERROR //controller gains out of range
+} Motor_FOCStatusTypeDef;
+
+/*
+ * State of a single motor
+ * */
+typedef struct {
+	//electrical angle (32768 is pi), written by the caller or by Motor_FOC_Estimate_Angle()
+	int16_t Angle;
+	//signals of the angle sensor (linear Hall or resolver), Q15
+	int16_t SensorCos;
+	int16_t SensorSin;
+
+	//measured currents of phase A and B (Q15), phase C is -A - B
+	int16_t CurrentA;
+	int16_t CurrentB;
+
+	//desired flux and torque current (Q15)
+	int16_t CurrentDRef;
+	int16_t CurrentQRef;
+
+	//current controllers, output is voltage (Q15)
+	Motor_PIDTypeDef PIDDirect;
+	Motor_PIDTypeDef PIDQuadrature;
+
+	//results of the last update
+	int16_t CurrentD;
+	int16_t CurrentQ;
+	int16_t VoltageD;
+	int16_t VoltageQ;
+	//duty of the phases (Q15)
+	uint16_t Duty[MOTOR_PWM_PHASES];
+} Motor_FOCTypeDef;
+
+/*
+ * @brief Initializes controllers of the motor and CORDIC, duty of all phases is 50%
+ *
+ * @param pFOC pointer to motor
+ * @param pConfig pointer to gains of both current controllers
+ *
+ * @retval Motor_FOCStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_FOCStatusTypeDef Motor_FOC_Init(Motor_FOCTypeDef* pFOC, const Motor_PIDConfigTypeDef* pConfig);
+
+/*
+ * @brief Runs one step of current control of all motors, no argument checks, it is called from interrupt
+ *
+ * @param pFOC pointer to the first of the motors (array)
+ * @param count number of motors
+ * */
+extern void Motor_FOC_Update(Motor_FOCTypeDef* pFOC, uint8_t count);
+
+/*
+ * @brief Calculates Angle of all motors from their sensor signals (atan2), no argument checks
+ *
+ * @param pFOC pointer to the first of the motors (array)
+ * @param count number of motors
+ * */
+extern void Motor_FOC_Estimate_Angle(Motor_FOCTypeDef* pFOC, uint8_t count);
+
+#endif
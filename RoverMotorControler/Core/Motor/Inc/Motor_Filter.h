@@ -0,0 +1,140 @@
+/*Motor_Filter.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+
+/*
+ * FIR or IIR (biquad) filtering of several signals on the FMAC coprocessor
+ *
+ * HARDWARE
+ * 1. FMAC runs one filter, so all channels share the coefficients and their samples are interleaved:
+ *    x0 x1 x2 x3 x0 x1 ... in X1 buffer, coefficients are stretched with zeros (H(z^N) instead of H(z)),
+ *    so every output depends only on samples of its own channel
+ * 2. Coefficients and zero history are loaded once by Motor_Filter_Configure(), the filter then runs all the time:
+ *    Motor_Filter_Write() writes one sample of every channel, Motor_Filter_Read() waits for results (few cycles each),
+ *    CPU doesn't run any filter arithmetic
+ * 3. Output is saturated (CLIPEN)
+ * 4. Motor_Filter_Read() waits at most MOTOR_FILTER_READ_TIMEOUT polls for every output, FMAC which doesn't answer
+ *    is stopped, filter falls back to bypass (this tick gets unfiltered samples) and FaultCount is incremented
+ *
+ * FMAC ARITHMETIC (same in the software model used by host build, so results are bit-exact)
+ * 		- FIR: y[n] = 2^Gain * sum(B[k] * x[n-k])
+ * 		- IIR (direct form 1): y[n] = 2^Gain * (sum(B[k] * x[n-k]) + sum(A[k] * y[n-1-k])), feedback is added,
+ * 		  so A has opposite sign than in the usual transfer function notation
+ * 		- products q2.30 are truncated to q2.22 and summed in 26bit accumulator (q4.22, wraps),
+ * 		  output is accumulator << Gain truncated to q1.15 and saturated
+ *
+ * Samples and coefficients are Q15, MOTOR_FILTER_BYPASS copies input to output without FMAC
+ * */
+#ifndef MOTOR_FILTER_H_
+#define MOTOR_FILTER_H_
+
+/*Largest number of interleaved channels*/
+#define MOTOR_FILTER_CHANNELS_MAX 4U
+
+/*Largest number of feed-forward (B) and feedback (A) coefficients, IIR is a single biquad*/
+#define MOTOR_FILTER_TAPS_MAX 16U
+#define MOTOR_FILTER_IIR_TAPS_MAX 3U
+#define MOTOR_FILTER_FEEDBACK_MAX 2U
+
+/*Largest output gain (shift)*/
+#define MOTOR_FILTER_GAIN_MAX 7U
+
+/*How many times Motor_Filter_Read() polls FMAC for one output, the longest filter (61 interleaved taps)
+ *needs less than 100 core cycles per output, so FMAC which doesn't answer in time is stuck*/
+#ifndef MOTOR_FILTER_READ_TIMEOUT
+#define MOTOR_FILTER_READ_TIMEOUT 256U
+#endif
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_FILTER_OK, //Everything fine
+	MOTOR_FILTER_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_FILTER_RANGE_ERROR //filter type, number of coefficients, gain or channels out of range
+} Motor_FilterStatusTypeDef;
+
+/*
+ * Type of the filter
+ * */
+typedef enum {
+	MOTOR_FILTER_BYPASS, //output is equal to input
+	MOTOR_FILTER_FIR,
+	MOTOR_FILTER_IIR
+} Motor_FilterTypeTypeDef;
+
+/*
+ * Coefficients of the filter
+ * */
+typedef struct {
+	//Motor_FilterTypeTypeDef
+	uint8_t Type;
+	//number of B coefficients (2 - MOTOR_FILTER_TAPS_MAX, IIR up to MOTOR_FILTER_IIR_TAPS_MAX)
+	uint8_t FeedForward;
+	//number of A coefficients (IIR 1 - MOTOR_FILTER_FEEDBACK_MAX, FIR 0)
+	uint8_t Feedback;
+	//output is multiplied by 2^Gain
+	uint8_t Gain;
+	//Q15 coefficients, B[0] multiplies the newest sample, A[0] the previous output
+	int16_t B[MOTOR_FILTER_TAPS_MAX];
+	int16_t A[MOTOR_FILTER_FEEDBACK_MAX];
+} Motor_FilterConfigTypeDef;
+
+/*
+ * State of the filter
+ * */
+typedef struct {
+	Motor_FilterConfigTypeDef Config;
+	//number of interleaved channels
+	uint8_t Channels;
+
+	//last outputs, read from FMAC or calculated by the model
+	int16_t Output[MOTOR_FILTER_CHANNELS_MAX];
+	//how many times FMAC didn't give output in time and filter fell back to bypass
+	uint32_t FaultCount;
+	//history of the software model (host build), newest first
+	int16_t InputHistory[MOTOR_FILTER_CHANNELS_MAX][MOTOR_FILTER_TAPS_MAX];
+	int16_t OutputHistory[MOTOR_FILTER_CHANNELS_MAX][MOTOR_FILTER_FEEDBACK_MAX];
+} Motor_FilterTypeDef;
+
+/*
+ * @brief Initializes filter in bypass mode
+ *
+ * @param pFilter pointer to filter
+ * @param channels number of interleaved channels (1 - MOTOR_FILTER_CHANNELS_MAX)
+ *
+ * @retval Motor_FilterStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_FilterStatusTypeDef Motor_Filter_Init(Motor_FilterTypeDef* pFilter, uint8_t channels);
+
+/*
+ * @brief Loads coefficients to FMAC, clears history and starts the filter, previous filter is stopped
+ *
+ * @param pFilter pointer to filter
+ * @param pConfig pointer to coefficients
+ *
+ * @retval Motor_FilterStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_FilterStatusTypeDef Motor_Filter_Configure(Motor_FilterTypeDef* pFilter, const Motor_FilterConfigTypeDef* pConfig);
+
+/*
+ * @brief Writes one sample of every channel, no argument checks, it is called from control interrupt
+ *
+ * @param pFilter pointer to filter
+ * @param pInput samples (Channels values)
+ * */
+extern void Motor_Filter_Write(Motor_FilterTypeDef* pFilter, const int16_t* pInput);
+
+/*
+ * @brief Reads filtered samples written by the last Motor_Filter_Write(), no argument checks,
+ * if FMAC doesn't answer filter is switched to bypass and unfiltered samples are returned
+ *
+ * @param pFilter pointer to filter
+ * @param pOutput filtered samples (Channels values)
+ * */
+extern void Motor_Filter_Read(Motor_FilterTypeDef* pFilter, int16_t* pOutput);
+
+#endif
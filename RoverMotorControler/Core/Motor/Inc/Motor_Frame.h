@@ -0,0 +1,103 @@
+/*Motor_Frame.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Control.h"
+
+/*
+ * Payload layouts of the motor command frames
+ *
+ * 1. Every payload is a packed little endian structure, its wire size is checked at compile time,
+ *    so changing a field can't silently change the protocol
+ * 2. Callbacks are registered with UART_Communication_Register_Callback_Length() and MOTOR_FRAME_LENGTH(),
+ *    library drops frames of wrong length before the callback runs, callback casts payload to the structure
+ * 3. Fields are read directly from the payload, Cortex-M4 loads unaligned 16bit and 32bit values with one instruction
+ *
+ * New frame: add the structure with its size assertion and register the callback with its length
+ * */
+#ifndef MOTOR_FRAME_H_
+#define MOTOR_FRAME_H_
+
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "payloads are little endian and read without conversion");
+
+/*Payload structure which is read in place from the received bytes*/
+#define MOTOR_FRAME_PAYLOAD __attribute__((packed, may_alias))
+
+/*Accepted payload length (min_length, max_length) of fixed size frame*/
+#define MOTOR_FRAME_LENGTH(type) sizeof(type), sizeof(type)
+/*Accepted payload length of frame which ends with array of up to the full size of member*/
+#define MOTOR_FRAME_LENGTH_VARIABLE(type, member) offsetof(type, member), sizeof(type)
+
+/*
+ * MOTOR_SET_MODE
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//0 stops the wheels and disables bridges, anything else enables them (clears fault) and starts control
+	uint8_t Mode;
+} Motor_SetModePayloadTypeDef;
+_Static_assert(sizeof(Motor_SetModePayloadTypeDef) == 1U, "MOTOR_SET_MODE payload has 1 byte");
+
+/*
+ * MOTOR_SET_SPEED
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//index of the wheel
+	uint8_t Wheel;
+	//Q15 fraction of the maximum speed
+	int16_t Speed;
+} Motor_SetSpeedPayloadTypeDef;
+_Static_assert(sizeof(Motor_SetSpeedPayloadTypeDef) == 3U, "MOTOR_SET_SPEED payload has 3 bytes");
+
+/*
+ * MOTOR_SET_SPEEDS
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//Q15 fractions of the maximum speed of every wheel
+	int16_t Speed[MOTOR_WHEEL_COUNT];
+} Motor_SetSpeedsPayloadTypeDef;
+_Static_assert(sizeof(Motor_SetSpeedsPayloadTypeDef) == 2U * MOTOR_WHEEL_COUNT, "MOTOR_SET_SPEEDS payload has 2 bytes per wheel");
+
+/*
+ * MOTOR_SET_POS
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//index of the wheel
+	uint8_t Wheel;
+	//target position in encoder counts
+	int32_t Position;
+} Motor_SetPosPayloadTypeDef;
+_Static_assert(sizeof(Motor_SetPosPayloadTypeDef) == 5U, "MOTOR_SET_POS payload has 5 bytes");
+
+/*
+ * MOTOR_SET_TELEMETRY, frames streamed back have the same ID and the layout described in Motor_Telemetry.h
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//samples per second, 0 stops the stream
+	uint16_t Rate;
+	//selected signals, bit n is Motor_TelemetrySignalTypeDef n
+	uint8_t Mask;
+	//Motor_TelemetryModeTypeDef
+	uint8_t Mode;
+} Motor_SetTelemetryPayloadTypeDef;
+_Static_assert(sizeof(Motor_SetTelemetryPayloadTypeDef) == 4U, "MOTOR_SET_TELEMETRY payload has 4 bytes");
+
+/*
+ * MOTOR_SET_FILTER, variable length: header and FeedForward + Feedback coefficients
+ * */
+typedef struct MOTOR_FRAME_PAYLOAD {
+	//Motor_FilterTypeTypeDef
+	uint8_t Type;
+	//output is multiplied by 2^Gain
+	uint8_t Gain;
+	//number of B and A coefficients
+	uint8_t FeedForward;
+	uint8_t Feedback;
+	//B coefficients followed by A coefficients (Q15)
+	int16_t Coefficients[MOTOR_FILTER_TAPS_MAX + MOTOR_FILTER_FEEDBACK_MAX];
+} Motor_SetFilterPayloadTypeDef;
+_Static_assert(offsetof(Motor_SetFilterPayloadTypeDef, Coefficients) == 4U, "MOTOR_SET_FILTER header has 4 bytes");
+_Static_assert(sizeof(Motor_SetFilterPayloadTypeDef) == 4U + 2U * (MOTOR_FILTER_TAPS_MAX + MOTOR_FILTER_FEEDBACK_MAX),
+		"MOTOR_SET_FILTER coefficients are not padded");
+
+#endif
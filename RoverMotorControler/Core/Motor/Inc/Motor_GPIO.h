@@ -0,0 +1,40 @@
+/*Motor_GPIO.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Register level pin configuration shared by motor modules (timer channels, DMA triggers, direction outputs, ADC inputs).
+ * Clock of the port has to be enabled before, host build has no GPIO so helpers are not defined there
+ * */
+#ifndef MOTOR_GPIO_H_
+#define MOTOR_GPIO_H_
+
+#ifndef HOST_BUILD
+/*
+ * @brief Connects pin to alternate function of a peripheral
+ * */
+static inline void Motor_GPIO_Alternate(GPIO_TypeDef* port, uint8_t pin, uint8_t alternate){
+	uint32_t shift = (pin & 7U) * 4U;
+	port->AFR[pin >> 3] = (port->AFR[pin >> 3] & ~(0xFU << shift)) | ((uint32_t)alternate << shift);
+	port->MODER = (port->MODER & ~(3U << (pin * 2U))) | (2U << (pin * 2U));
+}
+
+/*
+ * @brief Configures pin as push-pull output with given initial state
+ * */
+static inline void Motor_GPIO_Output(GPIO_TypeDef* port, uint8_t pin, bool state){
+	port->BSRR = state ? (1U << pin) : (1U << (pin + 16U));
+	port->MODER = (port->MODER & ~(3U << (pin * 2U))) | (1U << (pin * 2U));
+}
+
+/*
+ * @brief Configures pin as analog input without pull resistors
+ * */
+static inline void Motor_GPIO_Analog(GPIO_TypeDef* port, uint8_t pin){
+	port->PUPDR &= ~(3U << (pin * 2U));
+	port->MODER |= 3U << (pin * 2U);
+}
+#endif
+
+#endif
@@ -0,0 +1,105 @@
+/*Motor_PID.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+
+/*
+ * Fixed point PID controller with feed-forward, output saturation and anti-windup
+ *
+ * ALGORITHM (Motor_PID_Update(), called once per control tick)
+ * 1. error = setpoint - measured, saturated to Q15
+ * 2. Terms are summed in Q30 (64bit accumulator, products of two Q15 values):
+ * 		- P = Kp * error
+ * 		- FF = Kff * setpoint, drives the output without waiting for the error to build up
+ * 		- D = -Kd * (measured - previous measured), derivative of the measurement so setpoint steps don't kick the output
+ * 		- I = integral, Ki * error is added every tick
+ * 3. output = sum >> (15 - Scale), saturated to [OutputMin, OutputMax]
+ * 4. Anti-windup
+ * 		- integral is clamped to the range which alone could reach the output limits
+ * 		- when output is saturated and error pushes it further, integral keeps its previous value
+ *
+ * Gains are Q15 and effective gain is K * 2^Scale, Ki and Kd are per tick (dt is folded into them),
+ * so they have to be tuned again when control rate changes
+ * */
+#ifndef MOTOR_PID_H_
+#define MOTOR_PID_H_
+
+/*Largest Scale, gains are then integers*/
+#define MOTOR_PID_SCALE_MAX 15U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_PID_OK, //Everything fine
+	MOTOR_PID_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_PID_RANGE_ERROR //Scale or output limits out of range
+} Motor_PIDStatusTypeDef;
+
+/*
+ * Gains and limits of the controller
+ * */
+typedef struct {
+	//Q15 gains, effective gain is K * 2^Scale
+	int16_t Kp;
+	int16_t Ki;
+	int16_t Kd;
+	int16_t Kff;
+	uint8_t Scale;
+	//Q15 output limits
+	int16_t OutputMin;
+	int16_t OutputMax;
+} Motor_PIDConfigTypeDef;
+
+/*
+ * Controller state
+ * */
+typedef struct {
+	Motor_PIDConfigTypeDef Config;
+
+	//integral term in the same units as the sum of terms (Q30 before scaling)
+	int32_t Integral;
+	//integral limits derived from output limits
+	int32_t IntegralMin;
+	int32_t IntegralMax;
+	//measurement of the previous tick, used by derivative term
+	int16_t PreviousMeasured;
+	//output of the last tick
+	int16_t Output;
+	//last output hit one of the limits
+	bool Saturated;
+} Motor_PIDTypeDef;
+
+/*
+ * @brief Sets gains and limits and resets state of the controller
+ *
+ * @param pPID pointer to controller
+ * @param pConfig pointer to gains and limits
+ *
+ * @retval Motor_PIDStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PIDStatusTypeDef Motor_PID_Init(Motor_PIDTypeDef* pPID, const Motor_PIDConfigTypeDef* pConfig);
+
+/*
+ * @brief Resets integral and derivative state, output becomes 0
+ *
+ * @param pPID pointer to controller
+ *
+ * @retval Motor_PIDStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PIDStatusTypeDef Motor_PID_Reset(Motor_PIDTypeDef* pPID);
+
+/*
+ * @brief Runs one step of the controller, no argument checks, it is called from control interrupt
+ *
+ * @param pPID pointer to controller
+ * @param setpoint desired value (Q15)
+ * @param measured measured value (Q15)
+ *
+ * @retval int16_t saturated output (Q15)
+ * */
+extern int16_t Motor_PID_Update(Motor_PIDTypeDef* pPID, int16_t setpoint, int16_t measured);
+
+#endif
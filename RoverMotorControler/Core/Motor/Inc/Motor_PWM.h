@@ -0,0 +1,163 @@
+/*Motor_PWM.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Motor_Q15.h"
+
+/*
+ * PWM of the wheel H-bridges on advanced timers TIM1 (wheels 0, 1) and TIM8 (wheels 2, 3)
+ *
+ * HARDWARE
+ * 1. Every wheel has one complementary pair (switched leg of the bridge) and direction output (the other leg):
+ * 		- wheel 0: TIM1 CH1 PA8 / CH1N PB13, wheel 1: TIM1 CH2 PA9 / CH2N PB14
+ * 		- wheel 2: TIM8 CH1 PC6 / CH1N PC10, wheel 3: TIM8 CH2 PC7 / CH2N PC11
+ * 		- direction: PC0-PC3
+ * 2. Dead-time between complementary outputs is inserted by the timer (BDTR)
+ * 3. Break inputs TIM1_BKIN PB12 and TIM8_BKIN PA6 (active low, fault output of the gate drivers)
+ *    turn off all outputs in hardware, they stay off until Motor_PWM_Enable() is called again
+ * 4. With MOTOR_PWM_THREE_PHASE defined every timer drives one three-phase bridge (BLDC motor) instead,
+ *    channels 1-3 are the phases and duty is written by Motor_PWM_Set_Phases() (usually from Motor_FOC):
+ * 		- bridge 0: TIM1 CH1 PA8 / CH1N PB13, CH2 PA9 / CH2N PB14, CH3 PA10 / CH3N PB15
+ * 		- bridge 1: TIM8 CH1 PC6 / CH1N PC10, CH2 PC7 / CH2N PC11, CH3 PC8 / CH3N PC12
+ *
+ * ALGORITHM
+ * 1. Both timers count up and down (center-aligned), TIM8 is started by TIM1 so their periods are in phase
+ * 2. Compare registers are preloaded and repetition counter gives one update event per PWM period (counter overflow,
+ *    middle of the off-time), so duty written at any moment is applied to all channels of the timer from the next peak
+ *    and both halves of every pulse have the same width
+ * 3. OC4REF of TIM1 (channel 4 without output, active only at counter 0, the valley in the middle of the on-time)
+ *    is its TRGO2, it triggers current sampling of Motor_ADC
+ * 4. When direction changes duty 0 is written first, direction output is switched on the next call
+ *    (after at least one update event if calls are not more frequent than PWM), so bridge never gets reversed mid-pulse
+ * 5. Motor_PWM_Hold_Update() / Motor_PWM_Release_Update() set and clear UDIS of both timers around writes of several duties,
+ *    update event can't fall between the writes, so all of them start in the same PWM period
+ * 		- update held for the time of the writes is skipped (next one comes a period later), current sampling
+ * 		  is triggered by OC4REF and goes on
+ * */
+#ifndef MOTOR_PWM_H_
+#define MOTOR_PWM_H_
+
+/*Number of PWM outputs, one per wheel*/
+#define MOTOR_PWM_CHANNELS 4U
+
+/*Uncomment to drive three-phase bridges, Motor_PWM_Set_Duty() is then not available*/
+//#define MOTOR_PWM_THREE_PHASE
+
+/*Number of three-phase bridges (one per advanced timer) and their phases*/
+#define MOTOR_PWM_BRIDGES 2U
+#define MOTOR_PWM_PHASES 3U
+
+/*PWM frequency in Hz and dead-time between complementary outputs in ns*/
+#define MOTOR_PWM_FREQUENCY 20000U
+#define MOTOR_PWM_DEAD_TIME_NS 500U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_PWM_OK, //Everything fine
+	MOTOR_PWM_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_PWM_RANGE_ERROR, //channel, bridge, frequency or dead-time out of range (or not available in this mode)
+	MOTOR_PWM_FAULT //break input is active, outputs are off
+} Motor_PWMStatusTypeDef;
+
+/*
+ * State of the PWM outputs
+ * */
+typedef struct {
+	//timer period (auto reload value), duty MOTOR_Q15_ONE gives compare value equal to it
+	uint32_t Period;
+	//duty written to the compare registers (Q15, negative means reverse)
+	int16_t Duty[MOTOR_PWM_CHANNELS];
+	//direction output of the channels (true means reverse)
+	bool Reverse[MOTOR_PWM_CHANNELS];
+	//duty of the phases of three-phase bridges (Q15, 0 - MOTOR_Q15_ONE)
+	uint16_t Phases[MOTOR_PWM_BRIDGES][MOTOR_PWM_PHASES];
+	//outputs were turned off by the break input
+	bool Fault;
+	//number of break events
+	uint32_t FaultCount;
+} Motor_PWMTypeDef;
+
+/*
+ * @brief Configures timers, pins and dead-time, outputs stay disabled, duty of all channels is 0
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ * @param frequency PWM frequency in Hz
+ * @param dead_time dead-time in ns (up to ~6us at 160MHz)
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Init(Motor_PWMTypeDef* pPWM, uint32_t frequency, uint32_t dead_time);
+
+/*
+ * @brief Enables outputs (clears fault), it has no effect while break input is still active
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ *
+ * @retval Motor_PWMStatusTypeDef MOTOR_PWM_FAULT if break input is still active
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Enable(Motor_PWMTypeDef* pPWM);
+
+/*
+ * @brief Disables outputs, both switches of every pair are off
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Disable(Motor_PWMTypeDef* pPWM);
+
+/*
+ * @brief Writes duty of the channel, it is applied at the start of the next PWM period
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ * @param channel index of the wheel
+ * @param duty Q15 duty, negative means reverse
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Set_Duty(Motor_PWMTypeDef* pPWM, uint8_t channel, int16_t duty);
+
+/*
+ * @brief Holds update events of both timers, duties written until Motor_PWM_Release_Update() stay in the preload registers
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Hold_Update(Motor_PWMTypeDef* pPWM);
+
+/*
+ * @brief Allows update events of both timers again, duties written since Motor_PWM_Hold_Update() are applied together
+ * from the next peak of the counters
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Release_Update(Motor_PWMTypeDef* pPWM);
+
+/*
+ * @brief Writes duty of all phases of the three-phase bridge, it is applied at the start of the next PWM period
+ * 		  (all three together, compare registers are preloaded)
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ * @param bridge index of the bridge (timer)
+ * @param pDuty Q15 duty of the phases (0 - MOTOR_Q15_ONE), 50% is zero voltage between phases
+ *
+ * @retval Motor_PWMStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Set_Phases(Motor_PWMTypeDef* pPWM, uint8_t bridge, const uint16_t* pDuty);
+
+/*
+ * @brief Checks break flags of both timers, fault stays set until Motor_PWM_Enable()
+ *
+ * @param pPWM pointer to Motor_PWM handle
+ *
+ * @retval Motor_PWMStatusTypeDef MOTOR_PWM_FAULT if outputs were turned off by break input
+ * */
+extern Motor_PWMStatusTypeDef Motor_PWM_Check_Fault(Motor_PWMTypeDef* pPWM);
+
+#endif
@@ -0,0 +1,47 @@
+/*Motor_Q15.h*/
+#include "stm32g4xx_hal.h"
+
+/*
+ * Fixed point helpers shared by motor modules.
+ * Q15 value v represents v / 32768 (range [-1, 1)), Q30 is the product of two Q15 values.
+ * On the target saturation is a single SSAT instruction, host build uses plain C
+ * */
+#ifndef MOTOR_Q15_H_
+#define MOTOR_Q15_H_
+
+#define MOTOR_Q15_ONE 32767
+
+/*
+ * @brief Saturates value to Q15 range [-32768, 32767]
+ * */
+static inline int32_t Motor_Q15_Saturate(int32_t value){
+#ifndef HOST_BUILD
+	return __SSAT(value, 16);
+#else
+	if(value > INT16_MAX)
+		return INT16_MAX;
+	if(value < INT16_MIN)
+		return INT16_MIN;
+	return value;
+#endif
+}
+
+/*
+ * @brief Saturates value to [min, max]
+ * */
+static inline int32_t Motor_Q15_Clamp(int32_t value, int32_t min, int32_t max){
+	if(value > max)
+		return max;
+	if(value < min)
+		return min;
+	return value;
+}
+
+/*
+ * @brief Multiplies two Q15 values, result is Q15
+ * */
+static inline int32_t Motor_Q15_Multiply(int32_t a, int32_t b){
+	return (a * b) >> 15;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*Motor_Telemetry.h*/
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+#include "Motor_Q15.h"
+
+/*
+ * Decimated telemetry of the wheels streamed in binary frames
+ *
+ * ALGORITHM
+ * 1. Motor_Telemetry_Write() runs in the control tick and gets all signals of all wheels (speed, current, duty, error),
+ *    it always adds them to the sums of the window, when the window of Decimation ticks ends the sample
+ *    (last values or averages) is stored in the ring, so cost of the tick doesn't depend on the rate or selected signals
+ * 		- average is sum * Reciprocal (Q24 inverse of Decimation), one 32x32->64 multiplication per value, no division
+ * 2. Ring is single producer (control tick) single consumer (main loop) without locking: writer fills the slot and then
+ *    moves Head, reader copies slots and then moves Tail, when the ring is full the new sample is dropped and counted
+ * 3. Motor_Telemetry_Update() runs in the main loop, packs as many consecutive samples as fit in the free space
+ *    of the write queue into one MOTOR_TELEMETRY_ID frame and enqueues it by UART_Communication_Transmit_Frame(),
+ *    samples stay in the ring until they fit, so the tick never waits for UART
+ * 		- payload: sequence number of the first sample (u16), signal mask (u8), number of samples (u8),
+ * 		  then for every sample the selected signals in the order of Motor_TelemetrySignalTypeDef, every signal
+ * 		  has one i16 per wheel
+ * 		- sequence number counts every sample including dropped ones, so the receiver sees the gaps
+ * 4. Motor_Telemetry_Configure() changes rate, signals and mode from the main loop with interrupts disabled,
+ *    rate 0 stops sampling
+ *
+ * At 115200 baud the link carries about 11kB/s, so 1kHz fits one signal, all four signals fit about 300Hz,
+ * faster streams fill the ring and their samples are dropped
+ * */
+#ifndef MOTOR_TELEMETRY_H_
+#define MOTOR_TELEMETRY_H_
+
+/*Number of wheels in every sample*/
+#define MOTOR_TELEMETRY_WHEELS 4U
+
+/*Number of samples in the ring, power of 2*/
+#define MOTOR_TELEMETRY_DEPTH 32U
+
+/*Highest sample rate in Hz*/
+#define MOTOR_TELEMETRY_RATE_MAX 1000U
+
+/*Fraction bits of the reciprocal of the window length*/
+#define MOTOR_TELEMETRY_RECIPROCAL_BITS 24U
+
+/*ID of the configuration frame and of the streamed frames*/
+#define MOTOR_TELEMETRY_ID 0x16U
+
+/*Bytes of the payload before the samples*/
+#define MOTOR_TELEMETRY_HEADER_SIZE 4U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_TELEMETRY_OK, //Everything fine
+	MOTOR_TELEMETRY_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_TELEMETRY_RANGE_ERROR //rate, signals or mode out of range
+} Motor_TelemetryStatusTypeDef;
+
+/*
+ * Signals of every wheel, bit n of the mask selects signal n
+ * */
+typedef enum {
+	MOTOR_TELEMETRY_SPEED, //filtered measured speed (Q15)
+	MOTOR_TELEMETRY_CURRENT, //bridge current (Q15)
+	MOTOR_TELEMETRY_DUTY, //output of the controller (Q15)
+	MOTOR_TELEMETRY_ERROR, //setpoint - measured speed (Q15, saturated)
+	MOTOR_TELEMETRY_SIGNALS
+} Motor_TelemetrySignalTypeDef;
+
+/*Mask of all signals*/
+#define MOTOR_TELEMETRY_MASK_ALL ((1U << MOTOR_TELEMETRY_SIGNALS) - 1U)
+
+/*
+ * How the window of ticks becomes one sample
+ * */
+typedef enum {
+	MOTOR_TELEMETRY_DECIMATE, //values of the last tick
+	MOTOR_TELEMETRY_AVERAGE //average of all ticks
+} Motor_TelemetryModeTypeDef;
+
+/*
+ * One sample in the ring
+ * */
+typedef struct {
+	uint16_t Sequence;
+	int16_t Values[MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS];
+} Motor_TelemetrySampleTypeDef;
+
+/*
+ * State of the telemetry
+ * */
+typedef struct {
+	//rate of Motor_Telemetry_Write() calls in Hz
+	uint32_t TickRate;
+
+	//ticks per sample, 0 when stopped
+	volatile uint32_t Decimation;
+	//Q24 inverse of Decimation
+	uint32_t Reciprocal;
+	//Motor_TelemetryModeTypeDef
+	uint8_t Mode;
+	//selected signals, applied when samples are packed
+	volatile uint8_t Mask;
+
+	//window being summed by the tick
+	int32_t Sum[MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS];
+	uint32_t Count;
+	uint16_t Sequence;
+
+	//ring of finished samples, Head is moved only by the tick, Tail only by the main loop
+	Motor_TelemetrySampleTypeDef Ring[MOTOR_TELEMETRY_DEPTH];
+	volatile uint32_t Head;
+	volatile uint32_t Tail;
+
+	//samples dropped because the ring was full
+	volatile uint32_t Dropped;
+	//frames enqueued for transmission
+	uint32_t FramesSent;
+} Motor_TelemetryTypeDef;
+
+/*
+ * @brief Initializes stopped telemetry
+ *
+ * @param pTelemetry pointer to telemetry
+ * @param tick_rate rate of Motor_Telemetry_Write() calls in Hz
+ *
+ * @retval Motor_TelemetryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TelemetryStatusTypeDef Motor_Telemetry_Init(Motor_TelemetryTypeDef* pTelemetry, uint32_t tick_rate);
+
+/*
+ * @brief Sets rate, signals and mode, the window starts again, interrupts are disabled for the time of the update
+ *
+ * @param pTelemetry pointer to telemetry
+ * @param rate samples per second (0 stops, up to MOTOR_TELEMETRY_RATE_MAX and tick rate), rounded to whole ticks per sample
+ * @param mask selected signals (bits of Motor_TelemetrySignalTypeDef, not 0 when running)
+ * @param mode Motor_TelemetryModeTypeDef
+ *
+ * @retval Motor_TelemetryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TelemetryStatusTypeDef Motor_Telemetry_Configure(Motor_TelemetryTypeDef* pTelemetry, uint32_t rate, uint8_t mask, uint8_t mode);
+
+/*
+ * @brief Adds values of one tick to the window, no argument checks, it is called from control interrupt
+ *
+ * @param pTelemetry pointer to telemetry
+ * @param pValues all signals of all wheels ([MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS], Q15)
+ * */
+extern void Motor_Telemetry_Write(Motor_TelemetryTypeDef* pTelemetry, const int16_t pValues[MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS]);
+
+/*
+ * @brief Sends finished samples, should be called in the main loop
+ *
+ * @param pTelemetry pointer to telemetry
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval Motor_TelemetryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TelemetryStatusTypeDef Motor_Telemetry_Update(Motor_TelemetryTypeDef* pTelemetry, UART_CommunicationTypeDef* pCommunication);
+
+#endif
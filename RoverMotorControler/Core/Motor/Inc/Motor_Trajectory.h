@@ -0,0 +1,141 @@
+/*Motor_Trajectory.h*/
+#include "stm32g4xx_hal.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+/*
+ * Position trajectory generator of a single wheel (trapezoidal or jerk limited S-curve profile)
+ *
+ * ALGORITHM (Motor_Trajectory_Update(), called once per control tick, constant work per tick)
+ * 1. Trapezoidal profile is generated step by step instead of being planned in advance:
+ * 		- speed which still allows to stop at the target in discrete ticks: n = floor((sqrt(8*d/A + 1) - 1) / 2) whole
+ * 		  steps of A fit in the distance d, v = n*A + (d - A*n*(n+1)/2) / (n + 1), braking by A per tick from v
+ * 		  ends exactly at the target, v is limited by maximum velocity
+ * 		- velocity moves towards that limit by at most A per tick
+ * 		- square root is calculated only when distance is shorter than braking distance from maximum velocity
+ * 2. Waypoints are queued, next one is taken when the current one is reached or when braking for it would begin,
+ *    so the profile doesn't stop between waypoints (it only slows down when direction changes)
+ * 3. S-curve: velocity of the trapezoidal profile is averaged over last N ticks (running sum of a ring buffer),
+ *    averaging a trapezoid gives a profile with acceleration rising over N ticks, which is jerk J = A / N,
+ *    the final position is the same, the profile is only delayed by N/2 ticks
+ * 		- N is a power of two, remainder of the division is carried to the next tick so no position is lost
+ * 		- with jerk 0 (N = 1) the output is the trapezoidal profile
+ *
+ * Positions are encoder counts, internally Q24 fixed point (MOTOR_TRAJECTORY_Q), velocity is in counts per tick
+ * */
+#ifndef MOTOR_TRAJECTORY_H_
+#define MOTOR_TRAJECTORY_H_
+
+/*Fractional bits of positions, velocities and accelerations*/
+#define MOTOR_TRAJECTORY_Q 24U
+
+/*Length of the averaging window limits the time of jerk limited ramps (25.6ms at 10kHz)*/
+#define MOTOR_TRAJECTORY_SMOOTHING_MAX 256U
+
+/*Number of waypoints that can wait in the queue*/
+#define MOTOR_TRAJECTORY_QUEUE_SIZE 8U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	MOTOR_TRAJECTORY_OK, //Everything fine
+	MOTOR_TRAJECTORY_NULL_ERROR, //pointer passed as an argument was null
+	MOTOR_TRAJECTORY_RANGE_ERROR, //limits out of range of the fixed point format
+	MOTOR_TRAJECTORY_FULL_ERROR //waypoint queue is full
+} Motor_TrajectoryStatusTypeDef;
+
+/*
+ * Limits of the profile
+ * */
+typedef struct {
+	//counts per second
+	uint32_t Velocity;
+	//counts per second^2
+	uint32_t Acceleration;
+	//counts per second^3, 0 gives trapezoidal profile
+	uint32_t Jerk;
+} Motor_TrajectoryConfigTypeDef;
+
+/*
+ * State of the generator
+ * */
+typedef struct {
+	//limits converted to ticks (Q24)
+	int64_t VelocityMax;
+	int64_t Acceleration;
+	//braking distance from maximum velocity, square root is not needed beyond it
+	int64_t CruiseDistance;
+	//control rate in Hz
+	uint32_t Rate;
+
+	//trapezoidal profile (Q24)
+	int64_t Target;
+	int64_t Position;
+	int64_t Velocity;
+
+	//velocities of last 2^SmoothingShift ticks
+	int32_t History[MOTOR_TRAJECTORY_SMOOTHING_MAX];
+	uint8_t SmoothingShift;
+	uint16_t HistoryIndex;
+	//number of written entries, older entries are treated as HistoryFill
+	uint16_t HistoryCount;
+	int32_t HistoryFill;
+	int64_t HistorySum;
+	//part of HistorySum which didn't fit in the output velocity yet
+	int64_t Remainder;
+	//ticks the profile stands at the target (saturated at the window length)
+	uint16_t StillTicks;
+
+	//smoothed profile (Q24)
+	int64_t OutputPosition;
+	int64_t OutputVelocity;
+	//Flag if the output still moves
+	bool Moving;
+
+	//waypoints (counts), head is written by Motor_Trajectory_Push(), tail by Motor_Trajectory_Update()
+	int32_t Queue[MOTOR_TRAJECTORY_QUEUE_SIZE];
+	volatile uint8_t QueueHead;
+	volatile uint8_t QueueTail;
+} Motor_TrajectoryTypeDef;
+
+/*
+ * @brief Converts limits to ticks and resets generator to position 0
+ *
+ * @param pTrajectory pointer to generator
+ * @param pConfig pointer to limits
+ * @param rate control rate in Hz
+ *
+ * @retval Motor_TrajectoryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TrajectoryStatusTypeDef Motor_Trajectory_Init(Motor_TrajectoryTypeDef* pTrajectory, const Motor_TrajectoryConfigTypeDef* pConfig, uint32_t rate);
+
+/*
+ * @brief Starts the profile from the current state of the wheel, queue is emptied
+ *
+ * @param pTrajectory pointer to generator
+ * @param position current position (counts)
+ * @param velocity current velocity (counts per second)
+ *
+ * @retval Motor_TrajectoryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TrajectoryStatusTypeDef Motor_Trajectory_Reset(Motor_TrajectoryTypeDef* pTrajectory, int32_t position, int32_t velocity);
+
+/*
+ * @brief Appends waypoint to the queue
+ *
+ * @param pTrajectory pointer to generator
+ * @param position target position (counts)
+ *
+ * @retval Motor_TrajectoryStatusTypeDef status if function was executed successfully
+ * */
+extern Motor_TrajectoryStatusTypeDef Motor_Trajectory_Push(Motor_TrajectoryTypeDef* pTrajectory, int32_t position);
+
+/*
+ * @brief Advances profile by one tick, no argument checks, it is called from control interrupt
+ *
+ * @param pTrajectory pointer to generator, result is in OutputPosition and OutputVelocity
+ * */
+extern void Motor_Trajectory_Update(Motor_TrajectoryTypeDef* pTrajectory);
+
+#endif
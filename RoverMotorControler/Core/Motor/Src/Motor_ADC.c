@@ -0,0 +1,238 @@
+/*
+ * Motor_ADC.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_ADC.h"
+#include "Motor_GPIO.h"
+
+#ifdef HOST_BUILD
+#include "Virtual_Rover.h"
+#endif
+
+/*External trigger of injected conversions of ADC1 and ADC2 (JEXTSEL): TIM1 TRGO2 (OC4REF at the valley, Motor_PWM.c)*/
+#define MOTOR_ADC_JEXTSEL_TIM1_TRGO2 8U
+
+/*Sampling time codes (SMPx): 12.5 and 247.5 ADC clock cycles*/
+#define MOTOR_ADC_SAMPLE_CURRENT 2U
+#define MOTOR_ADC_SAMPLE_REGULAR 6U
+
+/*Regular channels of ADC1*/
+#define MOTOR_ADC_CHANNEL_BATTERY 12U
+#define MOTOR_ADC_CHANNEL_VREFINT 18U
+
+/*Oversampling ratio 256 (OVSR) and right shift 4 (OVSS) give 16bit average*/
+#define MOTOR_ADC_OVERSAMPLING_RATIO 7U
+#define MOTOR_ADC_OVERSAMPLING_SHIFT 4U
+
+/*Factory measurement of VREFINT at VDDA = 3.0V (12bit)*/
+#define MOTOR_ADC_VREFINT_CAL (*(const uint16_t*)0x1FFF75AAUL)
+#define MOTOR_ADC_VREFINT_CAL_VDDA 3000U
+
+/*Number of polling loops before calibration or enable is considered failed*/
+#define MOTOR_ADC_TIMEOUT 100000U
+
+#ifndef HOST_BUILD
+/*
+ * Injected channels of one ADC, two wheels each
+ * */
+typedef struct {
+	ADC_TypeDef* ADC;
+	GPIO_TypeDef* Port;
+	uint8_t Pins[2];
+	uint8_t Channels[2];
+} Motor_ADCInjectedTypeDef;
+
+static const Motor_ADCInjectedTypeDef adc_injected[] = {
+	{ADC1, GPIOA, {2, 3}, {3, 4}},
+	{ADC2, GPIOA, {4, 5}, {17, 13}}
+};
+
+/*
+ * @brief Sets sampling time of a channel (SMPR1 has channels 0-9, SMPR2 10-18)
+ * */
+static void __sample_time(ADC_TypeDef* adc, uint8_t channel, uint32_t code){
+	volatile uint32_t* pSMPR = channel < 10U ? &adc->SMPR1 : &adc->SMPR2;
+	uint32_t shift = (channel % 10U) * 3U;
+	*pSMPR = (*pSMPR & ~(7U << shift)) | (code << shift);
+}
+
+/*
+ * @brief Leaves deep power down, calibrates single-ended channels and enables ADC
+ * */
+static Motor_ADCStatusTypeDef __adc_enable(ADC_TypeDef* adc){
+	adc->CR = 0;
+	adc->CR = ADC_CR_ADVREGEN;
+	//regulator start-up (20us), at least 4 cycles per loop
+	for(volatile uint32_t i = SystemCoreClock / 200000U; i > 0; i--);
+
+	adc->CR = ADC_CR_ADVREGEN | ADC_CR_ADCAL;
+	uint32_t timeout = MOTOR_ADC_TIMEOUT;
+	while((adc->CR & ADC_CR_ADCAL) && --timeout);
+	if(timeout == 0)
+		return MOTOR_ADC_TIMEOUT_ERROR;
+
+	//ADEN is ignored in the first 4 ADC clock cycles after calibration, it is set again until ADC is ready
+	adc->ISR = ADC_ISR_ADRDY;
+	timeout = MOTOR_ADC_TIMEOUT;
+	while(!(adc->ISR & ADC_ISR_ADRDY) && --timeout){
+		if(!(adc->CR & ADC_CR_ADEN))
+			adc->CR = ADC_CR_ADVREGEN | ADC_CR_ADEN;
+	}
+	if(timeout == 0)
+		return MOTOR_ADC_TIMEOUT_ERROR;
+	adc->ISR = ADC_ISR_ADRDY;
+
+	return MOTOR_ADC_OK;
+}
+
+/*
+ * @brief Converts 12bit result to Q15 current
+ * */
+static inline int16_t __current(uint32_t result){
+	return (int16_t)(((int32_t)result - (int32_t)MOTOR_ADC_CURRENT_OFFSET) * 16);
+}
+#endif
+
+Motor_ADCStatusTypeDef Motor_ADC_Init(Motor_ADCTypeDef* pADC, uint16_t current_limit){
+	if(pADC == NULL)
+		return MOTOR_ADC_NULL_ERROR;
+
+	if(current_limit == 0 || current_limit >= MOTOR_ADC_CURRENT_OFFSET)
+		return MOTOR_ADC_RANGE_ERROR;
+
+	for(uint8_t i = 0; i < MOTOR_ADC_CURRENT_CHANNELS; i++){
+		pADC->Current[0][i] = 0;
+		pADC->Current[1][i] = 0;
+	}
+	pADC->Index = 0;
+	pADC->SampleCount = 0;
+	for(uint8_t i = 0; i < MOTOR_ADC_REGULAR_CHANNELS; i++)
+		pADC->Regular[i] = 0;
+	pADC->CurrentLimit = current_limit;
+	pADC->OverCurrentCount = 0;
+
+#ifndef HOST_BUILD
+	RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
+	RCC->AHB2ENR |= RCC_AHB2ENR_ADC12EN | RCC_AHB2ENR_GPIOAEN | RCC_AHB2ENR_GPIOBEN;
+	(void)RCC->AHB2ENR;
+
+	//clock can be changed only while both ADCs are disabled
+	ADC12_COMMON->CCR = ADC_CCR_CKMODE_0 | ADC_CCR_CKMODE_1 | ADC_CCR_VREFEN;
+
+	for(uint8_t i = 0; i < sizeof(adc_injected) / sizeof(adc_injected[0]); i++){
+		const Motor_ADCInjectedTypeDef* pInjected = &adc_injected[i];
+		ADC_TypeDef* adc = pInjected->ADC;
+
+		Motor_ADCStatusTypeDef status = __adc_enable(adc);
+		if(status != MOTOR_ADC_OK)
+			return status;
+
+		for(uint8_t k = 0; k < 2U; k++){
+			Motor_GPIO_Analog(pInjected->Port, pInjected->Pins[k]);
+			__sample_time(adc, pInjected->Channels[k], MOTOR_ADC_SAMPLE_CURRENT);
+		}
+		//two conversions on rising edge of TRGO2, counter is at the valley
+		adc->JSQR = ADC_JSQR_JL_0 | (MOTOR_ADC_JEXTSEL_TIM1_TRGO2 << ADC_JSQR_JEXTSEL_Pos) | ADC_JSQR_JEXTEN_0
+				| ((uint32_t)pInjected->Channels[0] << ADC_JSQR_JSQ1_Pos) | ((uint32_t)pInjected->Channels[1] << ADC_JSQR_JSQ2_Pos);
+
+		//watchdog 1 checks all injected channels, queue of injected contexts is disabled so JSQR is kept
+		uint32_t low = MOTOR_ADC_CURRENT_OFFSET - current_limit;
+		uint32_t high = MOTOR_ADC_CURRENT_OFFSET + current_limit;
+		adc->TR1 = (high << ADC_TR1_HT1_Pos) | (low << ADC_TR1_LT1_Pos);
+		adc->CFGR = ADC_CFGR_JQDIS | ADC_CFGR_JAWD1EN;
+		adc->ISR = ADC_ISR_JEOC | ADC_ISR_JEOS | ADC_ISR_AWD1;
+		adc->IER = ADC_IER_AWD1IE;
+	}
+	ADC2->IER |= ADC_IER_JEOSIE;
+
+	//regular sequence of ADC1: battery, VREFINT, continuous with oversampling (kept while injected conversions run)
+	Motor_GPIO_Analog(GPIOB, 1);
+	__sample_time(ADC1, MOTOR_ADC_CHANNEL_BATTERY, MOTOR_ADC_SAMPLE_REGULAR);
+	__sample_time(ADC1, MOTOR_ADC_CHANNEL_VREFINT, MOTOR_ADC_SAMPLE_REGULAR);
+	ADC1->SQR1 = ((MOTOR_ADC_REGULAR_CHANNELS - 1U) << ADC_SQR1_L_Pos)
+			| (MOTOR_ADC_CHANNEL_BATTERY << ADC_SQR1_SQ1_Pos) | (MOTOR_ADC_CHANNEL_VREFINT << ADC_SQR1_SQ2_Pos);
+	ADC1->CFGR2 = ADC_CFGR2_ROVSE | (MOTOR_ADC_OVERSAMPLING_RATIO << ADC_CFGR2_OVSR_Pos) | (MOTOR_ADC_OVERSAMPLING_SHIFT << ADC_CFGR2_OVSS_Pos);
+	ADC1->CFGR |= ADC_CFGR_CONT | ADC_CFGR_OVRMOD | ADC_CFGR_DMACFG | ADC_CFGR_DMAEN;
+
+	//DMAMUX channel 4 drives DMA1 channel 5, 16bit results to Regular circularly
+	DMA1_Channel5->CCR = 0;
+	DMAMUX1_Channel4->CCR = DMA_REQUEST_ADC1;
+	DMA1_Channel5->CPAR = (uint32_t)&ADC1->DR;
+	DMA1_Channel5->CMAR = (uint32_t)pADC->Regular;
+	DMA1_Channel5->CNDTR = MOTOR_ADC_REGULAR_CHANNELS;
+	DMA1_Channel5->CCR = DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_MINC | DMA_CCR_CIRC | DMA_CCR_EN;
+
+	NVIC_SetPriority(ADC1_2_IRQn, MOTOR_ADC_IRQ_PRIORITY);
+	NVIC_EnableIRQ(ADC1_2_IRQn);
+
+	//start bits are only set, zeros written to the other bits are ignored
+	ADC1->CR = ADC_CR_ADVREGEN | ADC_CR_JADSTART | ADC_CR_ADSTART;
+	ADC2->CR = ADC_CR_ADVREGEN | ADC_CR_JADSTART;
+#endif
+
+	return MOTOR_ADC_OK;
+}
+
+void Motor_ADC_Get_Currents(Motor_ADCTypeDef* pADC, int16_t* pCurrent){
+#ifndef HOST_BUILD
+	const volatile int16_t* pFront = pADC->Current[pADC->Index];
+	for(uint8_t i = 0; i < MOTOR_ADC_CURRENT_CHANNELS; i++)
+		pCurrent[i] = pFront[i];
+#else
+	for(uint8_t i = 0; i < MOTOR_ADC_CURRENT_CHANNELS; i++)
+		pCurrent[i] = Virtual_Rover_Current_Read(i);
+#endif
+}
+
+uint32_t Motor_ADC_Get_Battery(Motor_ADCTypeDef* pADC){
+	if(pADC == NULL)
+		return 0;
+
+#ifndef HOST_BUILD
+	uint32_t battery = pADC->Regular[0];
+	uint32_t vrefint = pADC->Regular[1];
+	if(vrefint == 0)
+		return 0;
+
+	//VDDA = 3.0V * VREFINT_CAL / VREFINT, 16bit results are 16 times larger than 12bit calibration
+	return (uint32_t)(((uint64_t)battery * MOTOR_ADC_VREFINT_CAL_VDDA * MOTOR_ADC_VREFINT_CAL * MOTOR_ADC_BATTERY_DIVIDER)
+			/ ((uint64_t)vrefint * 4096U));
+#else
+	return VIRTUAL_ROVER_BATTERY_VOLTAGE;
+#endif
+}
+
+Motor_ADCStatusTypeDef Motor_ADC_Interrupt_Callback(Motor_ADCTypeDef* pADC){
+	if(pADC == NULL)
+		return MOTOR_ADC_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	if(ADC2->ISR & ADC_ISR_JEOS){
+		ADC1->ISR = ADC_ISR_JEOC | ADC_ISR_JEOS;
+		ADC2->ISR = ADC_ISR_JEOC | ADC_ISR_JEOS;
+
+		uint8_t back = pADC->Index ^ 1U;
+		volatile int16_t* pBack = pADC->Current[back];
+		pBack[0] = __current(ADC1->JDR1);
+		pBack[1] = __current(ADC1->JDR2);
+		pBack[2] = __current(ADC2->JDR1);
+		pBack[3] = __current(ADC2->JDR2);
+		pADC->Index = back;
+		pADC->SampleCount++;
+	}
+
+	if((ADC1->ISR | ADC2->ISR) & ADC_ISR_AWD1){
+		ADC1->ISR = ADC_ISR_AWD1;
+		ADC2->ISR = ADC_ISR_AWD1;
+		//watchdog fires on every conversion until the current decays, only the first one is a trip
+		if((TIM1->BDTR | TIM8->BDTR) & TIM_BDTR_MOE){
+			TIM1->EGR = TIM_EGR_BG;
+			TIM8->EGR = TIM_EGR_BG;
+			pADC->OverCurrentCount++;
+		}
+	}
+#endif
+
+	return MOTOR_ADC_OK;
+}
@@ -0,0 +1,378 @@
+/*
+ * Motor_Control.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_Control.h"
+
+_Static_assert(MOTOR_TELEMETRY_WHEELS == MOTOR_WHEEL_COUNT, "telemetry sample has one value per wheel");
+
+/*Gains used until Motor_Control_Set_Gains() is called, feed-forward alone gives open loop duty equal to the setpoint*/
+static const Motor_PIDConfigTypeDef motor_default_gains = {
+	.Kp = 16384, //0.5
+	.Ki = 66, //0.002 per tick
+	.Kd = 0,
+	.Kff = MOTOR_Q15_ONE,
+	.Scale = 0,
+	.OutputMin = -MOTOR_Q15_ONE,
+	.OutputMax = MOTOR_Q15_ONE
+};
+
+/*
+ * @brief Default limits of the position profile, computed from the maximum speed of the wheel:
+ * half of full speed, reached in 0.5s, with acceleration ramps of 25ms
+ * */
+static void __default_limits(Motor_TrajectoryConfigTypeDef* pConfig, uint32_t max_speed){
+	pConfig->Velocity = max_speed / 2U;
+	pConfig->Acceleration = max_speed;
+	pConfig->Jerk = max_speed * 40U;
+}
+
+/*
+ * @brief Leaves position mode, the wheel stops instead of keeping the last setpoint of the trajectory
+ * */
+static void __leave_position_mode(Motor_WheelTypeDef* pWheel){
+	if(pWheel->PositionMode){
+		pWheel->PositionMode = false;
+		pWheel->Setpoint = 0;
+	}
+}
+
+/*
+ * @brief Back block of setpoints filled with the last published values, it is owned by the writer until it is published
+ * */
+static Motor_SetpointsTypeDef* __setpoints_edit(Motor_ControlTypeDef* pControl){
+	Motor_SetpointsTypeDef* pBack = &pControl->Setpoints[pControl->SetpointsBack];
+	*pBack = pControl->Setpoints[pControl->SetpointsLast];
+	return pBack;
+}
+
+/*
+ * @brief Publishes back block, it is exchanged with the shared one, control interrupt clears the exclusive monitor,
+ * so the exchange is repeated when the tick took the shared block in between
+ * */
+static void __setpoints_publish(Motor_ControlTypeDef* pControl){
+	uint8_t published = pControl->SetpointsBack;
+	uint8_t shared;
+
+	//block has to be written before its index
+	__DMB();
+	do {
+		shared = __LDREXB(&pControl->SetpointsShared);
+	} while(__STREXB(published | MOTOR_CONTROL_SETPOINTS_FRESH, &pControl->SetpointsShared) != 0U);
+
+	//block which wasn't taken by the tick is simply reused
+	pControl->SetpointsBack = shared & ~MOTOR_CONTROL_SETPOINTS_FRESH;
+	pControl->SetpointsLast = published;
+}
+
+/*
+ * @brief Takes the newest published block and applies speed commands which the tick hasn't seen yet
+ * */
+static void __setpoints_take(Motor_ControlTypeDef* pControl){
+	uint8_t shared = pControl->SetpointsShared;
+	if(shared & MOTOR_CONTROL_SETPOINTS_FRESH){
+		//writer can't run inside the interrupt, its exclusive store fails after it, so plain store is enough
+		pControl->SetpointsShared = pControl->SetpointsFront;
+		pControl->SetpointsFront = shared & ~MOTOR_CONTROL_SETPOINTS_FRESH;
+	}
+
+	const Motor_SetpointsTypeDef* pFront = &pControl->Setpoints[pControl->SetpointsFront];
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		Motor_WheelTypeDef* pWheel = &pControl->Wheels[i];
+		if(pWheel->SpeedSequence != pFront->Sequence[i]){
+			pWheel->SpeedSequence = pFront->Sequence[i];
+			pWheel->PositionMode = false;
+			pWheel->Setpoint = pFront->Speed[i];
+		}
+	}
+}
+
+/*
+ * @brief Configures TIM6 to overflow at given rate, TIM6 is clocked from APB1 timer clock (equal to HCLK)
+ *
+ * @retval uint32_t rate the timer was configured for, it can differ from requested when clock is not divisible by it
+ * */
+static uint32_t __timer_init(uint32_t rate){
+#ifndef HOST_BUILD
+	RCC->APB1ENR1 |= RCC_APB1ENR1_TIM6EN;
+	(void)RCC->APB1ENR1;
+
+	//16bit counter, prescaler is used only when the period doesn't fit
+	uint32_t period = SystemCoreClock / rate;
+	uint32_t prescaler = (period - 1U) / 65536U;
+	period /= prescaler + 1U;
+
+	TIM6->CR1 = TIM_CR1_ARPE | TIM_CR1_URS;
+	TIM6->PSC = prescaler;
+	TIM6->ARR = period - 1U;
+	//load prescaler now, URS keeps the update interrupt from being raised by it
+	TIM6->EGR = TIM_EGR_UG;
+	TIM6->SR = 0;
+	TIM6->DIER = TIM_DIER_UIE;
+
+	NVIC_SetPriority(TIM6_DAC_IRQn, MOTOR_CONTROL_IRQ_PRIORITY);
+	NVIC_EnableIRQ(TIM6_DAC_IRQn);
+
+	return SystemCoreClock / ((prescaler + 1U) * period);
+#else
+	return rate;
+#endif
+}
+
+/*
+ * @brief Advances trajectory of the wheel and sets its speed setpoint, velocity feed-forward plus position error
+ * */
+static void __position_setpoint(const Motor_ControlTypeDef* pControl, Motor_WheelTypeDef* pWheel){
+	Motor_TrajectoryTypeDef* pTrajectory = &pWheel->Trajectory;
+	Motor_Trajectory_Update(pTrajectory);
+
+	int32_t reference = (int32_t)((pTrajectory->OutputPosition + (1 << (MOTOR_TRAJECTORY_Q - 1))) >> MOTOR_TRAJECTORY_Q);
+	int32_t error = Motor_Q15_Saturate(reference - pWheel->Encoder.Position);
+	int32_t velocity = (int32_t)((pTrajectory->OutputVelocity * pControl->VelocityScale) >> MOTOR_TRAJECTORY_Q);
+
+	pWheel->Setpoint = Motor_Q15_Saturate(Motor_Q15_Saturate(velocity) + error * MOTOR_CONTROL_POSITION_GAIN);
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Init(Motor_ControlTypeDef* pControl, uint32_t rate, uint32_t max_speed){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	if(rate < MOTOR_CONTROL_RATE_MIN || rate > MOTOR_CONTROL_RATE_MAX || max_speed == 0)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	pControl->TickCount = 0;
+	pControl->Running = false;
+
+	if(Motor_PWM_Init(&pControl->PWM, MOTOR_PWM_FREQUENCY, MOTOR_PWM_DEAD_TIME_NS) != MOTOR_PWM_OK)
+		return MOTOR_CONTROL_RANGE_ERROR;
+	if(Motor_Filter_Init(&pControl->SpeedFilter, MOTOR_WHEEL_COUNT) != MOTOR_FILTER_OK)
+		return MOTOR_CONTROL_RANGE_ERROR;
+	//injected conversions are triggered by TIM1 started in Motor_PWM_Init()
+	if(Motor_ADC_Init(&pControl->ADC, MOTOR_ADC_CURRENT_LIMIT) != MOTOR_ADC_OK)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	pControl->Rate = __timer_init(rate);
+	pControl->MaxSpeed = max_speed;
+	pControl->VelocityScale = pControl->Rate * MOTOR_Q15_ONE / max_speed;
+	//telemetry is sampled once per tick
+	if(Motor_Telemetry_Init(&pControl->Telemetry, pControl->Rate) != MOTOR_TELEMETRY_OK)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	Motor_TrajectoryConfigTypeDef limits;
+	__default_limits(&limits, max_speed);
+
+	for(uint8_t i = 0; i < MOTOR_CONTROL_SETPOINTS_BUFFERS; i++){
+		for(uint8_t k = 0; k < MOTOR_WHEEL_COUNT; k++){
+			pControl->Setpoints[i].Speed[k] = 0;
+			pControl->Setpoints[i].Sequence[k] = 0;
+		}
+	}
+	pControl->SetpointsFront = 0;
+	pControl->SetpointsShared = 1;
+	pControl->SetpointsBack = 2;
+	pControl->SetpointsLast = 0;
+
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		Motor_WheelTypeDef* pWheel = &pControl->Wheels[i];
+		Motor_PID_Init(&pWheel->PID, &motor_default_gains);
+		if(Motor_Encoder_Init(&pWheel->Encoder, i, pControl->Rate, max_speed) != MOTOR_ENCODER_OK)
+			return MOTOR_CONTROL_RANGE_ERROR;
+		if(Motor_Trajectory_Init(&pWheel->Trajectory, &limits, pControl->Rate) != MOTOR_TRAJECTORY_OK)
+			return MOTOR_CONTROL_RANGE_ERROR;
+		pWheel->PositionMode = false;
+		pWheel->Setpoint = 0;
+		pWheel->SpeedSequence = 0;
+		pWheel->Measured = 0;
+		pWheel->Output = 0;
+		pWheel->Current = 0;
+	}
+
+	return MOTOR_CONTROL_OK;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Start(Motor_ControlTypeDef* pControl){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	//timer isn't started against bridges which are held off by their drivers
+	if(Motor_PWM_Enable(&pControl->PWM) == MOTOR_PWM_FAULT)
+		return MOTOR_CONTROL_FAULT_ERROR;
+
+	//controllers start from 0, they could have been held in reset by a fault
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++)
+		Motor_PID_Reset(&pControl->Wheels[i].PID);
+
+	pControl->Running = true;
+#ifndef HOST_BUILD
+	TIM6->CR1 |= TIM_CR1_CEN;
+#endif
+
+	return MOTOR_CONTROL_OK;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Stop(Motor_ControlTypeDef* pControl){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM6->CR1 &= ~TIM_CR1_CEN;
+	TIM6->SR = 0;
+	NVIC_ClearPendingIRQ(TIM6_DAC_IRQn);
+#endif
+	pControl->Running = false;
+	Motor_PWM_Disable(&pControl->PWM);
+
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		Motor_PID_Reset(&pControl->Wheels[i].PID);
+		__leave_position_mode(&pControl->Wheels[i]);
+		pControl->Wheels[i].Output = 0;
+	}
+
+	return MOTOR_CONTROL_OK;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Set_Speed(Motor_ControlTypeDef* pControl, uint8_t wheel, int16_t speed){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	if(wheel >= MOTOR_WHEEL_COUNT)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	Motor_SetpointsTypeDef* pBack = __setpoints_edit(pControl);
+	pBack->Speed[wheel] = speed;
+	pBack->Sequence[wheel]++;
+	__setpoints_publish(pControl);
+
+	return MOTOR_CONTROL_OK;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Set_Speeds(Motor_ControlTypeDef* pControl, const int16_t* pSpeed){
+	if(pControl == NULL || pSpeed == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	Motor_SetpointsTypeDef* pBack = __setpoints_edit(pControl);
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		pBack->Speed[i] = pSpeed[i];
+		pBack->Sequence[i]++;
+	}
+	__setpoints_publish(pControl);
+
+	return MOTOR_CONTROL_OK;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Set_Position(Motor_ControlTypeDef* pControl, uint8_t wheel, int32_t position){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	if(wheel >= MOTOR_WHEEL_COUNT)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	Motor_WheelTypeDef* pWheel = &pControl->Wheels[wheel];
+
+	//profile must not be restarted in the middle of a tick
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	if(!pWheel->PositionMode){
+		int32_t velocity = (int32_t)(((int64_t)pWheel->Measured * pControl->MaxSpeed) >> 15);
+		Motor_Trajectory_Reset(&pWheel->Trajectory, pWheel->Encoder.Position, velocity);
+		pWheel->PositionMode = true;
+	}
+	//speed command published before this one and not taken by the tick yet must not end position mode
+	pWheel->SpeedSequence = pControl->Setpoints[pControl->SetpointsLast].Sequence[wheel];
+	Motor_TrajectoryStatusTypeDef status = Motor_Trajectory_Push(&pWheel->Trajectory, position);
+	__set_PRIMASK(primask);
+
+	return status == MOTOR_TRAJECTORY_OK ? MOTOR_CONTROL_OK : MOTOR_CONTROL_FULL_ERROR;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Set_Gains(Motor_ControlTypeDef* pControl, uint8_t wheel, const Motor_PIDConfigTypeDef* pConfig){
+	if(pControl == NULL || pConfig == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	if(wheel >= MOTOR_WHEEL_COUNT)
+		return MOTOR_CONTROL_RANGE_ERROR;
+
+	//control interrupt must not see half of the new gains
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Motor_PIDStatusTypeDef status = Motor_PID_Init(&pControl->Wheels[wheel].PID, pConfig);
+	__set_PRIMASK(primask);
+
+	return status == MOTOR_PID_OK ? MOTOR_CONTROL_OK : MOTOR_CONTROL_RANGE_ERROR;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Set_Filter(Motor_ControlTypeDef* pControl, const Motor_FilterConfigTypeDef* pConfig){
+	if(pControl == NULL || pConfig == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+	//FMAC must not get samples of the tick while it is reloaded
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	Motor_FilterStatusTypeDef status = Motor_Filter_Configure(&pControl->SpeedFilter, pConfig);
+	__set_PRIMASK(primask);
+
+	return status == MOTOR_FILTER_OK ? MOTOR_CONTROL_OK : MOTOR_CONTROL_RANGE_ERROR;
+}
+
+Motor_ControlStatusTypeDef Motor_Control_Timer_Interrupt_Callback(Motor_ControlTypeDef* pControl){
+	if(pControl == NULL)
+		return MOTOR_CONTROL_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM6->SR = ~(uint32_t)TIM_SR_UIF;
+#endif
+	if(!pControl->Running)
+		return MOTOR_CONTROL_OK;
+
+	//all wheels get setpoints of the same command
+	__setpoints_take(pControl);
+
+	//outputs are off, integrators would wind up against the stopped wheels
+	bool fault = Motor_PWM_Check_Fault(&pControl->PWM) == MOTOR_PWM_FAULT;
+
+	int16_t speed[MOTOR_WHEEL_COUNT];
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++)
+		speed[i] = Motor_Encoder_Update(&pControl->Wheels[i].Encoder);
+
+	int16_t current[MOTOR_ADC_CURRENT_CHANNELS];
+	Motor_ADC_Get_Currents(&pControl->ADC, current);
+
+	//trajectories run while FMAC filters the speeds
+	Motor_Filter_Write(&pControl->SpeedFilter, speed);
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		if(pControl->Wheels[i].PositionMode)
+			__position_setpoint(pControl, &pControl->Wheels[i]);
+	}
+	Motor_Filter_Read(&pControl->SpeedFilter, speed);
+
+	//duties of all wheels start in the same PWM period
+	Motor_PWM_Hold_Update(&pControl->PWM);
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		Motor_WheelTypeDef* pWheel = &pControl->Wheels[i];
+		pWheel->Measured = speed[i];
+		pWheel->Current = current[i];
+		if(fault){
+			Motor_PID_Reset(&pWheel->PID);
+			__leave_position_mode(pWheel);
+			pWheel->Output = 0;
+		} else {
+			pWheel->Output = Motor_PID_Update(&pWheel->PID, pWheel->Setpoint, pWheel->Measured);
+		}
+		Motor_PWM_Set_Duty(&pControl->PWM, i, pWheel->Output);
+	}
+	Motor_PWM_Release_Update(&pControl->PWM);
+
+	int16_t telemetry[MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS];
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++){
+		Motor_WheelTypeDef* pWheel = &pControl->Wheels[i];
+		telemetry[MOTOR_TELEMETRY_SPEED][i] = pWheel->Measured;
+		telemetry[MOTOR_TELEMETRY_CURRENT][i] = pWheel->Current;
+		telemetry[MOTOR_TELEMETRY_DUTY][i] = pWheel->Output;
+		telemetry[MOTOR_TELEMETRY_ERROR][i] = (int16_t)Motor_Q15_Saturate((int32_t)pWheel->Setpoint - pWheel->Measured);
+	}
+	Motor_Telemetry_Write(&pControl->Telemetry, telemetry);
+	pControl->TickCount++;
+
+	return MOTOR_CONTROL_OK;
+}
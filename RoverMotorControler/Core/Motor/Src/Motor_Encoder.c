@@ -0,0 +1,189 @@
+/*
+ * Motor_Encoder.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_Encoder.h"
+#include "Motor_Control.h"
+#include "Motor_GPIO.h"
+#ifdef HOST_BUILD
+#include "Virtual_Rover.h"
+#endif
+
+/*TicksSinceEdge stops there, estimate without edges is already 0 (or below encoder resolution)*/
+#define MOTOR_ENCODER_TICKS_MAX 65535U
+
+#ifndef HOST_BUILD
+/*
+ * Peripherals used by a single encoder
+ * */
+typedef struct {
+	TIM_TypeDef* Timer;
+	GPIO_TypeDef* PortA;
+	uint8_t PinA;
+	GPIO_TypeDef* PortB;
+	uint8_t PinB;
+	uint8_t Alternate;
+	//DMA copying time base on capture of channel 1, DMAMUX channel N drives DMA1 channel N+1
+	DMA_Channel_TypeDef* DMA;
+	DMAMUX_Channel_TypeDef* DMAMUX;
+	uint8_t Request;
+} Motor_EncoderHardwareTypeDef;
+
+static const Motor_EncoderHardwareTypeDef encoder_hardware[MOTOR_WHEEL_COUNT] = {
+	{TIM2, GPIOA, 15, GPIOB, 3, GPIO_AF1_TIM2, DMA1_Channel1, DMAMUX1_Channel0, DMA_REQUEST_TIM2_CH1},
+	{TIM3, GPIOB, 4, GPIOB, 5, GPIO_AF2_TIM3, DMA1_Channel2, DMAMUX1_Channel1, DMA_REQUEST_TIM3_CH1},
+	{TIM4, GPIOB, 6, GPIOB, 7, GPIO_AF2_TIM4, DMA1_Channel3, DMAMUX1_Channel2, DMA_REQUEST_TIM4_CH1},
+	{TIM5, GPIOA, 0, GPIOA, 1, GPIO_AF2_TIM5, DMA1_Channel4, DMAMUX1_Channel3, DMA_REQUEST_TIM5_CH1}
+};
+
+/*TIM7 counts microseconds, it is shared by all encoders*/
+static void __time_base_init(void){
+	if(TIM7->CR1 & TIM_CR1_CEN)
+		return;
+
+	RCC->APB1ENR1 |= RCC_APB1ENR1_TIM7EN;
+	(void)RCC->APB1ENR1;
+
+	TIM7->PSC = SystemCoreClock / MOTOR_ENCODER_TIME_BASE_HZ - 1U;
+	TIM7->ARR = 0xFFFFU;
+	TIM7->EGR = TIM_EGR_UG;
+	TIM7->CR1 = TIM_CR1_CEN;
+}
+
+static void __hardware_init(Motor_EncoderTypeDef* pEncoder){
+	const Motor_EncoderHardwareTypeDef* pHardware = &encoder_hardware[pEncoder->Index];
+
+	RCC->AHB1ENR |= RCC_AHB1ENR_DMA1EN | RCC_AHB1ENR_DMAMUX1EN;
+	RCC->AHB2ENR |= RCC_AHB2ENR_GPIOAEN | RCC_AHB2ENR_GPIOBEN;
+	RCC->APB1ENR1 |= RCC_APB1ENR1_TIM2EN << pEncoder->Index;
+	(void)RCC->APB1ENR1;
+
+	__time_base_init();
+
+	Motor_GPIO_Alternate(pHardware->PortA, pHardware->PinA, pHardware->Alternate);
+	Motor_GPIO_Alternate(pHardware->PortB, pHardware->PinB, pHardware->Alternate);
+
+	//time base counter is copied to EdgeTime on every capture, circular mode re-arms the channel
+	pHardware->DMA->CCR = 0;
+	pHardware->DMAMUX->CCR = pHardware->Request;
+	pHardware->DMA->CPAR = (uint32_t)&TIM7->CNT;
+	pHardware->DMA->CMAR = (uint32_t)&pEncoder->EdgeTime;
+	pHardware->DMA->CNDTR = 1;
+	pHardware->DMA->CCR = DMA_CCR_PSIZE_0 | DMA_CCR_MSIZE_0 | DMA_CCR_CIRC | DMA_CCR_EN;
+
+	TIM_TypeDef* tim = pHardware->Timer;
+	tim->CR1 = 0;
+	//encoder mode 3, both inputs filtered (8 samples), channel 1 captures counter on rising edge of A
+	tim->SMCR = TIM_SMCR_SMS_0 | TIM_SMCR_SMS_1;
+	tim->CCMR1 = TIM_CCMR1_CC1S_0 | TIM_CCMR1_CC2S_0 | (3U << TIM_CCMR1_IC1F_Pos) | (3U << TIM_CCMR1_IC2F_Pos);
+	tim->CCER = TIM_CCER_CC1E;
+	//TIM2 and TIM5 are 32bit, all of them wrap at 16 bits so differences are calculated the same way
+	tim->ARR = 0xFFFFU;
+	tim->CNT = 0;
+	tim->DIER = TIM_DIER_CC1DE;
+	tim->CR1 = TIM_CR1_CEN;
+}
+#endif
+
+/*
+ * @brief Reads counter, position of the last edge and its time, time and position always belong to the same edge
+ * */
+static void __read(Motor_EncoderTypeDef* pEncoder, uint16_t* pCount, uint16_t* pEdgePosition, uint16_t* pEdgeTime){
+#ifndef HOST_BUILD
+	TIM_TypeDef* tim = encoder_hardware[pEncoder->Index].Timer;
+	*pCount = (uint16_t)tim->CNT;
+	//new edge between the two reads changes EdgeTime, read again
+	uint16_t time;
+	do {
+		time = pEncoder->EdgeTime;
+		*pEdgePosition = (uint16_t)tim->CCR1;
+	} while(time != pEncoder->EdgeTime);
+	*pEdgeTime = time;
+#else
+	Virtual_Rover_Encoder_Read(pEncoder->Index, pEncoder->TickTime, pCount, pEdgePosition, pEdgeTime);
+#endif
+}
+
+/*
+ * @brief Converts counts in given time to Q15 speed, saturated to MaxSpeed
+ * */
+static int16_t __speed(Motor_EncoderTypeDef* pEncoder, int32_t counts, uint32_t time){
+	int64_t scaled = (int64_t)counts * pEncoder->SpeedScale;
+	int64_t limit = (int64_t)time * MOTOR_Q15_ONE;
+
+	if(scaled >= limit)
+		return MOTOR_Q15_ONE;
+	if(scaled <= -limit)
+		return -MOTOR_Q15_ONE;
+
+	//single 32bit division unless there were no edges for a long time
+	if(scaled <= INT32_MAX && scaled >= -INT32_MAX && time <= INT32_MAX)
+		return (int16_t)((int32_t)scaled / (int32_t)time);
+	return (int16_t)(scaled / (int64_t)time);
+}
+
+Motor_EncoderStatusTypeDef Motor_Encoder_Init(Motor_EncoderTypeDef* pEncoder, uint8_t index, uint32_t rate, uint32_t max_speed){
+	if(pEncoder == NULL)
+		return MOTOR_ENCODER_NULL_ERROR;
+
+	if(index >= MOTOR_WHEEL_COUNT || rate == 0 || rate > MOTOR_ENCODER_TIME_BASE_HZ || max_speed == 0)
+		return MOTOR_ENCODER_RANGE_ERROR;
+
+	uint64_t scale = (uint64_t)MOTOR_Q15_ONE * MOTOR_ENCODER_TIME_BASE_HZ / max_speed;
+	if(scale == 0 || scale > UINT32_MAX)
+		return MOTOR_ENCODER_RANGE_ERROR;
+
+	pEncoder->Index = index;
+	pEncoder->MaxSpeed = max_speed;
+	pEncoder->SpeedScale = (uint32_t)scale;
+	pEncoder->TickTime = MOTOR_ENCODER_TIME_BASE_HZ / rate;
+
+	pEncoder->EdgeTime = 0;
+	pEncoder->Position = 0;
+	pEncoder->TicksSinceEdge = MOTOR_ENCODER_TICKS_MAX;
+	pEncoder->Speed = 0;
+
+#ifndef HOST_BUILD
+	__hardware_init(pEncoder);
+#endif
+
+	uint16_t count, edge_position, edge_time;
+	__read(pEncoder, &count, &edge_position, &edge_time);
+	pEncoder->PreviousCount = count;
+	pEncoder->EdgePosition = edge_position;
+	pEncoder->PreviousEdgeTime = edge_time;
+
+	return MOTOR_ENCODER_OK;
+}
+
+int16_t Motor_Encoder_Update(Motor_EncoderTypeDef* pEncoder){
+	uint16_t count, edge_position, edge_time;
+	__read(pEncoder, &count, &edge_position, &edge_time);
+
+	pEncoder->Position += (int16_t)(count - pEncoder->PreviousCount);
+	pEncoder->PreviousCount = count;
+
+	if(pEncoder->TicksSinceEdge < MOTOR_ENCODER_TICKS_MAX)
+		pEncoder->TicksSinceEdge++;
+	uint32_t since_edge = pEncoder->TicksSinceEdge * pEncoder->TickTime;
+
+	if(edge_position != pEncoder->EdgePosition){
+		int32_t counts = (int16_t)(edge_position - pEncoder->EdgePosition);
+		//previous edge happened at most one tick before it was seen
+		uint32_t time = since_edge + pEncoder->TickTime < MOTOR_ENCODER_TIME_BASE_LIMIT_US
+				? (uint16_t)(edge_time - pEncoder->PreviousEdgeTime) : since_edge;
+		if(time > 0)
+			pEncoder->Speed = __speed(pEncoder, counts, time);
+
+		pEncoder->EdgePosition = edge_position;
+		pEncoder->PreviousEdgeTime = edge_time;
+		pEncoder->TicksSinceEdge = 0;
+	} else {
+		//next edge hasn't come yet, wheel is at most as fast as one edge in the time since the last one
+		int16_t bound = __speed(pEncoder, MOTOR_ENCODER_COUNTS_PER_EDGE, since_edge);
+		pEncoder->Speed = (int16_t)Motor_Q15_Clamp(pEncoder->Speed, -bound, bound);
+	}
+
+	return pEncoder->Speed;
+}
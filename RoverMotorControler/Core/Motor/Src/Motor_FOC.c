@@ -0,0 +1,238 @@
+/*
+ * Motor_FOC.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_FOC.h"
+
+/*CORDIC functions (FUNC field of CSR)*/
+#define MOTOR_FOC_CORDIC_COSINE 0U
+#define MOTOR_FOC_CORDIC_PHASE 2U
+
+/*1 / sqrt(3) and sqrt(3) / 2 in Q15*/
+#define MOTOR_FOC_INV_SQRT3 18919
+#define MOTOR_FOC_SQRT3_2 28378
+
+#ifndef HOST_BUILD
+/*
+ * @brief Selects CORDIC function, 16bit arguments and results, one write and one read per calculation
+ * */
+static inline void __cordic_configure(uint32_t function){
+	CORDIC->CSR = (function << CORDIC_CSR_FUNC_Pos) | (MOTOR_FOC_CORDIC_PRECISION << CORDIC_CSR_PRECISION_Pos)
+			| CORDIC_CSR_ARGSIZE | CORDIC_CSR_RESSIZE;
+}
+
+/*
+ * @brief Starts calculation
+ * */
+static inline void __cordic_write(int16_t argument1, int16_t argument2){
+	CORDIC->WDATA = (uint16_t)argument1 | ((uint32_t)(uint16_t)argument2 << 16);
+}
+
+/*
+ * @brief Reads both results, bus is stalled until the calculation is finished
+ * */
+static inline void __cordic_read(int16_t* pResult1, int16_t* pResult2){
+	uint32_t result = CORDIC->RDATA;
+	*pResult1 = (int16_t)result;
+	*pResult2 = (int16_t)(result >> 16);
+}
+#else
+/*Angles of the software CORDIC iterations, atan(2^-i) where pi is 2^30*/
+static const int32_t cordic_angles[] = {
+	268435456, 158466703, 83729454, 42502378, 21333666, 10677233, 5339919, 2670123,
+	1335082, 667543, 333772, 166886, 83443, 41722, 20861, 10430,
+	5215, 2608, 1304, 652, 326, 163, 81, 41
+};
+/*1 / gain of the iterations (Q29)*/
+#define MOTOR_FOC_CORDIC_GAIN_INV 326016437
+
+static uint32_t cordic_function;
+static int16_t cordic_argument1;
+static int16_t cordic_argument2;
+
+static inline void __cordic_configure(uint32_t function){
+	cordic_function = function;
+}
+
+static inline void __cordic_write(int16_t argument1, int16_t argument2){
+	cordic_argument1 = argument1;
+	cordic_argument2 = argument2;
+}
+
+/*
+ * @brief Rounds Q29 result to Q15
+ * */
+static int16_t __cordic_result(int32_t value){
+	return (int16_t)Motor_Q15_Saturate((value + (1 << 13)) >> 14);
+}
+
+/*
+ * @brief Software CORDIC: rotation (cosine, modulus is argument 2) or vectoring (phase, modulus)
+ * */
+static inline void __cordic_read(int16_t* pResult1, int16_t* pResult2){
+	int32_t x, y, z;
+
+	if(cordic_function == MOTOR_FOC_CORDIC_COSINE){
+		//rotate (1, 0) by the angle, rotations converge within +-pi/2, other half is mirrored
+		z = (int32_t)cordic_argument1 << 15;
+		int32_t modulus = ((int64_t)MOTOR_FOC_CORDIC_GAIN_INV * cordic_argument2) >> 15;
+		x = modulus;
+		y = 0;
+		if(z > (1 << 29) || z < -(1 << 29)){
+			z += z > 0 ? -(1 << 30) : (1 << 30);
+			x = -modulus;
+		}
+		for(uint8_t i = 0; i < sizeof(cordic_angles) / sizeof(cordic_angles[0]); i++){
+			int32_t dx = x >> i;
+			int32_t dy = y >> i;
+			if(z >= 0){
+				x -= dy;
+				y += dx;
+				z -= cordic_angles[i];
+			} else {
+				x += dy;
+				y -= dx;
+				z += cordic_angles[i];
+			}
+		}
+		*pResult1 = __cordic_result(x);
+		*pResult2 = __cordic_result(y);
+	} else {
+		//rotate (x, y) to the x axis, accumulated angle is the phase
+		x = (int32_t)cordic_argument1 << 14;
+		y = (int32_t)cordic_argument2 << 14;
+		z = 0;
+		if(x < 0){
+			x = -x;
+			y = -y;
+			z = 1 << 30;
+		}
+		for(uint8_t i = 0; i < sizeof(cordic_angles) / sizeof(cordic_angles[0]); i++){
+			int32_t dx = x >> i;
+			int32_t dy = y >> i;
+			if(y > 0){
+				x += dy;
+				y -= dx;
+				z += cordic_angles[i];
+			} else {
+				x -= dy;
+				y += dx;
+				z -= cordic_angles[i];
+			}
+		}
+		//angle wraps at pi like the hardware result
+		*pResult1 = (int16_t)(uint16_t)((uint32_t)(z + (1 << 14)) >> 15);
+		*pResult2 = __cordic_result((int32_t)(((int64_t)x * MOTOR_FOC_CORDIC_GAIN_INV) >> 29));
+	}
+}
+#endif
+
+/*
+ * @brief Space vector modulation of alpha/beta voltage (min-max injection)
+ * */
+static void __modulate(int32_t alpha, int32_t beta, uint16_t* pDuty){
+	int32_t phase[MOTOR_PWM_PHASES];
+	phase[0] = alpha;
+	phase[1] = -(alpha >> 1) + ((beta * MOTOR_FOC_SQRT3_2) >> 15);
+	phase[2] = -phase[0] - phase[1];
+
+	int32_t max = phase[0];
+	int32_t min = phase[0];
+	for(uint8_t i = 1; i < MOTOR_PWM_PHASES; i++){
+		if(phase[i] > max)
+			max = phase[i];
+		if(phase[i] < min)
+			min = phase[i];
+	}
+	int32_t middle = (max + min) >> 1;
+
+	//phase voltage 1 is Vdc / sqrt(3), after the shift it swings +-Vdc / 2 around 50% duty at most
+	for(uint8_t i = 0; i < MOTOR_PWM_PHASES; i++){
+		int32_t duty = (MOTOR_Q15_ONE + 1) / 2 + (((phase[i] - middle) * MOTOR_FOC_INV_SQRT3) >> 15);
+		pDuty[i] = (uint16_t)Motor_Q15_Clamp(duty, 0, MOTOR_Q15_ONE);
+	}
+}
+
+Motor_FOCStatusTypeDef Motor_FOC_Init(Motor_FOCTypeDef* pFOC, const Motor_PIDConfigTypeDef* pConfig){
+	if(pFOC == NULL || pConfig == NULL)
+		return MOTOR_FOC_NULL_ERROR;
+
+	if(Motor_PID_Init(&pFOC->PIDDirect, pConfig) != MOTOR_PID_OK)
+		return MOTOR_FOC_RANGE_ERROR;
+	Motor_PID_Init(&pFOC->PIDQuadrature, pConfig);
+
+	pFOC->Angle = 0;
+	pFOC->SensorCos = 0;
+	pFOC->SensorSin = 0;
+	pFOC->CurrentA = 0;
+	pFOC->CurrentB = 0;
+	pFOC->CurrentDRef = 0;
+	pFOC->CurrentQRef = 0;
+	pFOC->CurrentD = 0;
+	pFOC->CurrentQ = 0;
+	pFOC->VoltageD = 0;
+	pFOC->VoltageQ = 0;
+	for(uint8_t i = 0; i < MOTOR_PWM_PHASES; i++)
+		pFOC->Duty[i] = MOTOR_Q15_ONE / 2;
+
+#ifndef HOST_BUILD
+	RCC->AHB1ENR |= RCC_AHB1ENR_CORDICEN;
+	(void)RCC->AHB1ENR;
+#endif
+	__cordic_configure(MOTOR_FOC_CORDIC_COSINE);
+
+	return MOTOR_FOC_OK;
+}
+
+void Motor_FOC_Update(Motor_FOCTypeDef* pFOC, uint8_t count){
+	if(count == 0)
+		return;
+
+	__cordic_configure(MOTOR_FOC_CORDIC_COSINE);
+	__cordic_write(pFOC[0].Angle, MOTOR_Q15_ONE);
+
+	for(uint8_t i = 0; i < count; i++){
+		Motor_FOCTypeDef* pMotor = &pFOC[i];
+
+		//Clarke runs while CORDIC calculates cos/sin of this motor
+		int32_t alpha = pMotor->CurrentA;
+		int32_t beta = Motor_Q15_Saturate(((alpha + 2 * pMotor->CurrentB) * MOTOR_FOC_INV_SQRT3) >> 15);
+
+		int16_t cosine, sine;
+		__cordic_read(&cosine, &sine);
+		if(i + 1U < count)
+			__cordic_write(pFOC[i + 1U].Angle, MOTOR_Q15_ONE);
+
+		//Park, products are shifted separately so the sum can't overflow
+		pMotor->CurrentD = (int16_t)Motor_Q15_Saturate(Motor_Q15_Multiply(alpha, cosine) + Motor_Q15_Multiply(beta, sine));
+		pMotor->CurrentQ = (int16_t)Motor_Q15_Saturate(Motor_Q15_Multiply(beta, cosine) - Motor_Q15_Multiply(alpha, sine));
+
+		pMotor->VoltageD = Motor_PID_Update(&pMotor->PIDDirect, pMotor->CurrentDRef, pMotor->CurrentD);
+		pMotor->VoltageQ = Motor_PID_Update(&pMotor->PIDQuadrature, pMotor->CurrentQRef, pMotor->CurrentQ);
+
+		//inverse Park
+		int32_t voltage_alpha = Motor_Q15_Multiply(pMotor->VoltageD, cosine) - Motor_Q15_Multiply(pMotor->VoltageQ, sine);
+		int32_t voltage_beta = Motor_Q15_Multiply(pMotor->VoltageD, sine) + Motor_Q15_Multiply(pMotor->VoltageQ, cosine);
+
+		__modulate(voltage_alpha, voltage_beta, pMotor->Duty);
+	}
+}
+
+void Motor_FOC_Estimate_Angle(Motor_FOCTypeDef* pFOC, uint8_t count){
+	if(count == 0)
+		return;
+
+	__cordic_configure(MOTOR_FOC_CORDIC_PHASE);
+	__cordic_write(pFOC[0].SensorCos, pFOC[0].SensorSin);
+
+	for(uint8_t i = 0; i < count; i++){
+		int16_t angle, modulus;
+		__cordic_read(&angle, &modulus);
+		if(i + 1U < count)
+			__cordic_write(pFOC[i + 1U].SensorCos, pFOC[i + 1U].SensorSin);
+		pFOC[i].Angle = angle;
+	}
+
+	__cordic_configure(MOTOR_FOC_CORDIC_COSINE);
+}
@@ -0,0 +1,192 @@
+/*
+ * Motor_Filter.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_Filter.h"
+
+/*FMAC functions (FUNC field of PARAM)*/
+#define MOTOR_FILTER_FUNC_LOAD_X1 1U
+#define MOTOR_FILTER_FUNC_LOAD_X2 2U
+#define MOTOR_FILTER_FUNC_LOAD_Y 3U
+#define MOTOR_FILTER_FUNC_FIR 8U
+#define MOTOR_FILTER_FUNC_IIR 9U
+
+/*Width of the FMAC accumulator and bits dropped from every product*/
+#define MOTOR_FILTER_ACCUMULATOR_BITS 26U
+#define MOTOR_FILTER_PRODUCT_SHIFT 8U
+
+/*Largest number of interleaved coefficients, with samples and outputs they take less than 256 words of FMAC memory*/
+#define MOTOR_FILTER_COEFFICIENTS_MAX ((MOTOR_FILTER_TAPS_MAX - 1U + MOTOR_FILTER_FEEDBACK_MAX) * MOTOR_FILTER_CHANNELS_MAX + 1U)
+
+#ifndef HOST_BUILD
+/*
+ * @brief Runs one of the load functions of FMAC, values are written to WDATA until the function finishes
+ * */
+static void __fmac_load(uint32_t function, uint8_t p, uint8_t q, const int16_t* pValues, uint16_t count){
+	FMAC->PARAM = (function << FMAC_PARAM_FUNC_Pos) | ((uint32_t)p << FMAC_PARAM_P_Pos) | ((uint32_t)q << FMAC_PARAM_Q_Pos) | FMAC_PARAM_START;
+	for(uint16_t i = 0; i < count; i++)
+		FMAC->WDATA = pValues == NULL ? 0U : (uint16_t)pValues[i];
+}
+#else
+/*
+ * @brief Software model of one FMAC output, history of the channel is shifted
+ * */
+static int16_t __model(Motor_FilterTypeDef* pFilter, uint8_t channel, int16_t input){
+	const Motor_FilterConfigTypeDef* pConfig = &pFilter->Config;
+	int16_t* pInputHistory = pFilter->InputHistory[channel];
+	int16_t* pOutputHistory = pFilter->OutputHistory[channel];
+
+	for(uint8_t k = pConfig->FeedForward - 1U; k > 0; k--)
+		pInputHistory[k] = pInputHistory[k - 1U];
+	pInputHistory[0] = input;
+
+	int32_t accumulator = 0;
+	for(uint8_t k = 0; k < pConfig->FeedForward; k++)
+		accumulator += ((int32_t)pConfig->B[k] * pInputHistory[k]) >> MOTOR_FILTER_PRODUCT_SHIFT;
+	for(uint8_t k = 0; k < pConfig->Feedback; k++)
+		accumulator += ((int32_t)pConfig->A[k] * pOutputHistory[k]) >> MOTOR_FILTER_PRODUCT_SHIFT;
+
+	//accumulator wraps, gain shifts it before q1.15 bits are taken
+	accumulator = (int32_t)((uint32_t)accumulator << (32U - MOTOR_FILTER_ACCUMULATOR_BITS)) >> (32U - MOTOR_FILTER_ACCUMULATOR_BITS);
+	int64_t shifted = ((int64_t)accumulator * (1 << pConfig->Gain)) >> (30U - 15U - MOTOR_FILTER_PRODUCT_SHIFT);
+	int16_t output = (int16_t)(shifted > INT16_MAX ? INT16_MAX : shifted < INT16_MIN ? INT16_MIN : shifted);
+
+	for(uint8_t k = pConfig->Feedback; k > 1U; k--)
+		pOutputHistory[k - 1U] = pOutputHistory[k - 2U];
+	pOutputHistory[0] = output;
+
+	return output;
+}
+#endif
+
+Motor_FilterStatusTypeDef Motor_Filter_Init(Motor_FilterTypeDef* pFilter, uint8_t channels){
+	if(pFilter == NULL)
+		return MOTOR_FILTER_NULL_ERROR;
+
+	if(channels == 0 || channels > MOTOR_FILTER_CHANNELS_MAX)
+		return MOTOR_FILTER_RANGE_ERROR;
+
+	pFilter->Channels = channels;
+	pFilter->FaultCount = 0;
+	for(uint8_t i = 0; i < MOTOR_FILTER_CHANNELS_MAX; i++)
+		pFilter->Output[i] = 0;
+
+	const Motor_FilterConfigTypeDef bypass = {.Type = MOTOR_FILTER_BYPASS};
+	return Motor_Filter_Configure(pFilter, &bypass);
+}
+
+Motor_FilterStatusTypeDef Motor_Filter_Configure(Motor_FilterTypeDef* pFilter, const Motor_FilterConfigTypeDef* pConfig){
+	if(pFilter == NULL || pConfig == NULL)
+		return MOTOR_FILTER_NULL_ERROR;
+
+	switch(pConfig->Type){
+	case MOTOR_FILTER_BYPASS:
+		break;
+	case MOTOR_FILTER_FIR:
+		if(pConfig->FeedForward < 2U || pConfig->FeedForward > MOTOR_FILTER_TAPS_MAX || pConfig->Feedback != 0)
+			return MOTOR_FILTER_RANGE_ERROR;
+		break;
+	case MOTOR_FILTER_IIR:
+		if(pConfig->FeedForward < 2U || pConfig->FeedForward > MOTOR_FILTER_IIR_TAPS_MAX
+				|| pConfig->Feedback < 1U || pConfig->Feedback > MOTOR_FILTER_FEEDBACK_MAX)
+			return MOTOR_FILTER_RANGE_ERROR;
+		break;
+	default:
+		return MOTOR_FILTER_RANGE_ERROR;
+	}
+	if(pConfig->Gain > MOTOR_FILTER_GAIN_MAX)
+		return MOTOR_FILTER_RANGE_ERROR;
+
+	pFilter->Config = *pConfig;
+	for(uint8_t i = 0; i < MOTOR_FILTER_CHANNELS_MAX; i++){
+		for(uint8_t k = 0; k < MOTOR_FILTER_TAPS_MAX; k++)
+			pFilter->InputHistory[i][k] = 0;
+		for(uint8_t k = 0; k < MOTOR_FILTER_FEEDBACK_MAX; k++)
+			pFilter->OutputHistory[i][k] = 0;
+	}
+
+#ifndef HOST_BUILD
+	RCC->AHB1ENR |= RCC_AHB1ENR_FMACEN;
+	(void)RCC->AHB1ENR;
+
+	FMAC->CR = FMAC_CR_RESET;
+	while(FMAC->CR & FMAC_CR_RESET);
+
+	if(pConfig->Type == MOTOR_FILTER_BYPASS)
+		return MOTOR_FILTER_OK;
+
+	//coefficients of interleaved channels: B[k] multiplies x[n - k * N], A[k] multiplies y[n - (k + 1) * N]
+	uint8_t channels = pFilter->Channels;
+	uint8_t p = (uint8_t)((pConfig->FeedForward - 1U) * channels + 1U);
+	uint8_t q = (uint8_t)(pConfig->Feedback * channels);
+	int16_t coefficients[MOTOR_FILTER_COEFFICIENTS_MAX];
+	for(uint8_t i = 0; i < p; i++)
+		coefficients[i] = i % channels == 0 ? pConfig->B[i / channels] : 0;
+	for(uint8_t i = 0; i < q; i++)
+		coefficients[p + i] = (i + 1U) % channels == 0 ? pConfig->A[i / channels] : 0;
+
+	//memory: coefficients, samples (history and one sample of every channel), outputs
+	uint8_t x1_base = p + q;
+	uint8_t x1_size = p + channels;
+	uint8_t y_base = x1_base + x1_size;
+	uint8_t y_size = q + channels;
+	FMAC->X2BUFCFG = ((uint32_t)(p + q) << FMAC_X2BUFCFG_X2_BUF_SIZE_Pos);
+	FMAC->X1BUFCFG = ((uint32_t)x1_base << FMAC_X1BUFCFG_X1_BASE_Pos) | ((uint32_t)x1_size << FMAC_X1BUFCFG_X1_BUF_SIZE_Pos);
+	FMAC->YBUFCFG = ((uint32_t)y_base << FMAC_YBUFCFG_Y_BASE_Pos) | ((uint32_t)y_size << FMAC_YBUFCFG_Y_BUF_SIZE_Pos);
+
+	__fmac_load(MOTOR_FILTER_FUNC_LOAD_X2, p, q, coefficients, p + q);
+	//history is zero, the first written sample gives the first output
+	__fmac_load(MOTOR_FILTER_FUNC_LOAD_X1, p - 1U, 0, NULL, p - 1U);
+	if(q != 0)
+		__fmac_load(MOTOR_FILTER_FUNC_LOAD_Y, q, 0, NULL, q);
+
+	FMAC->CR = FMAC_CR_CLIPEN;
+	uint32_t function = pConfig->Type == MOTOR_FILTER_FIR ? MOTOR_FILTER_FUNC_FIR : MOTOR_FILTER_FUNC_IIR;
+	FMAC->PARAM = (function << FMAC_PARAM_FUNC_Pos) | ((uint32_t)p << FMAC_PARAM_P_Pos) | ((uint32_t)q << FMAC_PARAM_Q_Pos)
+			| ((uint32_t)pConfig->Gain << FMAC_PARAM_R_Pos) | FMAC_PARAM_START;
+#endif
+
+	return MOTOR_FILTER_OK;
+}
+
+void Motor_Filter_Write(Motor_FilterTypeDef* pFilter, const int16_t* pInput){
+	if(pFilter->Config.Type == MOTOR_FILTER_BYPASS){
+		for(uint8_t i = 0; i < pFilter->Channels; i++)
+			pFilter->Output[i] = pInput[i];
+		return;
+	}
+
+	//X1 has space for one sample of every channel, previous ones were consumed before their outputs were read
+	for(uint8_t i = 0; i < pFilter->Channels; i++){
+#ifndef HOST_BUILD
+		FMAC->WDATA = (uint16_t)pInput[i];
+		//replaced by FMAC output, unless Motor_Filter_Read() falls back to bypass
+		pFilter->Output[i] = pInput[i];
+#else
+		pFilter->Output[i] = __model(pFilter, i, pInput[i]);
+#endif
+	}
+}
+
+void Motor_Filter_Read(Motor_FilterTypeDef* pFilter, int16_t* pOutput){
+#ifndef HOST_BUILD
+	if(pFilter->Config.Type != MOTOR_FILTER_BYPASS){
+		for(uint8_t i = 0; i < pFilter->Channels; i++){
+			uint32_t polls = MOTOR_FILTER_READ_TIMEOUT;
+			while((FMAC->SR & FMAC_SR_YEMPTY) && --polls > 0U);
+
+			if(polls == 0U){
+				//stuck FMAC must not stall control interrupt, remaining channels keep their unfiltered samples
+				FMAC->CR = FMAC_CR_RESET;
+				pFilter->Config.Type = MOTOR_FILTER_BYPASS;
+				pFilter->FaultCount++;
+				break;
+			}
+			pFilter->Output[i] = (int16_t)FMAC->RDATA;
+		}
+	}
+#endif
+	for(uint8_t i = 0; i < pFilter->Channels; i++)
+		pOutput[i] = pFilter->Output[i];
+}
@@ -0,0 +1,70 @@
+/*
+ * Motor_PID.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_PID.h"
+
+Motor_PIDStatusTypeDef Motor_PID_Init(Motor_PIDTypeDef* pPID, const Motor_PIDConfigTypeDef* pConfig){
+	if(pPID == NULL || pConfig == NULL)
+		return MOTOR_PID_NULL_ERROR;
+
+	if(pConfig->Scale > MOTOR_PID_SCALE_MAX || pConfig->OutputMin > pConfig->OutputMax)
+		return MOTOR_PID_RANGE_ERROR;
+
+	pPID->Config = *pConfig;
+
+	//integral alone can drive output exactly to its limits, |limit| << 15 always fits 32bits
+	uint8_t shift = 15U - pConfig->Scale;
+	pPID->IntegralMin = (int32_t)pConfig->OutputMin * (1 << shift);
+	pPID->IntegralMax = (int32_t)pConfig->OutputMax * (1 << shift);
+
+	return Motor_PID_Reset(pPID);
+}
+
+Motor_PIDStatusTypeDef Motor_PID_Reset(Motor_PIDTypeDef* pPID){
+	if(pPID == NULL)
+		return MOTOR_PID_NULL_ERROR;
+
+	pPID->Integral = 0;
+	pPID->PreviousMeasured = 0;
+	pPID->Output = 0;
+	pPID->Saturated = false;
+
+	return MOTOR_PID_OK;
+}
+
+int16_t Motor_PID_Update(Motor_PIDTypeDef* pPID, int16_t setpoint, int16_t measured){
+	const Motor_PIDConfigTypeDef* pConfig = &pPID->Config;
+
+	int32_t error = Motor_Q15_Saturate((int32_t)setpoint - measured);
+	int32_t delta = Motor_Q15_Saturate((int32_t)measured - pPID->PreviousMeasured);
+	pPID->PreviousMeasured = measured;
+
+	//every product is Q30, sum of them can exceed 32bits (SMLAL on the target)
+	int64_t sum = (int64_t)pConfig->Kp * error
+			+ (int64_t)pConfig->Kff * setpoint
+			- (int64_t)pConfig->Kd * delta;
+
+	int32_t integral = Motor_Q15_Clamp(pPID->Integral + pConfig->Ki * error, pPID->IntegralMin, pPID->IntegralMax);
+	sum += integral;
+
+	int64_t output = sum >> (15U - pConfig->Scale);
+	pPID->Saturated = true;
+	if(output > pConfig->OutputMax){
+		output = pConfig->OutputMax;
+		//error would wind integral further over the limit
+		if(error > 0)
+			integral = pPID->Integral;
+	} else if(output < pConfig->OutputMin){
+		output = pConfig->OutputMin;
+		if(error < 0)
+			integral = pPID->Integral;
+	} else {
+		pPID->Saturated = false;
+	}
+
+	pPID->Integral = integral;
+	pPID->Output = (int16_t)output;
+	return pPID->Output;
+}
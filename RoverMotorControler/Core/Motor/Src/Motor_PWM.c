@@ -0,0 +1,300 @@
+/*
+ * Motor_PWM.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_PWM.h"
+#include "Motor_GPIO.h"
+
+/*Largest dead-time in timer clock cycles which can be set in BDTR (DTG = 0xFF)*/
+#define MOTOR_PWM_DEAD_TIME_MAX_TICKS 1008U
+/*Compare of channel 4, OC4REF (PWM mode 1) is active only while the counter is 0, at the valley of the period*/
+#define MOTOR_PWM_SAMPLE_COMPARE 1U
+
+#ifndef HOST_BUILD
+/*
+ * Timer channel of a single wheel
+ * */
+typedef struct {
+	TIM_TypeDef* Timer;
+	//compare register of the channel
+	volatile uint32_t* pCompare;
+	//direction output
+	GPIO_TypeDef* DirectionPort;
+	uint8_t DirectionPin;
+} Motor_PWMChannelTypeDef;
+
+/*
+ * Pin connected to alternate function of the timer
+ * */
+typedef struct {
+	GPIO_TypeDef* Port;
+	uint8_t Pin;
+	uint8_t Alternate;
+} Motor_PWMPinTypeDef;
+
+static const Motor_PWMChannelTypeDef pwm_channels[MOTOR_PWM_CHANNELS] = {
+	{TIM1, &TIM1->CCR1, GPIOC, 0},
+	{TIM1, &TIM1->CCR2, GPIOC, 1},
+	{TIM8, &TIM8->CCR1, GPIOC, 2},
+	{TIM8, &TIM8->CCR2, GPIOC, 3}
+};
+
+static TIM_TypeDef* const pwm_bridges[MOTOR_PWM_BRIDGES] = {TIM1, TIM8};
+
+static const Motor_PWMPinTypeDef pwm_pins[] = {
+	//TIM1 CH1, CH1N, CH2, CH2N, BKIN
+	{GPIOA, 8, GPIO_AF6_TIM1}, {GPIOB, 13, GPIO_AF6_TIM1}, {GPIOA, 9, GPIO_AF6_TIM1}, {GPIOB, 14, GPIO_AF6_TIM1}, {GPIOB, 12, GPIO_AF6_TIM1},
+	//TIM8 CH1, CH1N, CH2, CH2N, BKIN
+	{GPIOC, 6, GPIO_AF4_TIM8}, {GPIOC, 10, GPIO_AF4_TIM8}, {GPIOC, 7, GPIO_AF4_TIM8}, {GPIOC, 11, GPIO_AF4_TIM8}, {GPIOA, 6, GPIO_AF4_TIM8},
+#ifdef MOTOR_PWM_THREE_PHASE
+	//TIM1 CH3, CH3N, TIM8 CH3, CH3N
+	{GPIOA, 10, GPIO_AF6_TIM1}, {GPIOB, 15, GPIO_AF4_TIM1}, {GPIOC, 8, GPIO_AF4_TIM8}, {GPIOC, 12, GPIO_AF4_TIM8}
+#endif
+};
+
+/*
+ * @brief Configures one of the advanced timers, counter is not started
+ * */
+static void __timer_init(TIM_TypeDef* tim, uint32_t period, uint32_t dead_time){
+	//center-aligned mode 1, one update event per period, so preloaded values change once per period,
+	//odd RCR written before the counter is started puts the update on the overflow (RM0440), compare values change
+	//at the peak in the middle of the off-time and both halves of every pulse use the same duty
+	tim->CR1 = TIM_CR1_CMS_0 | TIM_CR1_ARPE;
+	tim->PSC = 0;
+	tim->ARR = period;
+	tim->RCR = 1;
+
+	//PWM mode 1 with preloaded compare on channels 1 and 2, both outputs of each pair are enabled
+	tim->CCMR1 = TIM_CCMR1_OC1M_1 | TIM_CCMR1_OC1M_2 | TIM_CCMR1_OC1PE
+			| TIM_CCMR1_OC2M_1 | TIM_CCMR1_OC2M_2 | TIM_CCMR1_OC2PE;
+	tim->CCR1 = 0;
+	tim->CCR2 = 0;
+	tim->CCER = TIM_CCER_CC1E | TIM_CCER_CC1NE | TIM_CCER_CC2E | TIM_CCER_CC2NE;
+	//channel 4 has no output, its reference marks the valley (middle of the on-time) for current sampling
+	tim->CCMR2 = TIM_CCMR2_OC4M_1 | TIM_CCMR2_OC4M_2;
+	tim->CCR4 = MOTOR_PWM_SAMPLE_COMPARE;
+#ifdef MOTOR_PWM_THREE_PHASE
+	//third phase, all phases start at 50% so motor gets no voltage when outputs are enabled
+	tim->CCMR2 |= TIM_CCMR2_OC3M_1 | TIM_CCMR2_OC3M_2 | TIM_CCMR2_OC3PE;
+	tim->CCR1 = period / 2U;
+	tim->CCR2 = period / 2U;
+	tim->CCR3 = period / 2U;
+	tim->CCER |= TIM_CCER_CC3E | TIM_CCER_CC3NE;
+#endif
+
+	//break input active low with filter, outputs are driven to inactive level when disabled,
+	//MOE is cleared by break and set only by software (AOE = 0)
+	tim->BDTR = (dead_time << TIM_BDTR_DTG_Pos) | (3U << TIM_BDTR_BKF_Pos) | TIM_BDTR_BKE | TIM_BDTR_OSSR | TIM_BDTR_OSSI;
+
+	//load preloaded registers and the repetition counter
+	tim->EGR = TIM_EGR_UG;
+	tim->SR = 0;
+}
+#endif
+
+/*
+ * @brief Encodes dead-time in timer clock cycles to DTG field of BDTR
+ *
+ * @retval int32_t DTG value, -1 if dead-time is too long
+ * */
+static int32_t __dead_time_encode(uint32_t ticks){
+	if(ticks < 128U)
+		return (int32_t)ticks;
+	if(ticks < 256U)
+		return (int32_t)(0x80U | (ticks / 2U - 64U));
+	if(ticks < 512U)
+		return (int32_t)(0xC0U | (ticks / 8U - 32U));
+	if(ticks <= MOTOR_PWM_DEAD_TIME_MAX_TICKS)
+		return (int32_t)(0xE0U | (ticks / 16U - 32U));
+	return -1;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Init(Motor_PWMTypeDef* pPWM, uint32_t frequency, uint32_t dead_time){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+	//counter goes up and down, period takes 2 * ARR timer cycles
+	if(frequency == 0)
+		return MOTOR_PWM_RANGE_ERROR;
+	uint32_t period = SystemCoreClock / (2U * frequency);
+	if(period < 2U || period > 0xFFFFU)
+		return MOTOR_PWM_RANGE_ERROR;
+
+	int32_t dtg = __dead_time_encode((uint32_t)((uint64_t)dead_time * SystemCoreClock / 1000000000U));
+	if(dtg < 0)
+		return MOTOR_PWM_RANGE_ERROR;
+
+	pPWM->Period = period;
+	pPWM->Fault = false;
+	pPWM->FaultCount = 0;
+	for(uint8_t i = 0; i < MOTOR_PWM_CHANNELS; i++){
+		pPWM->Duty[i] = 0;
+		pPWM->Reverse[i] = false;
+	}
+	for(uint8_t i = 0; i < MOTOR_PWM_BRIDGES; i++){
+		for(uint8_t phase = 0; phase < MOTOR_PWM_PHASES; phase++)
+			pPWM->Phases[i][phase] = MOTOR_Q15_ONE / 2;
+	}
+
+#ifndef HOST_BUILD
+	RCC->APB2ENR |= RCC_APB2ENR_TIM1EN | RCC_APB2ENR_TIM8EN;
+	RCC->AHB2ENR |= RCC_AHB2ENR_GPIOAEN | RCC_AHB2ENR_GPIOBEN | RCC_AHB2ENR_GPIOCEN;
+	(void)RCC->AHB2ENR;
+
+	__timer_init(TIM1, period, (uint32_t)dtg);
+	__timer_init(TIM8, period, (uint32_t)dtg);
+
+	//TIM1 enable is its trigger output, TIM8 starts on it (trigger mode, ITR0 = TIM1),
+	//OC4REF is TRGO2, its rising edge at the valley starts current sampling (Motor_ADC) in the middle of the on-time,
+	//independent of the update event, which can also be held by Motor_PWM_Hold_Update()
+	TIM1->CR2 = TIM_CR2_MMS_0 | TIM_CR2_MMS2_0 | TIM_CR2_MMS2_1 | TIM_CR2_MMS2_2;
+	TIM8->SMCR = TIM_SMCR_SMS_1 | TIM_SMCR_SMS_2;
+
+	for(uint8_t i = 0; i < sizeof(pwm_pins) / sizeof(pwm_pins[0]); i++)
+		Motor_GPIO_Alternate(pwm_pins[i].Port, pwm_pins[i].Pin, pwm_pins[i].Alternate);
+#ifndef MOTOR_PWM_THREE_PHASE
+	for(uint8_t i = 0; i < MOTOR_PWM_CHANNELS; i++)
+		Motor_GPIO_Output(pwm_channels[i].DirectionPort, pwm_channels[i].DirectionPin, false);
+#endif
+
+	TIM1->CR1 |= TIM_CR1_CEN;
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Enable(Motor_PWMTypeDef* pPWM){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM1->SR = ~(uint32_t)TIM_SR_BIF;
+	TIM8->SR = ~(uint32_t)TIM_SR_BIF;
+	TIM1->BDTR |= TIM_BDTR_MOE;
+	TIM8->BDTR |= TIM_BDTR_MOE;
+
+	//active break input clears MOE again at once
+	if(!(TIM1->BDTR & TIM_BDTR_MOE) || !(TIM8->BDTR & TIM_BDTR_MOE))
+		return MOTOR_PWM_FAULT;
+#endif
+	pPWM->Fault = false;
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Disable(Motor_PWMTypeDef* pPWM){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM1->BDTR &= ~TIM_BDTR_MOE;
+	TIM8->BDTR &= ~TIM_BDTR_MOE;
+#endif
+#ifndef MOTOR_PWM_THREE_PHASE
+	for(uint8_t i = 0; i < MOTOR_PWM_CHANNELS; i++)
+		Motor_PWM_Set_Duty(pPWM, i, 0);
+#else
+	static const uint16_t zero[MOTOR_PWM_PHASES] = {MOTOR_Q15_ONE / 2, MOTOR_Q15_ONE / 2, MOTOR_Q15_ONE / 2};
+	for(uint8_t i = 0; i < MOTOR_PWM_BRIDGES; i++)
+		Motor_PWM_Set_Phases(pPWM, i, zero);
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Set_Duty(Motor_PWMTypeDef* pPWM, uint8_t channel, int16_t duty){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+	if(channel >= MOTOR_PWM_CHANNELS)
+		return MOTOR_PWM_RANGE_ERROR;
+#ifdef MOTOR_PWM_THREE_PHASE
+	return MOTOR_PWM_RANGE_ERROR;
+#endif
+
+	bool reverse = duty < 0;
+	if(reverse != pPWM->Reverse[channel]){
+		//bridge is switched only when 0 is already applied, first call in new direction writes 0
+		if(pPWM->Duty[channel] != 0){
+			duty = 0;
+		} else {
+			pPWM->Reverse[channel] = reverse;
+#ifndef HOST_BUILD
+			pwm_channels[channel].DirectionPort->BSRR = reverse ? (1U << pwm_channels[channel].DirectionPin)
+					: (1U << (pwm_channels[channel].DirectionPin + 16U));
+#endif
+		}
+	}
+
+	pPWM->Duty[channel] = duty;
+#ifndef HOST_BUILD
+	uint32_t magnitude = (uint32_t)(duty < 0 ? -duty : duty);
+	*pwm_channels[channel].pCompare = (magnitude * pPWM->Period) >> 15;
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Hold_Update(Motor_PWMTypeDef* pPWM){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM1->CR1 |= TIM_CR1_UDIS;
+	TIM8->CR1 |= TIM_CR1_UDIS;
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Release_Update(Motor_PWMTypeDef* pPWM){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	TIM1->CR1 &= ~TIM_CR1_UDIS;
+	TIM8->CR1 &= ~TIM_CR1_UDIS;
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Set_Phases(Motor_PWMTypeDef* pPWM, uint8_t bridge, const uint16_t* pDuty){
+	if(pPWM == NULL || pDuty == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+	if(bridge >= MOTOR_PWM_BRIDGES)
+		return MOTOR_PWM_RANGE_ERROR;
+#ifndef MOTOR_PWM_THREE_PHASE
+	//channels belong to the H-bridges of the wheels
+	return MOTOR_PWM_RANGE_ERROR;
+#endif
+
+	uint16_t* pPhases = pPWM->Phases[bridge];
+	for(uint8_t phase = 0; phase < MOTOR_PWM_PHASES; phase++)
+		pPhases[phase] = pDuty[phase] > MOTOR_Q15_ONE ? MOTOR_Q15_ONE : pDuty[phase];
+#ifndef HOST_BUILD
+	TIM_TypeDef* tim = pwm_bridges[bridge];
+	uint32_t period = pPWM->Period;
+	tim->CCR1 = (pPhases[0] * period) >> 15;
+	tim->CCR2 = (pPhases[1] * period) >> 15;
+	tim->CCR3 = (pPhases[2] * period) >> 15;
+#endif
+
+	return MOTOR_PWM_OK;
+}
+
+Motor_PWMStatusTypeDef Motor_PWM_Check_Fault(Motor_PWMTypeDef* pPWM){
+	if(pPWM == NULL)
+		return MOTOR_PWM_NULL_ERROR;
+
+#ifndef HOST_BUILD
+	if(!pPWM->Fault && ((TIM1->SR | TIM8->SR) & TIM_SR_BIF)){
+		pPWM->Fault = true;
+		pPWM->FaultCount++;
+	}
+#endif
+
+	return pPWM->Fault ? MOTOR_PWM_FAULT : MOTOR_PWM_OK;
+}
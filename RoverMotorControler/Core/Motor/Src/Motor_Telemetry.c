@@ -0,0 +1,185 @@
+/*
+ * Motor_Telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_Telemetry.h"
+#include <string.h>
+
+/*Bytes of one signal of all wheels*/
+#define MOTOR_TELEMETRY_SIGNAL_SIZE (MOTOR_TELEMETRY_WHEELS * sizeof(int16_t))
+/*Frame start, ID, length and header of the frame in the write queue when all of them are escaped*/
+#define MOTOR_TELEMETRY_FRAME_OVERHEAD (1U + 2U*(2U + MOTOR_TELEMETRY_HEADER_SIZE))
+
+/*Frame being packed, Motor_Telemetry_Update() runs only in the main loop, so it doesn't need 255 bytes of stack*/
+static uint8_t telemetry_payload[UART_PAYLOAD_LENGTH_MAX];
+
+/*
+ * @brief Bytes of one sample with the selected signals
+ * */
+static uint32_t __sample_size(uint8_t mask){
+	uint32_t signals = 0;
+	for(uint8_t i = 0; i < MOTOR_TELEMETRY_SIGNALS; i++)
+		signals += (mask >> i) & 1U;
+	return signals * MOTOR_TELEMETRY_SIGNAL_SIZE;
+}
+
+/*
+ * @brief Clears sums of the window
+ * */
+static void __window_reset(Motor_TelemetryTypeDef* pTelemetry){
+	for(uint8_t i = 0; i < MOTOR_TELEMETRY_SIGNALS; i++){
+		for(uint8_t k = 0; k < MOTOR_TELEMETRY_WHEELS; k++)
+			pTelemetry->Sum[i][k] = 0;
+	}
+	pTelemetry->Count = 0;
+}
+
+Motor_TelemetryStatusTypeDef Motor_Telemetry_Init(Motor_TelemetryTypeDef* pTelemetry, uint32_t tick_rate){
+	if(pTelemetry == NULL)
+		return MOTOR_TELEMETRY_NULL_ERROR;
+
+	if(tick_rate == 0)
+		return MOTOR_TELEMETRY_RANGE_ERROR;
+
+	pTelemetry->TickRate = tick_rate;
+	pTelemetry->Decimation = 0;
+	pTelemetry->Reciprocal = 0;
+	pTelemetry->Mode = MOTOR_TELEMETRY_DECIMATE;
+	pTelemetry->Mask = 0;
+	pTelemetry->Sequence = 0;
+	pTelemetry->Head = 0;
+	pTelemetry->Tail = 0;
+	pTelemetry->Dropped = 0;
+	pTelemetry->FramesSent = 0;
+	__window_reset(pTelemetry);
+
+	return MOTOR_TELEMETRY_OK;
+}
+
+Motor_TelemetryStatusTypeDef Motor_Telemetry_Configure(Motor_TelemetryTypeDef* pTelemetry, uint32_t rate, uint8_t mask, uint8_t mode){
+	if(pTelemetry == NULL)
+		return MOTOR_TELEMETRY_NULL_ERROR;
+
+	if(rate > MOTOR_TELEMETRY_RATE_MAX || rate > pTelemetry->TickRate || (mask & ~MOTOR_TELEMETRY_MASK_ALL) != 0
+			|| (rate != 0 && mask == 0) || mode > MOTOR_TELEMETRY_AVERAGE)
+		return MOTOR_TELEMETRY_RANGE_ERROR;
+
+	uint32_t decimation = 0;
+	uint32_t reciprocal = 0;
+	if(rate != 0){
+		decimation = (pTelemetry->TickRate + rate / 2U) / rate;
+		reciprocal = ((1U << MOTOR_TELEMETRY_RECIPROCAL_BITS) + decimation / 2U) / decimation;
+	}
+
+	//tick must not see half of the new configuration
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	pTelemetry->Decimation = decimation;
+	pTelemetry->Reciprocal = reciprocal;
+	pTelemetry->Mode = mode;
+	pTelemetry->Mask = mask;
+	__window_reset(pTelemetry);
+	//samples of the old configuration are not sent, main loop owns Tail
+	pTelemetry->Tail = pTelemetry->Head;
+	__set_PRIMASK(primask);
+
+	return MOTOR_TELEMETRY_OK;
+}
+
+void Motor_Telemetry_Write(Motor_TelemetryTypeDef* pTelemetry, const int16_t pValues[MOTOR_TELEMETRY_SIGNALS][MOTOR_TELEMETRY_WHEELS]){
+	uint32_t decimation = pTelemetry->Decimation;
+	if(decimation == 0)
+		return;
+
+	for(uint8_t i = 0; i < MOTOR_TELEMETRY_SIGNALS; i++){
+		for(uint8_t k = 0; k < MOTOR_TELEMETRY_WHEELS; k++)
+			pTelemetry->Sum[i][k] += pValues[i][k];
+	}
+	if(++pTelemetry->Count < decimation)
+		return;
+
+	uint16_t sequence = pTelemetry->Sequence++;
+	uint32_t head = pTelemetry->Head;
+	if(head - pTelemetry->Tail >= MOTOR_TELEMETRY_DEPTH){
+		pTelemetry->Dropped++;
+		__window_reset(pTelemetry);
+		return;
+	}
+
+	Motor_TelemetrySampleTypeDef* pSample = &pTelemetry->Ring[head & (MOTOR_TELEMETRY_DEPTH - 1U)];
+	pSample->Sequence = sequence;
+	bool average = pTelemetry->Mode == MOTOR_TELEMETRY_AVERAGE;
+	for(uint8_t i = 0; i < MOTOR_TELEMETRY_SIGNALS; i++){
+		for(uint8_t k = 0; k < MOTOR_TELEMETRY_WHEELS; k++){
+			//rounded reciprocal can be slightly above 1 / Decimation, full scale average is saturated
+			pSample->Values[i][k] = average
+					? (int16_t)Motor_Q15_Saturate((int32_t)(((int64_t)pTelemetry->Sum[i][k] * pTelemetry->Reciprocal) >> MOTOR_TELEMETRY_RECIPROCAL_BITS))
+					: pValues[i][k];
+		}
+	}
+	__window_reset(pTelemetry);
+
+	//sample has to be written before the reader can see it
+	__DMB();
+	pTelemetry->Head = head + 1U;
+}
+
+Motor_TelemetryStatusTypeDef Motor_Telemetry_Update(Motor_TelemetryTypeDef* pTelemetry, UART_CommunicationTypeDef* pCommunication){
+	if(pTelemetry == NULL || pCommunication == NULL)
+		return MOTOR_TELEMETRY_NULL_ERROR;
+
+	uint32_t tail = pTelemetry->Tail;
+	uint32_t available = pTelemetry->Head - tail;
+	if(available == 0)
+		return MOTOR_TELEMETRY_OK;
+
+	//frame is enqueued only when it fits as a whole, free space can only grow in the meantime,
+	//frame start, ID, length and header are counted as if all of them were escaped, samples with their escaped size
+	uint8_t mask = pTelemetry->Mask;
+	uint32_t sample_size = __sample_size(mask);
+	uint32_t space = pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE - pCommunication->WriteBytesQueue.Size;
+	if(space < MOTOR_TELEMETRY_FRAME_OVERHEAD)
+		return MOTOR_TELEMETRY_OK;
+	space -= MOTOR_TELEMETRY_FRAME_OVERHEAD;
+
+	uint8_t* payload = telemetry_payload;
+	uint16_t first = pTelemetry->Ring[tail & (MOTOR_TELEMETRY_DEPTH - 1U)].Sequence;
+	uint32_t len = MOTOR_TELEMETRY_HEADER_SIZE;
+	uint32_t packed = 0;
+	for(; packed < available && len + sample_size <= UART_PAYLOAD_LENGTH_MAX; packed++){
+		const Motor_TelemetrySampleTypeDef* pSample = &pTelemetry->Ring[(tail + packed) & (MOTOR_TELEMETRY_DEPTH - 1U)];
+		//samples of one frame are consecutive, gap after dropped samples starts a new frame
+		if(pSample->Sequence != (uint16_t)(first + packed))
+			break;
+		uint32_t start = len;
+		for(uint8_t i = 0; i < MOTOR_TELEMETRY_SIGNALS; i++){
+			if(mask & (1U << i)){
+				memcpy(&payload[len], pSample->Values[i], MOTOR_TELEMETRY_SIGNAL_SIZE);
+				len += MOTOR_TELEMETRY_SIGNAL_SIZE;
+			}
+		}
+		uint32_t escaped = UART_Communication_Escaped_Size(pCommunication, &payload[start], sample_size);
+		if(escaped > space){
+			len = start;
+			break;
+		}
+		space -= escaped;
+	}
+	if(packed == 0)
+		return MOTOR_TELEMETRY_OK;
+	memcpy(&payload[0], &first, sizeof(uint16_t));
+	payload[2] = mask;
+	payload[3] = (uint8_t)packed;
+
+	//samples stay in the ring until the frame is enqueued, failed frame is sent again by the next call
+	if(UART_Communication_Transmit_Frame(pCommunication, MOTOR_TELEMETRY_ID, (uint8_t)len, payload) != COMMUNICATION_OK)
+		return MOTOR_TELEMETRY_OK;
+	pTelemetry->FramesSent++;
+
+	//slots have to be read before the writer can reuse them
+	__DMB();
+	pTelemetry->Tail = tail + packed;
+
+	return MOTOR_TELEMETRY_OK;
+}
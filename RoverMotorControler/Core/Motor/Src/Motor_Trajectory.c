@@ -0,0 +1,197 @@
+/*
+ * Motor_Trajectory.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Motor_Trajectory.h"
+
+/*
+ * @brief Integer square root, at most 32 iterations
+ * */
+static int64_t __sqrt(uint64_t value){
+	uint64_t result = 0;
+	uint64_t bit = 1ULL << 62;
+
+	while(bit > value)
+		bit >>= 2;
+
+	while(bit != 0){
+		if(value >= result + bit){
+			value -= result + bit;
+			result = (result >> 1) + bit;
+		} else {
+			result >>= 1;
+		}
+		bit >>= 2;
+	}
+
+	return (int64_t)result;
+}
+
+/*
+ * @brief Speed which still allows to stop after given distance
+ *
+ * @retval int64_t speed (Q24 counts per tick), signed like the distance
+ * */
+static int64_t __velocity_limit(const Motor_TrajectoryTypeDef* pTrajectory, int64_t distance){
+	int64_t length = distance < 0 ? -distance : distance;
+	int64_t limit = pTrajectory->VelocityMax;
+
+	if(length < pTrajectory->CruiseDistance){
+		//n whole steps of A fit in the distance when A*n*(n+1)/2 <= d, (2n + 1)^2 <= 4*floor(2d/A) + 1
+		int64_t acceleration = pTrajectory->Acceleration;
+		int64_t steps = (__sqrt((uint64_t)(4 * (2 * length / acceleration) + 1)) - 1) / 2;
+		//rest of the distance is spread over n + 1 braking steps, so the speed is below (n + 1) * A
+		//and braking by A per tick ends exactly at the target
+		limit = steps * acceleration + (length - acceleration * steps * (steps + 1) / 2) / (steps + 1);
+		if(limit > pTrajectory->VelocityMax)
+			limit = pTrajectory->VelocityMax;
+	}
+
+	return distance < 0 ? -limit : limit;
+}
+
+Motor_TrajectoryStatusTypeDef Motor_Trajectory_Init(Motor_TrajectoryTypeDef* pTrajectory, const Motor_TrajectoryConfigTypeDef* pConfig, uint32_t rate){
+	if(pTrajectory == NULL || pConfig == NULL)
+		return MOTOR_TRAJECTORY_NULL_ERROR;
+
+	if(rate == 0)
+		return MOTOR_TRAJECTORY_RANGE_ERROR;
+
+	int64_t velocity = ((int64_t)pConfig->Velocity << MOTOR_TRAJECTORY_Q) / rate;
+	int64_t acceleration = ((int64_t)pConfig->Acceleration << MOTOR_TRAJECTORY_Q) / ((int64_t)rate * rate);
+
+	//velocity is kept in 32bit history, acceleration smaller than 1 LSB per tick would never move the wheel
+	if(velocity <= 0 || velocity > INT32_MAX || acceleration <= 0)
+		return MOTOR_TRAJECTORY_RANGE_ERROR;
+
+	pTrajectory->VelocityMax = velocity;
+	pTrajectory->Acceleration = acceleration;
+	//braking from maximum velocity takes n = ceil(V / A) ticks, V + (V - A) + ... + (V - (n - 1) * A)
+	int64_t steps = (velocity + acceleration - 1) / acceleration;
+	pTrajectory->CruiseDistance = steps * velocity - acceleration * steps * (steps - 1) / 2;
+	pTrajectory->Rate = rate;
+
+	//ramp of acceleration takes A / J seconds, window is rounded down to power of two
+	uint32_t window = 1;
+	if(pConfig->Jerk != 0){
+		uint64_t ticks = (uint64_t)pConfig->Acceleration * rate / pConfig->Jerk;
+		if(ticks > MOTOR_TRAJECTORY_SMOOTHING_MAX)
+			ticks = MOTOR_TRAJECTORY_SMOOTHING_MAX;
+		while(window * 2U <= ticks)
+			window *= 2U;
+	}
+	pTrajectory->SmoothingShift = 0;
+	while((1U << pTrajectory->SmoothingShift) < window)
+		pTrajectory->SmoothingShift++;
+
+	return Motor_Trajectory_Reset(pTrajectory, 0, 0);
+}
+
+Motor_TrajectoryStatusTypeDef Motor_Trajectory_Reset(Motor_TrajectoryTypeDef* pTrajectory, int32_t position, int32_t velocity){
+	if(pTrajectory == NULL)
+		return MOTOR_TRAJECTORY_NULL_ERROR;
+
+	int64_t tick_velocity = ((int64_t)velocity << MOTOR_TRAJECTORY_Q) / pTrajectory->Rate;
+	if(tick_velocity > pTrajectory->VelocityMax)
+		tick_velocity = pTrajectory->VelocityMax;
+	if(tick_velocity < -pTrajectory->VelocityMax)
+		tick_velocity = -pTrajectory->VelocityMax;
+
+	pTrajectory->Position = (int64_t)position << MOTOR_TRAJECTORY_Q;
+	pTrajectory->Target = pTrajectory->Position;
+	pTrajectory->Velocity = tick_velocity;
+
+	//history is filled lazily, so reset takes the same time for any window
+	pTrajectory->HistoryIndex = 0;
+	pTrajectory->HistoryCount = 0;
+	pTrajectory->HistoryFill = (int32_t)tick_velocity;
+	pTrajectory->HistorySum = tick_velocity * (1 << pTrajectory->SmoothingShift);
+	pTrajectory->Remainder = 0;
+	pTrajectory->StillTicks = 0;
+
+	pTrajectory->OutputPosition = pTrajectory->Position;
+	pTrajectory->OutputVelocity = tick_velocity;
+	pTrajectory->Moving = tick_velocity != 0;
+
+	pTrajectory->QueueHead = 0;
+	pTrajectory->QueueTail = 0;
+
+	return MOTOR_TRAJECTORY_OK;
+}
+
+Motor_TrajectoryStatusTypeDef Motor_Trajectory_Push(Motor_TrajectoryTypeDef* pTrajectory, int32_t position){
+	if(pTrajectory == NULL)
+		return MOTOR_TRAJECTORY_NULL_ERROR;
+
+	uint8_t head = pTrajectory->QueueHead;
+	uint8_t next = (head + 1U) % MOTOR_TRAJECTORY_QUEUE_SIZE;
+	if(next == pTrajectory->QueueTail)
+		return MOTOR_TRAJECTORY_FULL_ERROR;
+
+	pTrajectory->Queue[head] = position;
+	pTrajectory->QueueHead = next;
+	pTrajectory->Moving = true;
+
+	return MOTOR_TRAJECTORY_OK;
+}
+
+void Motor_Trajectory_Update(Motor_TrajectoryTypeDef* pTrajectory){
+	int64_t distance = pTrajectory->Target - pTrajectory->Position;
+	int64_t limit = __velocity_limit(pTrajectory, distance);
+	int64_t velocity = pTrajectory->Velocity;
+
+	//next waypoint when the current one is reached or the profile would start braking for it
+	uint8_t tail = pTrajectory->QueueTail;
+	if(tail != pTrajectory->QueueHead){
+		bool braking = (velocity > 0 && limit < velocity) || (velocity < 0 && limit > velocity);
+		if(distance == 0 || braking){
+			pTrajectory->Target = (int64_t)pTrajectory->Queue[tail] << MOTOR_TRAJECTORY_Q;
+			pTrajectory->QueueTail = (tail + 1U) % MOTOR_TRAJECTORY_QUEUE_SIZE;
+			distance = pTrajectory->Target - pTrajectory->Position;
+			limit = __velocity_limit(pTrajectory, distance);
+		}
+	}
+
+	//trapezoidal profile, velocity changes by at most A per tick
+	if(limit > velocity + pTrajectory->Acceleration)
+		limit = velocity + pTrajectory->Acceleration;
+	if(limit < velocity - pTrajectory->Acceleration)
+		limit = velocity - pTrajectory->Acceleration;
+	pTrajectory->Velocity = limit;
+	pTrajectory->Position += limit;
+
+	//moving average of velocity over the window
+	uint8_t shift = pTrajectory->SmoothingShift;
+	uint16_t mask = (1U << shift) - 1U;
+	uint16_t index = pTrajectory->HistoryIndex;
+	int32_t oldest = pTrajectory->HistoryFill;
+	if(pTrajectory->HistoryCount > mask)
+		oldest = pTrajectory->History[index];
+	else
+		pTrajectory->HistoryCount++;
+	pTrajectory->History[index] = (int32_t)limit;
+	pTrajectory->HistoryIndex = (index + 1U) & mask;
+	pTrajectory->HistorySum += limit - oldest;
+
+	int64_t output = pTrajectory->HistorySum >> shift;
+	pTrajectory->Remainder += pTrajectory->HistorySum & mask;
+	if(pTrajectory->Remainder > mask){
+		output++;
+		pTrajectory->Remainder -= mask + 1U;
+	}
+	pTrajectory->OutputVelocity = output;
+	pTrajectory->OutputPosition += output;
+
+	//profile stood still for the whole window, so the output did too, leftover of the remainder is below 1 LSB
+	if(limit != 0 || distance != 0)
+		pTrajectory->StillTicks = 0;
+	else if(pTrajectory->StillTicks <= mask)
+		pTrajectory->StillTicks++;
+	else if(pTrajectory->QueueTail == pTrajectory->QueueHead){
+		pTrajectory->OutputPosition = pTrajectory->Position;
+		pTrajectory->OutputVelocity = 0;
+		pTrajectory->Remainder = 0;
+		pTrajectory->Moving = false;
+	}
+}
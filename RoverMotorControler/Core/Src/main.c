@@ -22,7 +22,16 @@
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
 #include "UART_Communication.h"
+#include "Idle_Sleep.h"
+#include "Profiler.h"
+#include "Heap_Stats.h"
+#include "Stack_Monitor.h"
+#include "Motor_Control.h"
+#include "Motor_Frame.h"
 #include <stdio.h>
+#ifdef HOST_BUILD
+#include "Virtual_Rover.h"
+#endif
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -34,16 +43,34 @@ typedef enum  {
 
 	MOTOR_SET_MODE = 0x11U,
 	MOTOR_SET_SPEED = 0x12U,
-	MOTOR_SET_POS = 0x13U
+	MOTOR_SET_POS = 0x13U,
+	MOTOR_SET_FILTER = 0x14U,
+	MOTOR_SET_SPEEDS = 0x15U,
+	MOTOR_SET_TELEMETRY = MOTOR_TELEMETRY_ID,
+
+	SYSTEM_GET_PROFILE = 0x21U,
+	SYSTEM_GET_HEAP = 0x22U,
+	SYSTEM_GET_STACK = 0x23U,
+	SYSTEM_GET_IDLE = 0x24U
 } BYTE_ID;
 /* USER CODE END PTD */
 
 /* Private define ------------------------------------------------------------*/
 /* USER CODE BEGIN PD */
+/*Rate of the wheel speed loop in Hz*/
+#define MOTOR_CONTROL_RATE 10000U
+/*Encoder counts per second at full wheel speed: 2048 line encoder (8192 counts per revolution), 300 rpm*/
+#define MOTOR_MAX_SPEED 40960U
 /* USER CODE END PD */
 
 /* Private macro -------------------------------------------------------------*/
 /* USER CODE BEGIN PM */
+/*Virtual rover (Host/) logs every motor command, on the target it expands to nothing*/
+#ifdef HOST_BUILD
+#define MOTOR_LOG(name, len, payload) Virtual_Rover_Log_Callback(name, len, payload)
+#else
+#define MOTOR_LOG(name, len, payload)
+#endif
 
 /* USER CODE END PM */
 
@@ -55,6 +82,10 @@ UART_HandleTypeDef huart1;
 /* USER CODE BEGIN PV */
 /*handle for uart communication*/
 UART_CommunicationTypeDef uart_communication;
+/*idle statistics, core sleeps when there is nothing to process*/
+Idle_SleepTypeDef idle_sleep;
+/*wheel speed control, ticks in TIM6 interrupt*/
+Motor_ControlTypeDef motor_control;
 /* USER CODE END PV */
 
 /* Private function prototypes -----------------------------------------------*/
@@ -75,7 +106,18 @@ static void MX_IWDG_Init(void);
 
 /******************************************************/
 // MOTOR CALLBACKS
+/*
+ * Payload layouts are in Motor_Frame.h, library calls the callbacks only with their exact length
+ * (MOTOR_SET_FILTER: header and at most all coefficients)
+ * */
 void motor_set_mode(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_mode", len, payload);
+	const Motor_SetModePayloadTypeDef* pFrame = (const Motor_SetModePayloadTypeDef*)payload;
+	if(pFrame->Mode != 0)
+		Motor_Control_Start(&motor_control);
+	else
+		Motor_Control_Stop(&motor_control);
 	//while testing it was causing issues like-hard stucking while sending multiple data
 		//at once - most likely the issue is caused because of serial port converter -
 		//some data is still being transfer to STM and STM tries to write data to ST-Link
@@ -86,6 +128,10 @@ void motor_set_mode(uint8_t len, uint8_t* payload){
 }
 
 void motor_set_speed(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_speed", len, payload);
+	const Motor_SetSpeedPayloadTypeDef* pFrame = (const Motor_SetSpeedPayloadTypeDef*)payload;
+	Motor_Control_Set_Speed(&motor_control, pFrame->Wheel, pFrame->Speed);
 	//while testing it was causing issues like-hard stucking while sending multiple data
 		//at once - most likely the issue is caused because of serial port converter -
 		//some data is still being transfer to STM and STM tries to write data to ST-Link
@@ -95,7 +141,30 @@ void motor_set_speed(uint8_t len, uint8_t* payload){
 	//printf("set_speed %i payload: %i, %i, %i\n", len, payload[0], payload[1], payload[2]);
 }
 
+/*All wheels change speed in the same control tick*/
+void motor_set_speeds(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_speeds", len, payload);
+	const Motor_SetSpeedsPayloadTypeDef* pFrame = (const Motor_SetSpeedsPayloadTypeDef*)payload;
+	int16_t speed[MOTOR_WHEEL_COUNT];
+	for(uint8_t i = 0; i < MOTOR_WHEEL_COUNT; i++)
+		speed[i] = pFrame->Speed[i];
+	Motor_Control_Set_Speeds(&motor_control, speed);
+}
+
+/*Stream is sent by Motor_Telemetry_Update() in the main loop*/
+void motor_set_telemetry(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_telemetry", len, payload);
+	const Motor_SetTelemetryPayloadTypeDef* pFrame = (const Motor_SetTelemetryPayloadTypeDef*)payload;
+	Motor_Telemetry_Configure(&motor_control.Telemetry, pFrame->Rate, pFrame->Mask, pFrame->Mode);
+}
+
 void motor_set_pos(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_pos", len, payload);
+	const Motor_SetPosPayloadTypeDef* pFrame = (const Motor_SetPosPayloadTypeDef*)payload;
+	Motor_Control_Set_Position(&motor_control, pFrame->Wheel, pFrame->Position);
 	//while testing it was causing issues like-hard stucking while sending multiple data
 		//at once - most likely the issue is caused because of serial port converter -
 		//some data is still being transfer to STM and STM tries to write data to ST-Link
@@ -104,6 +173,49 @@ void motor_set_pos(uint8_t len, uint8_t* payload){
 	//160Mhz seems to help the issue
 	//printf("set_pos %i payload: %i, %i, %i, %i, %i\n", len, payload[0], payload[1], payload[2], payload[3], payload[4]);
 }
+void motor_set_filter(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Sample();
+	MOTOR_LOG("set_filter", len, payload);
+	const Motor_SetFilterPayloadTypeDef* pFrame = (const Motor_SetFilterPayloadTypeDef*)payload;
+	//number of coefficients has to match the length
+	if(pFrame->FeedForward > MOTOR_FILTER_TAPS_MAX || pFrame->Feedback > MOTOR_FILTER_FEEDBACK_MAX
+			|| len != offsetof(Motor_SetFilterPayloadTypeDef, Coefficients) + 2U * (pFrame->FeedForward + pFrame->Feedback)){
+		UART_Communication_Reject_Length(&uart_communication);
+		return;
+	}
+
+	Motor_FilterConfigTypeDef config = {
+		.Type = pFrame->Type,
+		.Gain = pFrame->Gain,
+		.FeedForward = pFrame->FeedForward,
+		.Feedback = pFrame->Feedback
+	};
+	for(uint8_t i = 0; i < config.FeedForward; i++)
+		config.B[i] = pFrame->Coefficients[i];
+	for(uint8_t i = 0; i < config.Feedback; i++)
+		config.A[i] = pFrame->Coefficients[config.FeedForward + i];
+	Motor_Control_Set_Filter(&motor_control, &config);
+}
+/******************************************************/
+// DIAGNOSTIC CALLBACKS
+void system_get_profile(uint8_t len, uint8_t* payload){
+	//payload: site (u8, default 0) and optional flag requesting clearing statistics of the site after they are sent
+	uint8_t site = len > 0 ? payload[0] : 0;
+	Profiler_Transmit(&uart_communication, SYSTEM_GET_PROFILE, site, len > 1 && payload[1] != 0);
+}
+
+void system_get_heap(uint8_t len, uint8_t* payload){
+	Heap_Stats_Transmit(&uart_communication, SYSTEM_GET_HEAP);
+}
+
+void system_get_stack(uint8_t len, uint8_t* payload){
+	Stack_Monitor_Transmit(&uart_communication, SYSTEM_GET_STACK);
+}
+
+void system_get_idle(uint8_t len, uint8_t* payload){
+	//payload: optional flag requesting clearing statistics after they are sent
+	Idle_Sleep_Transmit(&idle_sleep, &uart_communication, SYSTEM_GET_IDLE, len > 0 && payload[0] != 0);
+}
 /******************************************************/
 /*
  * Callbacks for UART read and write
@@ -117,16 +229,24 @@ void motor_set_pos(uint8_t len, uint8_t* payload){
 
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart){
 	if(huart == &huart1){
+		Stack_Monitor_Sample();
 		UART_Communication_Receive_Interrupt_Callback(&uart_communication);
 	}
 }
 
 void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart){
 	if(huart == &huart1){
+		Stack_Monitor_Sample();
 		UART_Communication_Transmit_Interrupt_Callback(&uart_communication);
 	}
 }
 
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart){
+	if(huart == &huart1){
+		UART_Communication_Error_Interrupt_Callback(&uart_communication);
+	}
+}
+
 /* Same as with events, defining __io_put_char in library,
  * which defines how global printf() function works is not a good
  * idea, i have just created function that enables printf in my library */
@@ -144,7 +264,7 @@ int __io_putchar(int ch){
 int main(void)
 {
   /* USER CODE BEGIN 1 */
-
+  Stack_Monitor_Init();
   /* USER CODE END 1 */
 
   /* MCU Configuration--------------------------------------------------------*/
@@ -168,16 +288,46 @@ int main(void)
   MX_USART1_UART_Init();
   MX_IWDG_Init();
   /* USER CODE BEGIN 2 */
-  //Initialize my library
-  if(UART_Communication_Init(&uart_communication, &huart1, FRAME_START, 80) != COMMUNICATION_OK)
+  Profiler_Init();
+
+  //Initialize my library, queue has to fit the biggest frame we send (profiler statistics)
+  if(UART_Communication_Init(&uart_communication, &huart1, FRAME_START, 256) != COMMUNICATION_OK)
   	  Error_Handler();
 
-  //register all callbacks
-  if(UART_Communication_Register_Callback(&uart_communication, MOTOR_SET_MODE, &motor_set_mode) != COMMUNICATION_OK)
+  //register all callbacks, motor frames with the payload length of their layout
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_MODE, &motor_set_mode,
+		  MOTOR_FRAME_LENGTH(Motor_SetModePayloadTypeDef)) != COMMUNICATION_OK)
   	  Error_Handler();
-  if(UART_Communication_Register_Callback(&uart_communication, MOTOR_SET_SPEED, &motor_set_speed) != COMMUNICATION_OK)
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_SPEED, &motor_set_speed,
+		  MOTOR_FRAME_LENGTH(Motor_SetSpeedPayloadTypeDef)) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_SPEEDS, &motor_set_speeds,
+		  MOTOR_FRAME_LENGTH(Motor_SetSpeedsPayloadTypeDef)) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_TELEMETRY, &motor_set_telemetry,
+		  MOTOR_FRAME_LENGTH(Motor_SetTelemetryPayloadTypeDef)) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_POS, &motor_set_pos,
+		  MOTOR_FRAME_LENGTH(Motor_SetPosPayloadTypeDef)) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback_Length(&uart_communication, MOTOR_SET_FILTER, &motor_set_filter,
+		  MOTOR_FRAME_LENGTH_VARIABLE(Motor_SetFilterPayloadTypeDef, Coefficients)) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback(&uart_communication, SYSTEM_GET_PROFILE, &system_get_profile) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback(&uart_communication, SYSTEM_GET_HEAP, &system_get_heap) != COMMUNICATION_OK)
 	  Error_Handler();
-  if(UART_Communication_Register_Callback(&uart_communication, MOTOR_SET_POS, &motor_set_pos) != COMMUNICATION_OK)
+  if(UART_Communication_Register_Callback(&uart_communication, SYSTEM_GET_STACK, &system_get_stack) != COMMUNICATION_OK)
+	  Error_Handler();
+  if(UART_Communication_Register_Callback(&uart_communication, SYSTEM_GET_IDLE, &system_get_idle) != COMMUNICATION_OK)
+	  Error_Handler();
+
+  if(Idle_Sleep_Init(&idle_sleep) != IDLE_SLEEP_OK)
+	  Error_Handler();
+
+  //speed loop runs in timer interrupt, independently of the main loop,
+  //bridges stay off until MOTOR_SET_MODE starts the control
+  if(Motor_Control_Init(&motor_control, MOTOR_CONTROL_RATE, MOTOR_MAX_SPEED) != MOTOR_CONTROL_OK)
 	  Error_Handler();
 
   /* USER CODE END 2 */
@@ -186,8 +336,22 @@ int main(void)
   /* USER CODE BEGIN WHILE */
   while (1)
   {
+	PROFILER_BEGIN(UPDATE);
 	if(UART_Communication_Update(&uart_communication) == COMMUNICATION_HAL_ERROR)
 		Error_Handler();
+	PROFILER_END(UPDATE);
+
+	//samples of the control tick are packed here, the tick never waits for UART
+	Motor_Telemetry_Update(&motor_control.Telemetry, &uart_communication);
+
+	HAL_IWDG_Refresh(&hiwdg);
+
+	//counts every time stack grew past the threshold
+	Stack_Monitor_Check();
+
+	//sleep until next interrupt (USART, SysTick) if there is nothing left to process,
+	//SysTick wakes core every 1ms so watchdog is still refreshed while idle
+	Idle_Sleep_Update(&idle_sleep, &uart_communication);
     /* USER CODE END WHILE */
 
     /* USER CODE BEGIN 3 */
@@ -352,6 +516,9 @@ void Error_Handler(void)
 {
   /* USER CODE BEGIN Error_Handler_Debug */
   /* User can add his own implementation to report the HAL error return state */
+#ifdef HOST_BUILD
+  Virtual_Rover_Error_Handler();
+#endif
   __disable_irq();
   while (1)
   {
@@ -22,6 +22,8 @@
 #include "stm32g4xx_it.h"
 /* Private includes ----------------------------------------------------------*/
 /* USER CODE BEGIN Includes */
+#include "Profiler.h"
+#include "Motor_Control.h"
 /* USER CODE END Includes */
 
 /* Private typedef -----------------------------------------------------------*/
@@ -57,7 +59,7 @@
 /* External variables --------------------------------------------------------*/
 extern UART_HandleTypeDef huart1;
 /* USER CODE BEGIN EV */
-
+extern Motor_ControlTypeDef motor_control;
 /* USER CODE END EV */
 
 /******************************************************************************/
@@ -204,14 +206,32 @@ void SysTick_Handler(void)
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
+  PROFILER_BEGIN(USART1_IRQ);
 
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
+  PROFILER_END(USART1_IRQ);
 
   /* USER CODE END USART1_IRQn 1 */
 }
 
 /* USER CODE BEGIN 1 */
+/**
+  * @brief This function handles TIM6 global interrupt, DAC1 and DAC3 channel underrun error interrupts.
+  */
+void TIM6_DAC_IRQHandler(void)
+{
+  PROFILER_BEGIN(CONTROL_TICK);
+  Motor_Control_Timer_Interrupt_Callback(&motor_control);
+  PROFILER_END(CONTROL_TICK);
+}
 
+/**
+  * @brief This function handles ADC1 and ADC2 global interrupt.
+  */
+void ADC1_2_IRQHandler(void)
+{
+  Motor_ADC_Interrupt_Callback(&motor_control.ADC);
+}
 /* USER CODE END 1 */
@@ -23,6 +23,7 @@
 /* Includes */
 #include <errno.h>
 #include <stdint.h>
+#include "Heap_Stats.h"
 
 /**
  * Pointer to the current high watermark of the heap usage
@@ -68,6 +69,7 @@ void *_sbrk(ptrdiff_t incr)
   /* Protect heap from growing into the reserved MSP stack */
   if (__sbrk_heap_end + incr > max_heap)
   {
+    Heap_Stats_Sbrk(__sbrk_heap_end - &_end, max_heap - &_end, true);
     errno = ENOMEM;
     return (void *)-1;
   }
@@ -75,5 +77,8 @@ void *_sbrk(ptrdiff_t incr)
   prev_heap_end = __sbrk_heap_end;
   __sbrk_heap_end += incr;
 
+  /* Report heap growth for heap usage statistics */
+  Heap_Stats_Sbrk(__sbrk_heap_end - &_end, max_heap - &_end, false);
+
   return (void *)prev_heap_end;
 }
@@ -93,6 +93,24 @@ LoopFillZerobss:
   cmp r2, r4
   bcc FillZerobss
 
+/* Paint the stack reserved by _Min_Stack_Size with a pattern,
+   Stack_Monitor.c finds how deep the stack was used by looking for it.
+   Pattern has to match STACK_MONITOR_PATTERN in Stack_Monitor.h */
+  ldr r2, =_estack
+  ldr r3, =_Min_Stack_Size
+  subs r2, r2, r3
+  ldr r3, =0xA5A5A5A5
+  mov r4, sp
+  b LoopPaintStack
+
+PaintStack:
+  str  r3, [r2]
+  adds r2, r2, #4
+
+LoopPaintStack:
+  cmp r2, r4
+  bcc PaintStack
+
 /* Call the clock system intitialization function.*/
     bl  SystemInit
 /* Call static constructors */
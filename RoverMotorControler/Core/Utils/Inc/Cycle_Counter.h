@@ -0,0 +1,37 @@
+/*Cycle_Counter.h*/
+#include "stm32g4xx_hal.h"
+
+/*
+ * Thin wrapper around Cortex-M4 DWT cycle counter (CYCCNT).
+ * Counter is incremented with every core clock cycle (160Mhz) and wraps
+ * around after ~26s, so only difference between two readings is meaningful.
+ * Unsigned subtraction (end - start) handles single wrap correctly.
+ *
+ * NOTE: core clock is stopped while core sleeps in WFI, so counter does not
+ * count time spent in sleep mode
+ * */
+#ifndef CYCLE_COUNTER_H_
+#define CYCLE_COUNTER_H_
+
+/*
+ * @brief Enables DWT cycle counter, calling it more than once is harmless
+ * (counter is not reset when it is already running)
+ * */
+static inline void Cycle_Counter_Init(void){
+	if(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk)
+		return;
+
+	//trace must be enabled before any DWT register can be written
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/*
+ * @brief Returns current value of the cycle counter
+ * */
+static inline uint32_t Cycle_Counter_Get(void){
+	return DWT->CYCCNT;
+}
+
+#endif
@@ -0,0 +1,78 @@
+/*Heap_Stats.h*/
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+
+/*
+ * Heap instrumentation
+ * 1. Project is linked with -Wl,--wrap=malloc,--wrap=free,--wrap=realloc, so every call
+ *    to those functions lands in __wrap_malloc() etc. defined in Heap_Stats.c
+ * 2. Wrappers call original newlib functions (__real_malloc()...) with interrupts disabled
+ *    (malloc is also used in UART receive interrupt and newlib heap is not reentrant)
+ *    and measure how many cycles the call took
+ * 3. _sbrk() in sysmem.c reports how far the heap has grown by Heap_Stats_Sbrk()
+ *
+ * NOTE: allocations made inside newlib itself (e.g. printf buffers) go through _malloc_r()
+ * and are not counted, they are only visible in heap size reported by _sbrk()
+ * */
+#ifndef HEAP_STATS_H_
+#define HEAP_STATS_H_
+
+/*
+ * Heap statistics, all fields are 32bit so structure is sent over UART as it is (little endian)
+ * */
+typedef struct {
+	//bytes taken from RAM by _sbrk() so far (heap never shrinks)
+	uint32_t HeapSize;
+	//bytes _sbrk() can hand out at most, before reaching reserved stack
+	uint32_t HeapLimit;
+	//_sbrk() calls refused because heap would grow into the stack
+	uint32_t SbrkFailures;
+
+	//allocations which were not freed yet
+	uint32_t LiveAllocations;
+	//usable bytes of allocations which were not freed yet
+	uint32_t LiveBytes;
+	//highest value of LiveBytes
+	uint32_t PeakLiveBytes;
+
+	//number of successful malloc/realloc and free calls
+	uint32_t MallocCount;
+	uint32_t FreeCount;
+	//malloc/realloc calls which returned NULL
+	uint32_t FailedAllocations;
+
+	//cost of malloc/realloc and free in CPU cycles
+	uint32_t MallocCyclesMax;
+	uint32_t MallocCyclesMean;
+	uint32_t FreeCyclesMax;
+	uint32_t FreeCyclesMean;
+} Heap_StatsTypeDef;
+
+/*
+ * @brief Copies current heap statistics
+ *
+ * @param pStats pointer to memory where statistics will be copied
+ * */
+extern void Heap_Stats_Get(Heap_StatsTypeDef* pStats);
+
+/*
+ * @brief Sends heap statistics as one frame with Heap_StatsTypeDef payload
+ *
+ * @param pCommunication pointer to UART_Communication handle used for transmission
+ * @param ID ID of the response frame
+ *
+ * @retval UART_CommunicationStatusTypeDef status of the transmission
+ * */
+extern UART_CommunicationStatusTypeDef Heap_Stats_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID);
+
+/*
+ * @brief Called by _sbrk() every time it is asked for memory
+ *
+ * @param heap_size bytes taken by heap after the call
+ * @param heap_limit bytes heap can take at most
+ * @param failed true if request was refused
+ * */
+extern void Heap_Stats_Sbrk(uint32_t heap_size, uint32_t heap_limit, bool failed);
+
+#endif
@@ -0,0 +1,103 @@
+/*Idle_Sleep.h*/
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+#include "Cycle_Counter.h"
+
+/*
+ * ALGORITHM
+ * 1. Idle_Sleep_Update() is called in main loop right after UART_Communication_Update()
+ * 2. With interrupts disabled it checks if communication has anything left to do
+ * 		- if it has, function returns immediately and main loop spins again
+ * 		- if it has not, core enters sleep mode through __WFI()
+ * 3. Any interrupt (USART, DMA, SysTick...) wakes the core, because interrupts are masked
+ *    with PRIMASK handler runs only after __enable_irq(), so there is no window in which
+ *    interrupt could be lost between the check and __WFI()
+ * 4. If woken up core has data waiting, wake cycle is stored and on the next call
+ *    time from wake up to the moment UART_Communication_Update() processed the data is measured
+ * 5. Idle_Sleep_Transmit() sends the statistics as one frame (Idle_SleepStatsTypeDef),
+ *    it is called from a callback, so it runs in main loop just like Idle_Sleep_Update()
+ * */
+#ifndef IDLE_SLEEP_H_
+#define IDLE_SLEEP_H_
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	IDLE_SLEEP_OK, //core has slept and it has been woken up
+	IDLE_SLEEP_BUSY, //there was work to do, core has not been put to sleep
+	IDLE_SLEEP_NULL_ERROR //pointer passed as an argument was null
+} Idle_SleepStatusTypeDef;
+
+/*
+ * Structure holding idle statistics,
+ * all times are measured in CPU cycles (DWT CYCCNT)
+ * */
+typedef struct {
+	//How many times core entered sleep mode
+	uint32_t SleepCount;
+	//How many of wake ups had data waiting (rest of them are timer wake ups)
+	uint32_t DataWakeCount;
+
+	//Flag set when core has been woken up with data to process
+	bool WakePending;
+	//Cycle counter value captured right after leaving __WFI()
+	uint32_t WakeCycle;
+
+	//Wake to dispatch latency of the last data wake up
+	uint32_t LastWakeLatency;
+	//Worst wake to dispatch latency seen so far
+	uint32_t MaxWakeLatency;
+	//Sum of all latencies, divided by DataWakeCount gives mean latency
+	uint64_t TotalWakeLatency;
+} Idle_SleepTypeDef;
+
+/*
+ * Statistics sent by Idle_Sleep_Transmit(), latencies are in CPU cycles,
+ * all fields are 32bit so structure is sent over UART as it is (little endian)
+ * */
+typedef struct {
+	uint32_t SleepCount;
+	uint32_t DataWakeCount;
+	uint32_t LastWakeLatency;
+	uint32_t MaxWakeLatency;
+	//TotalWakeLatency / DataWakeCount
+	uint32_t MeanWakeLatency;
+	//SystemCoreClock, needed to convert cycles to time
+	uint32_t CoreClock;
+} Idle_SleepStatsTypeDef;
+
+/*
+ * @brief Resets statistics and enables cycle counter used for latency measurement
+ *
+ * @param pIdle pointer to Idle_Sleep handle
+ *
+ * @retval Idle_SleepStatusTypeDef status if function was executed successfully
+ * */
+extern Idle_SleepStatusTypeDef Idle_Sleep_Init(Idle_SleepTypeDef* pIdle);
+
+/*
+ * @brief Puts core to sleep if communication is idle, should be called in main loop
+ * after UART_Communication_Update()
+ *
+ * @param pIdle pointer to Idle_Sleep handle
+ * @param pCommunication pointer to UART_Communication handle which is checked for pending work
+ *
+ * @retval Idle_SleepStatusTypeDef IDLE_SLEEP_OK if core has slept, IDLE_SLEEP_BUSY if there was work to do
+ * */
+extern Idle_SleepStatusTypeDef Idle_Sleep_Update(Idle_SleepTypeDef* pIdle, UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Sends idle statistics as one frame with Idle_SleepStatsTypeDef payload
+ *
+ * @param pIdle pointer to Idle_Sleep handle
+ * @param pCommunication pointer to UART_Communication handle used for transmission
+ * @param ID ID of the response frame
+ * @param clear if true, statistics are reset after they have been sent
+ *
+ * @retval UART_CommunicationStatusTypeDef status of the transmission
+ * */
+extern UART_CommunicationStatusTypeDef Idle_Sleep_Transmit(Idle_SleepTypeDef* pIdle, UART_CommunicationTypeDef* pCommunication, uint8_t ID, bool clear);
+
+#endif
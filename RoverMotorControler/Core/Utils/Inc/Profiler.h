@@ -0,0 +1,124 @@
+/*Profiler.h*/
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+#include "Cycle_Counter.h"
+
+/*
+ * ALGORITHM
+ * 1. Code we want to measure is surrounded with PROFILER_BEGIN(SITE) and PROFILER_END(SITE)
+ * 		- PROFILER_BEGIN() reads DWT cycle counter into local variable
+ * 		- PROFILER_END() calculates how many cycles have passed and calls Profiler_Record()
+ * 2. Profiler_Record() updates min/max/sum and log2 histogram of the site
+ * 		- bucket N of the histogram counts measurements in range [2^N, 2^(N+1)) cycles
+ * 3. Profiler_Transmit() sends statistics of one site as a binary frame, host asks for sites 0 - site count - 1 one by one,
+ *    so the response of every request fits in the write queue next to other frames
+ *
+ * When PROFILER_ENABLED is 0 macros expand to nothing, so probes can stay in the code
+ * */
+#ifndef PROFILER_H_
+#define PROFILER_H_
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1
+#endif
+
+/*Number of histogram buckets, one for every bit of 32bit cycle count*/
+#define PROFILER_HISTOGRAM_BUCKETS 32U
+
+/*Size (in bytes) of single site statistics frame payload*/
+#define PROFILER_FRAME_PAYLOAD_SIZE (2U + 4U*4U + 4U*PROFILER_HISTOGRAM_BUCKETS)
+
+/*
+ * Measured places in code, name used in PROFILER_BEGIN()/PROFILER_END()
+ * is the part after PROFILER_SITE_ prefix
+ * */
+typedef enum {
+	//single UART_Communication_Update() call in main loop
+	PROFILER_SITE_UPDATE,
+	//whole USART1 interrupt (HAL handler + receive/transmit callbacks)
+	PROFILER_SITE_USART1_IRQ,
+	//registered frame callback called by UART_Communication_Update()
+	PROFILER_SITE_FRAME_CALLBACK,
+	//malloc()/realloc() and free() calls (recorded by Heap_Stats.c wrappers)
+	PROFILER_SITE_MALLOC,
+	PROFILER_SITE_FREE,
+	//motor control tick (TIM6 interrupt)
+	PROFILER_SITE_CONTROL_TICK,
+
+	PROFILER_SITE_COUNT
+} Profiler_SiteTypeDef;
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	PROFILER_OK, //Everything fine
+	PROFILER_NULL_ERROR, //pointer passed as an argument was null
+	PROFILER_TRANSMIT_ERROR, //frame couldn't be enqueued for transmission
+	PROFILER_RANGE_ERROR //site out of range (frame with site count only was sent)
+} Profiler_StatusTypeDef;
+
+/*
+ * Statistics of a single measured site
+ * */
+typedef struct {
+	//number of measurements
+	uint32_t Count;
+	//shortest and longest measurement in cycles
+	uint32_t Min;
+	uint32_t Max;
+	//sum of all measurements, divided by Count gives mean
+	uint64_t Total;
+	//log2 histogram, Histogram[N] counts measurements in range [2^N, 2^(N+1))
+	uint32_t Histogram[PROFILER_HISTOGRAM_BUCKETS];
+} Profiler_SiteStatsTypeDef;
+
+#if PROFILER_ENABLED
+#define PROFILER_BEGIN(site) uint32_t __profiler_start_##site = Cycle_Counter_Get()
+#define PROFILER_END(site) Profiler_Record(PROFILER_SITE_##site, Cycle_Counter_Get() - __profiler_start_##site)
+#else
+#define PROFILER_BEGIN(site) do {} while(0)
+#define PROFILER_END(site) do {} while(0)
+#endif
+
+/*
+ * @brief Resets statistics of all sites and enables cycle counter
+ *
+ * @retval Profiler_StatusTypeDef status if function was executed successfully
+ * */
+extern Profiler_StatusTypeDef Profiler_Init(void);
+
+/*
+ * @brief Adds one measurement to site statistics, safe to call from interrupts
+ *
+ * @param site measured site
+ * @param cycles measured time in CPU cycles
+ * */
+extern void Profiler_Record(Profiler_SiteTypeDef site, uint32_t cycles);
+
+/*
+ * @brief Copies statistics of the site, copy is consistent even if site is being measured in interrupt
+ *
+ * @param site site to copy
+ * @param pStats pointer to memory where statistics will be copied
+ *
+ * @retval Profiler_StatusTypeDef status if function was executed successfully
+ * */
+extern Profiler_StatusTypeDef Profiler_Get(Profiler_SiteTypeDef site, Profiler_SiteStatsTypeDef* pStats);
+
+/*
+ * @brief Sends statistics of one site
+ * payload (little endian): site(u8), site count(u8), count(u32), min(u32), max(u32), mean(u32), histogram(32 x u32),
+ * site out of range gets only site and site count
+ *
+ * @param pCommunication pointer to UART_Communication handle used for transmission
+ * @param ID ID of the response frame
+ * @param site site to send
+ * @param reset if true statistics of the site are cleared once its frame was enqueued
+ *
+ * @retval Profiler_StatusTypeDef status if function was executed successfully
+ * */
+extern Profiler_StatusTypeDef Profiler_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID, uint8_t site, bool reset);
+
+#endif
@@ -0,0 +1,86 @@
+/*Stack_Monitor.h*/
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+
+/*
+ * ALGORITHM
+ * 1. Reset_Handler (startup_stm32g474retx.s) paints whole stack reserved by _Min_Stack_Size
+ *    with STACK_MONITOR_PATTERN before main() is called
+ * 2. Stack_Monitor_Get() scans painted area from the bottom, first word which is not
+ *    the pattern marks the deepest point stack has ever reached (slow, up to _Min_Stack_Size/4 reads)
+ * 3. Stack_Monitor_Check() is fast periodic check called in main loop, it reads only one guard word
+ *    placed STACK_MONITOR_THRESHOLD_PERCENT deep in the stack
+ * 		- if the word has been overwritten, threshold fault is counted and word is painted again,
+ * 		  so next crossing is counted as well
+ * 		- in main loop no interrupt is active, so everything below current stack pointer is unused
+ * 		  and guard can be safely painted again
+ * 4. Stack_Monitor_Sample() records current stack depth separately for thread mode and handler mode
+ *    (interrupts), it can be placed in the deepest known points of the code
+ *
+ * Both main loop and interrupts use MSP, so painted high water is the worst case of both contexts together
+ * */
+#ifndef STACK_MONITOR_H_
+#define STACK_MONITOR_H_
+
+/*Value stack is painted with, has to match value used in startup_stm32g474retx.s*/
+#define STACK_MONITOR_PATTERN 0xA5A5A5A5U
+
+/*How deep (in percent of _Min_Stack_Size) stack can grow before threshold fault is counted*/
+#ifndef STACK_MONITOR_THRESHOLD_PERCENT
+#define STACK_MONITOR_THRESHOLD_PERCENT 75U
+#endif
+
+/*
+ * Stack statistics, all sizes are in bytes measured from _estack,
+ * all fields are 32bit so structure is sent over UART as it is (little endian)
+ * */
+typedef struct {
+	//size of the stack reserved by _Min_Stack_Size
+	uint32_t StackSize;
+	//deepest use found in painted area, equal to StackSize if bottom of the stack was overwritten
+	uint32_t HighWater;
+	//depth of the guard word checked by Stack_Monitor_Check()
+	uint32_t Threshold;
+	//how many times guard word has been found overwritten
+	uint32_t ThresholdFaults;
+	//deepest stack pointer sampled in thread mode (main loop) and in handler mode (interrupts)
+	uint32_t ThreadDepthMax;
+	uint32_t HandlerDepthMax;
+} Stack_MonitorTypeDef;
+
+/*
+ * @brief Places guard word and resets statistics, should be called early in main()
+ * */
+extern void Stack_Monitor_Init(void);
+
+/*
+ * @brief Fast check of the guard word, has to be called from main loop (thread mode)
+ *
+ * @retval true if stack crossed the threshold since previous check
+ * */
+extern bool Stack_Monitor_Check(void);
+
+/*
+ * @brief Records current stack depth for the context (thread/handler) it was called from
+ * */
+extern void Stack_Monitor_Sample(void);
+
+/*
+ * @brief Scans painted stack and copies statistics
+ *
+ * @param pStats pointer to memory where statistics will be copied
+ * */
+extern void Stack_Monitor_Get(Stack_MonitorTypeDef* pStats);
+
+/*
+ * @brief Sends stack statistics as one frame with Stack_MonitorTypeDef payload
+ *
+ * @param pCommunication pointer to UART_Communication handle used for transmission
+ * @param ID ID of the response frame
+ *
+ * @retval UART_CommunicationStatusTypeDef status of the transmission
+ * */
+extern UART_CommunicationStatusTypeDef Stack_Monitor_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID);
+
+#endif
@@ -2,8 +2,10 @@
 #include "stm32g4xx_hal.h"
 #include <stdlib.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 #include "UART_Queue.h"
+#include "Cycle_Counter.h"
 
 /*
  * ALGORITHM
@@ -15,16 +17,50 @@
  * 		- it will create UART_FrameTypeDef object based on ID
  * 		- with each byte UART_RequestStateTypeDef is updated,
  * 		- when UART_FrameTypeDef is complete (UART_FrameTypeDef.State = REQUEST_COMPLETE) its callback will be called with required parameters
+ * 		- payload length outside of the range registered with UART_Communication_Register_Callback_Length() is skipped like
+ * 		  payload of an unknown ID (no allocation) and the callback is not called, so it can read fixed layout without checks
+ * 		- callback whose valid length depends on the payload calls UART_Communication_Reject_Length(), the frame is then
+ * 		  counted in FramesBadLength as well
+ * 4. Frame start byte is never sent inside of the frame, so receiver always finds the next frame:
+ * 		- ID, length and payload bytes equal to frame start or UART_COMMUNICATION_ESCAPE_BYTE are sent as
+ * 		  UART_COMMUNICATION_ESCAPE_BYTE followed by the byte XORed with UART_COMMUNICATION_ESCAPE_XOR
+ * 		- length counts payload bytes before escaping
  *
  *
  * */
 #ifndef UART_COMMUNICATION_H_
 #define UART_COMMUNICATION_H_
 
-/*define simple bool type (just for better code readability)*/
-#define true 1
-#define false 0
-typedef uint8_t bool;
+/*
+ * Frame IDs handled by the library itself,
+ * callbacks can't be registered for them
+ * */
+#define UART_COMMUNICATION_RESERVED_ID_FIRST 0xF0U
+//responds with UART_StatisticsTypeDef followed by (ID, dispatch count) pair of every registered callback
+#define UART_COMMUNICATION_STATISTICS_ID 0xF0U
+//responds with one page of latency trace, payload of the request is page number
+#define UART_COMMUNICATION_TRACE_ID 0xF1U
+//responds with the same payload (round trip time measurement)
+#define UART_COMMUNICATION_ECHO_ID 0xF2U
+//payload is discarded, frames and bytes are only counted in UART_StatisticsTypeDef (no response)
+#define UART_COMMUNICATION_SINK_ID 0xF3U
+//responds with stream of generated bytes, payload of the request: total bytes (u32), payload size of frames (u8, optional)
+#define UART_COMMUNICATION_SOURCE_ID 0xF4U
+/*Escapes frame start and itself inside of the frame, escaped byte follows XORed with UART_COMMUNICATION_ESCAPE_XOR*/
+#define UART_COMMUNICATION_ESCAPE_BYTE 0x7DU
+#define UART_COMMUNICATION_ESCAPE_XOR 0x20U
+/*Largest payload length of a frame*/
+#define UART_PAYLOAD_LENGTH_MAX 255U
+
+/*Payload size of generated frames when request doesn't give it*/
+#define UART_SOURCE_DEFAULT_LENGTH 255U
+
+/*Number of latency trace records kept (last frames processed)*/
+#ifndef UART_TRACE_DEPTH
+#define UART_TRACE_DEPTH 32U
+#endif
+/*Number of trace records sent in one response frame*/
+#define UART_TRACE_RECORDS_PER_PAGE 8U
 
 /*
  * Return type of all functions
@@ -37,7 +73,9 @@ typedef enum {
 	COMMUNICATION_CALLBACK_NOT_FOUND, //callback was not found
 	COMMUNICATION_NULL_ERROR, //pointer passed as an argument was null
 	COMMUNICATION_QUEUE_FAILED, // something went wrong with enqueue() dequeue()
-	COMMUNICATION_UNKNOWN_DATA //unknown data processed in Upddate()
+	COMMUNICATION_UNKNOWN_DATA, //unknown data processed in Upddate()
+	COMMUNICATION_RESERVED_ID, //tried to register callback for ID reserved by the library
+	COMMUNICATION_RANGE_ERROR //argument out of range
 } UART_CommunicationStatusTypeDef;
 
 /*
@@ -50,6 +88,11 @@ typedef struct {
 	uint8_t ID;
 	/*Pointer to callback function*/
 	void (*pCallback)(uint8_t len, uint8_t* payload);
+	/*Range of accepted payload length*/
+	uint8_t MinLength;
+	uint8_t MaxLength;
+	/*How many times callback has been called*/
+	uint32_t DispatchCount;
 } UART_CallbackTypeDef;
 
 /*
@@ -88,9 +131,114 @@ typedef struct {
 
 	/*Function pointer for frame callback*/
 	void (*pCallback)(uint8_t len, uint8_t* payload);
+	/*Index of the callback in registered callbacks array, -1 if not found*/
+	int CallbackIndex;
+	/*Flag if callback was found, but payload length is out of its range*/
+	bool LengthError;
+	/*Flag if escape byte was received, next byte has to be XORed with UART_COMMUNICATION_ESCAPE_XOR*/
+	bool Escaped;
+
+	/*Cycle counter values of frame start byte and last byte of the frame captured in receive interrupt*/
+	uint32_t FirstByteCycle;
+	uint32_t LastByteCycle;
+	/*Cycle counter value when parser found the frame complete*/
+	uint32_t ParsedCycle;
 
 } UART_FrameTypeDef;
 
+/*
+ * Latency trace of a single frame, timestamps are DWT cycle counter values (SystemCoreClock)
+ * Structure has no padding, so it is sent over UART as it is (little endian)
+ * */
+typedef struct {
+	//increasing number of the record, lets host put pages together and find overwritten records
+	uint32_t Sequence;
+	//ID and payload length of the frame
+	uint8_t ID;
+	uint8_t Length;
+	//UART_TRACE_FLAG_* bits
+	uint8_t Flags;
+	uint8_t Reserved;
+	//frame start byte received (receive interrupt)
+	uint32_t FirstByte;
+	//last byte of the frame received (receive interrupt)
+	uint32_t LastByte;
+	//parser found frame complete in UART_Communication_Update()
+	uint32_t Parsed;
+	//callback is about to be called
+	uint32_t DispatchStart;
+	//callback has returned
+	uint32_t CallbackReturn;
+} UART_TraceRecordTypeDef;
+
+//frame was handled by registered callback
+#define UART_TRACE_FLAG_CALLBACK 0x01U
+//frame was handled by the library itself (reserved ID)
+#define UART_TRACE_FLAG_RESERVED 0x02U
+
+/*
+ * Ring of the latency trace records, when full the oldest record is overwritten
+ * */
+typedef struct {
+	UART_TraceRecordTypeDef Records[UART_TRACE_DEPTH];
+	//number of records written so far, (Count % UART_TRACE_DEPTH) is the next record to write
+	uint32_t Count;
+} UART_TraceTypeDef;
+
+/*
+ * Runtime counters of the communication, used to diagnose lost data.
+ * All fields are 32bit so structure is sent over UART as it is (little endian)
+ * */
+typedef struct {
+	//bytes received in interrupt
+	uint32_t RxBytes;
+	//bytes passed to HAL for transmission
+	uint32_t TxBytes;
+	//received bytes lost because read queue was full or malloc failed
+	uint32_t RxBytesDiscarded;
+	//bytes that couldn't be enqueued for transmission
+	uint32_t TxBytesDiscarded;
+	//frames passed to registered callbacks (per ID counts are kept in UART_CallbackTypeDef)
+	uint32_t FramesDispatched;
+	//complete frames with ID nobody registered callback for
+	uint32_t FramesWithoutCallback;
+	//frame start received in the middle of the frame, partial frame was dropped
+	uint32_t Resyncs;
+	//bytes received outside of any frame
+	uint32_t UnknownBytes;
+	//malloc failures (queues and payloads)
+	uint32_t MallocErrors;
+	//largest number of bytes waiting in read and write queues
+	uint32_t ReadQueueHighWater;
+	uint32_t WriteQueueHighWater;
+	//UART errors reported by HAL
+	uint32_t OverrunErrors;
+	uint32_t FramingErrors;
+	uint32_t NoiseErrors;
+	uint32_t ParityErrors;
+	//frames and payload bytes received with UART_COMMUNICATION_SINK_ID
+	uint32_t SinkFrames;
+	uint32_t SinkBytes;
+	//partial frames dropped because UART reported an error while they were received
+	uint32_t ErrorFramesDropped;
+	//frames not dispatched because payload length was out of the range of the callback
+	uint32_t FramesBadLength;
+} UART_StatisticsTypeDef;
+
+/*
+ * Generator of UART_COMMUNICATION_SOURCE_ID frames.
+ * Byte at offset N of the generated stream is (uint8_t)N, or its complement if it is equal to frame start byte,
+ * so payload never restarts the frame and host can check every byte
+ * */
+typedef struct {
+	//bytes which still have to be generated
+	uint32_t Remaining;
+	//offset of the next byte in the generated stream
+	uint32_t Offset;
+	//payload size of generated frames (last one can be shorter)
+	uint8_t FrameLength;
+} UART_SourceTypeDef;
+
 /*
  * Structure that handles all variables required for correct communication
  *
@@ -101,12 +249,26 @@ typedef struct {
 
 	//Last received byte
 	uint8_t ReceivedByte;
+	//Byte currently being sent, HAL reads it in interrupt so it can't live on the stack
+	uint8_t TransmittedByte;
 	//Symbol of frame start
 	uint8_t FrameStartByte;
 
 	//Flag if transmission has been already started
 	bool Transsmision;
 
+	//bytes put into read queue by receive interrupt and taken from it by the parser,
+	//they give position of UART errors in the stream of received bytes
+	uint32_t RxEnqueued;
+	uint32_t RxDequeued;
+	//positions of the first and the last UART error which parser hasn't reached yet
+	uint32_t RxErrorFirst;
+	uint32_t RxErrorLast;
+	bool RxErrorPending;
+	//flag if the last received byte got into read queue, byte with framing, noise or parity error is
+	//enqueued by HAL (RxISR runs before the error callback) and belongs to the damaged frame
+	bool RxLastByteEnqueued;
+
 	//Pointer to callbacks array
 	UART_CallbackTypeDef* pRegisteredCallbacks;
 	//Count of already registered callbacks
@@ -119,6 +281,15 @@ typedef struct {
 
 	//current frame to be decode received bytes
 	UART_FrameTypeDef CurrentFrame;
+
+	//runtime counters
+	UART_StatisticsTypeDef Statistics;
+
+	//latency trace of the last frames
+	UART_TraceTypeDef Trace;
+
+	//stream requested with UART_COMMUNICATION_SOURCE_ID
+	UART_SourceTypeDef Source;
 } UART_CommunicationTypeDef;
 
 /*
@@ -126,7 +297,8 @@ typedef struct {
  *
  * @param pCommunication pointer to UART_Communication handle
  * @param huart pointer to HAL UART structure representing uart port we want to use
- * @param frame_start defines what is the frame start byte
+ * @param frame_start defines what is the frame start byte, it can't be UART_COMMUNICATION_ESCAPE_BYTE
+ * or its escaped value (COMMUNICATION_RANGE_ERROR)
  * @param queue_size define max size in bytes for read and write bytes queues
  *
  * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
@@ -144,6 +316,31 @@ extern UART_CommunicationStatusTypeDef UART_Communication_Init(UART_Communicatio
  * */
 extern UART_CommunicationStatusTypeDef UART_Communication_Register_Callback(UART_CommunicationTypeDef* pCommunication, uint8_t ID, void (*pCallback)(uint8_t len, uint8_t* payload));
 
+/*
+ * @brief Registers callback which is called only with payload length in given range, other frames with its ID are dropped
+ * and counted in FramesBadLength
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param ID ID of the frame to register
+ * @param pCallback pointer to callback function
+ * @param min_length smallest accepted payload length
+ * @param max_length largest accepted payload length (not smaller than min_length)
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Register_Callback_Length(UART_CommunicationTypeDef* pCommunication, uint8_t ID, void (*pCallback)(uint8_t len, uint8_t* payload),
+		uint8_t min_length, uint8_t max_length);
+
+/*
+ * @brief Should be called from a frame callback which finds the payload length wrong for its content,
+ * the frame is counted in FramesBadLength instead of FramesDispatched
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Reject_Length(UART_CommunicationTypeDef* pCommunication);
+
 /*
  * @brief Function that will be called in main loop, fills in current frame struct and calls callbacks
  *
@@ -180,6 +377,26 @@ extern UART_CommunicationStatusTypeDef UART_Communication_Transmit_Interrupt_Cal
  * */
 extern UART_CommunicationStatusTypeDef UART_Communication_Receive_Interrupt_Callback(UART_CommunicationTypeDef* pCommunication);
 
+/*
+ * @brief callback that should be called in HAL_UART_ErrorCallback(), counts errors by type,
+ * re-arms reception aborted by HAL and marks the received frame as damaged
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Error_Interrupt_Callback(UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Copies runtime counters, copy is consistent even if interrupts update them in the meantime
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param pStatistics pointer to memory where counters will be copied
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Get_Statistics(UART_CommunicationTypeDef* pCommunication, UART_StatisticsTypeDef* pStatistics);
+
 /*
  * @brief function that sends character via UART, should be called in __io_putchar from syscall.c
  *
@@ -190,6 +407,42 @@ extern UART_CommunicationStatusTypeDef UART_Communication_Receive_Interrupt_Call
  * */
 extern UART_CommunicationStatusTypeDef UART_Communication__io_put_char(UART_CommunicationTypeDef* pCommunication, int ch);
 
+/*
+ * @brief Enqueues whole frame (frame start, ID, length, payload) for transmission,
+ * frame is enqueued only if it fits in the queue as a whole (with escape bytes)
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param ID ID of the frame
+ * @param len length of the payload
+ * @param payload pointer to payload, can be NULL if len is 0
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Transmit_Frame(UART_CommunicationTypeDef* pCommunication, uint8_t ID, uint8_t len, uint8_t* payload);
+
+/*
+ * @brief Returns number of bytes data takes in the write queue when it is sent inside of the frame (with escape bytes),
+ * lets caller fill the frame up to the free space of the queue
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param data bytes of the frame (ID, length or payload)
+ * @param size number of bytes
+ *
+ * @retval number of bytes after escaping
+ * */
+extern uint32_t UART_Communication_Escaped_Size(UART_CommunicationTypeDef* pCommunication, const uint8_t* data, uint32_t size);
+
+/*
+ * @brief Checks if library has any work left for UART_Communication_Update(), used to decide if core can sleep
+ * (should be called with interrupts disabled so result can't change before core goes to sleep)
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param pIdle set to true if there are no received bytes, no complete frame and no transmission waiting to be started
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef UART_Communication_Is_Idle(UART_CommunicationTypeDef* pCommunication, bool* pIdle);
+
 /*
  * @brief Searches all registered frames by their ID, if frame with specified ID not found returns -1
  *
@@ -201,6 +454,57 @@ extern UART_CommunicationStatusTypeDef UART_Communication__io_put_char(UART_Comm
  * */
 extern UART_CommunicationStatusTypeDef __find_callback(UART_CommunicationTypeDef* pCommunication, uint8_t ID, int* frame_index);
 
+/*
+ * @brief Handles frames with IDs reserved by the library
+ *
+ * @param pCommunication pointer to UART_Communication handle, CurrentFrame is the complete reserved frame
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef __handle_reserved_frame(UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Skips bytes which can't change state of the parser: bytes outside of frames
+ * and payload of frames nobody registered callback for, stops before frame start byte
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval UART_CommunicationStatusTypeDef COMMUNICATION_UNKNOWN_DATA if bytes outside of frames were skipped
+ * */
+extern UART_CommunicationStatusTypeDef __skip_bytes(UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Drops partial frame and bytes received between UART errors when parser reaches position
+ * of the first error reported by UART_Communication_Error_Interrupt_Callback()
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef __drop_damaged_bytes(UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Enqueues as many generated frames of requested stream as fit in the write queue,
+ * the rest is enqueued in next UART_Communication_Update() calls when transmission makes space
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef __source_update(UART_CommunicationTypeDef* pCommunication);
+
+/*
+ * @brief Stores latency trace record of the current (complete) frame in the trace ring
+ *
+ * @param pCommunication pointer to UART_Communication handle
+ * @param flags UART_TRACE_FLAG_* bits describing how frame was handled
+ * @param dispatch_cycle cycle counter value before callback was called
+ * @param return_cycle cycle counter value after callback has returned
+ *
+ * @retval UART_CommunicationStatusTypeDef status if function was executed successfully
+ * */
+extern UART_CommunicationStatusTypeDef __trace_record(UART_CommunicationTypeDef* pCommunication, uint8_t flags, uint32_t dispatch_cycle, uint32_t return_cycle);
+
 /*
  * @brief Clears UART_Frame structure to default values
  *
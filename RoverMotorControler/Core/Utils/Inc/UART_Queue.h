@@ -5,27 +5,21 @@
 #ifndef UART_QUEUE_H_
 #define UART_QUEUE_H_
 
-/* Small and simple implementation of linked-list based
- * queue which will be used to store byte's to be processed*/
+/* Small and simple implementation of ring buffer based
+ * queue which will be used to store byte's to be processed.
+ * Memory for all bytes is allocated once in UART_Queue_Init(),
+ * bytes are stored one after another, so they can be scanned
+ * a word (4 bytes) at a time */
 
 /* Enum type for basic exception handling*/
 typedef enum {
   QUEUE_OK, // returned when operation was successful
-  QUEUE_FAILED_TO_MALLOC, // returned if malloc failed during enqueuing the element
+  QUEUE_FAILED_TO_MALLOC, // returned if malloc failed during initialization of the queue
   QUEUE_FULL_BYTE_DISCARDED, //returned if attempted to enqueue data to full queue
   QUEUE_EMPTY, //returned if tried to dequeue empty queue
   QUEUE_FAILED_TO_DISPOSE //returned when dispose function failed to dequeue element (possible memory leak)
 } UART_QueueStatusTypeDef;
 
-/* Single element of linked-queue. Each element
- * stores one byte of data and pointer to next
- * element in queue */
-
-typedef struct UART_QueueElementTypeDef {
-	uint8_t byte; //one byte of data
-	struct UART_QueueElementTypeDef *pNext; //pointer to next element
-} UART_QueueElementTypeDef;
-
 /* The actual queue*/
 typedef struct {
 	/* Defines max size of the queue, it prevents from
@@ -34,19 +28,21 @@ typedef struct {
 	 * all data which will be enqueued */
 	uint16_t MAX_QUEUE_SIZE;
 
-	/* Pointer to the first element of the queue*/
-	UART_QueueElementTypeDef *pFirst;
-	/* Pointer to the last element of the queue,
-	 * storing it reduces time complexity needed to add next element to
-	 * the queue*/
-	UART_QueueElementTypeDef *pLast;
+	/* Stored bytes, MAX_QUEUE_SIZE of them*/
+	uint8_t *pBuffer;
+	/* When every byte was enqueued (cycle counter), same index as in pBuffer,
+	 * NULL when the queue was initialized without timestamps (UART_Queue_Init())*/
+	uint32_t *pTimestamps;
+	/* Index of the first byte of the queue*/
+	uint32_t Head;
 
 	/* Actual size of the queue*/
 	uint32_t Size;
 } UART_QueueTypeDef;
 
 /*
- * @brief Initializes queue pointers with NULL, and sets its max size
+ * @brief Allocates memory for max_size bytes and sets queue empty, timestamps are not stored
+ * (stamped functions read them as 0)
  *
  * @param pQueue pointer to queue
  * @param max_size max length of the queue
@@ -55,6 +51,16 @@ typedef struct {
  * */
 extern UART_QueueStatusTypeDef UART_Queue_Init(UART_QueueTypeDef* pQueue, uint32_t max_size);
 
+/*
+ * @brief Same as UART_Queue_Init(), memory for timestamp of every byte (4 bytes each) is allocated as well
+ *
+ * @param pQueue pointer to queue
+ * @param max_size max length of the queue
+ *
+ * @retval QUEUE_STATUS
+ * */
+extern UART_QueueStatusTypeDef UART_Queue_Init_Stamped(UART_QueueTypeDef* pQueue, uint32_t max_size);
+
 /*
  * @brief Enqueues one byte to the queue
  *
@@ -65,6 +71,17 @@ extern UART_QueueStatusTypeDef UART_Queue_Init(UART_QueueTypeDef* pQueue, uint32
  * */
 extern UART_QueueStatusTypeDef UART_Queue_Enqueue(UART_QueueTypeDef* pQueue, uint8_t byte);
 
+/*
+ * @brief Enqueues one byte to the queue together with its timestamp
+ *
+ * @param pQueue pointer to queue
+ * @param byte one byte of data to be enqueued
+ * @param timestamp value stored along with the byte
+ *
+ * @retval QUEUE_STATUS
+ * */
+extern UART_QueueStatusTypeDef UART_Queue_Enqueue_Stamped(UART_QueueTypeDef* pQueue, uint8_t byte, uint32_t timestamp);
+
 /*
  * @brief Dequeues one byte from the queue
  *
@@ -76,7 +93,49 @@ extern UART_QueueStatusTypeDef UART_Queue_Enqueue(UART_QueueTypeDef* pQueue, uin
 extern UART_QueueStatusTypeDef UART_Queue_Dequeue(UART_QueueTypeDef* pQueue, uint8_t* pByte);
 
 /*
- * @brief Dequeues all remaining data from the queue, stored values are lost
+ * @brief Dequeues one byte from the queue together with its timestamp
+ *
+ * @param pQueue pointer to queue
+ * @param pByte pointer to memory where dequeued value will be stored
+ * @param pTimestamp pointer to memory where timestamp of the byte will be stored, can be NULL
+ *
+ * @retval QUEUE_STATUS
+ * */
+extern UART_QueueStatusTypeDef UART_Queue_Dequeue_Stamped(UART_QueueTypeDef* pQueue, uint8_t* pByte, uint32_t* pTimestamp);
+
+/*
+ * @brief Discards bytes from the beginning of the queue until byte equal to value is found
+ * (it stays in the queue) or max_count bytes were discarded, bytes are compared 4 at a time
+ *
+ * @param pQueue pointer to queue
+ * @param value byte which stops discarding
+ * @param max_count max number of bytes to discard
+ * @param pSkipped pointer to memory where number of discarded bytes will be stored
+ * @param pTimestamp pointer to memory where timestamp of the last discarded byte will be stored
+ * (not changed when nothing was discarded), can be NULL
+ *
+ * @retval QUEUE_STATUS
+ * */
+extern UART_QueueStatusTypeDef UART_Queue_Skip_Until(UART_QueueTypeDef* pQueue, uint8_t value, uint32_t max_count, uint32_t* pSkipped, uint32_t* pTimestamp);
+
+/*
+ * @brief Same as UART_Queue_Skip_Until(), discarding stops at byte equal to value or other
+ *
+ * @param pQueue pointer to queue
+ * @param value byte which stops discarding
+ * @param other second byte which stops discarding
+ * @param max_count max number of bytes to discard
+ * @param pSkipped pointer to memory where number of discarded bytes will be stored
+ * @param pTimestamp pointer to memory where timestamp of the last discarded byte will be stored
+ * (not changed when nothing was discarded), can be NULL
+ *
+ * @retval QUEUE_STATUS
+ * */
+extern UART_QueueStatusTypeDef UART_Queue_Skip_Until_Either(UART_QueueTypeDef* pQueue, uint8_t value, uint8_t other, uint32_t max_count, uint32_t* pSkipped, uint32_t* pTimestamp);
+
+/*
+ * @brief Dequeues all remaining data from the queue and frees its memory,
+ * queue has to be initialized again before it is used
  *
  * @param pQueue pointer to queue
  *
@@ -0,0 +1,139 @@
+/*
+ * Heap_Stats.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Heap_Stats.h"
+#include "Cycle_Counter.h"
+#include "Profiler.h"
+
+#include <malloc.h>
+#include <string.h>
+
+/*Original newlib functions, available thanks to --wrap linker option*/
+extern void* __real_malloc(size_t size);
+extern void __real_free(void* ptr);
+extern void* __real_realloc(void* ptr, size_t size);
+
+/*All fields are modified with interrupts disabled*/
+static Heap_StatsTypeDef heap_stats;
+/*Sums used to calculate mean cost, kept 64bit so they don't overflow*/
+static uint64_t heap_malloc_cycles_total;
+static uint64_t heap_free_cycles_total;
+
+/*Accounts allocation of the block, called with interrupts disabled*/
+static void __heap_stats_allocated(void* ptr, uint32_t cycles){
+	if(ptr == NULL){
+		heap_stats.FailedAllocations++;
+		return;
+	}
+
+	heap_stats.MallocCount++;
+	heap_stats.LiveAllocations++;
+	heap_stats.LiveBytes += malloc_usable_size(ptr);
+	if(heap_stats.LiveBytes > heap_stats.PeakLiveBytes)
+		heap_stats.PeakLiveBytes = heap_stats.LiveBytes;
+
+	if(cycles > heap_stats.MallocCyclesMax)
+		heap_stats.MallocCyclesMax = cycles;
+	heap_malloc_cycles_total += cycles;
+}
+
+/*Accounts block that is going to be freed, called with interrupts disabled*/
+static void __heap_stats_freed(void* ptr){
+	heap_stats.LiveAllocations--;
+	heap_stats.LiveBytes -= malloc_usable_size(ptr);
+}
+
+void* __wrap_malloc(size_t size){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	uint32_t start = Cycle_Counter_Get();
+	void* ptr = __real_malloc(size);
+	uint32_t cycles = Cycle_Counter_Get() - start;
+
+	__heap_stats_allocated(ptr, cycles);
+	__set_PRIMASK(primask);
+
+	Profiler_Record(PROFILER_SITE_MALLOC, cycles);
+	return ptr;
+}
+
+void __wrap_free(void* ptr){
+	//free(NULL) does nothing, it shouldn't be counted
+	if(ptr == NULL)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	__heap_stats_freed(ptr);
+
+	uint32_t start = Cycle_Counter_Get();
+	__real_free(ptr);
+	uint32_t cycles = Cycle_Counter_Get() - start;
+
+	heap_stats.FreeCount++;
+	if(cycles > heap_stats.FreeCyclesMax)
+		heap_stats.FreeCyclesMax = cycles;
+	heap_free_cycles_total += cycles;
+
+	__set_PRIMASK(primask);
+
+	Profiler_Record(PROFILER_SITE_FREE, cycles);
+}
+
+void* __wrap_realloc(void* ptr, size_t size){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	//old block is released by realloc (unless it fails), account it as freed first
+	uint32_t old_size = (ptr != NULL) ? malloc_usable_size(ptr) : 0;
+
+	uint32_t start = Cycle_Counter_Get();
+	void* new_ptr = __real_realloc(ptr, size);
+	uint32_t cycles = Cycle_Counter_Get() - start;
+
+	if(new_ptr != NULL && ptr != NULL){
+		heap_stats.LiveAllocations--;
+		heap_stats.LiveBytes -= old_size;
+	}
+	__heap_stats_allocated(new_ptr, cycles);
+
+	__set_PRIMASK(primask);
+
+	Profiler_Record(PROFILER_SITE_MALLOC, cycles);
+	return new_ptr;
+}
+
+void Heap_Stats_Sbrk(uint32_t heap_size, uint32_t heap_limit, bool failed){
+	heap_stats.HeapSize = heap_size;
+	heap_stats.HeapLimit = heap_limit;
+	if(failed)
+		heap_stats.SbrkFailures++;
+}
+
+void Heap_Stats_Get(Heap_StatsTypeDef* pStats){
+	if(pStats == NULL)
+		return;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	memcpy(pStats, &heap_stats, sizeof(Heap_StatsTypeDef));
+	uint64_t malloc_total = heap_malloc_cycles_total;
+	uint64_t free_total = heap_free_cycles_total;
+	__set_PRIMASK(primask);
+
+	pStats->MallocCyclesMean = pStats->MallocCount ? (uint32_t)(malloc_total / pStats->MallocCount) : 0;
+	pStats->FreeCyclesMean = pStats->FreeCount ? (uint32_t)(free_total / pStats->FreeCount) : 0;
+}
+
+UART_CommunicationStatusTypeDef Heap_Stats_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID){
+	_Static_assert(sizeof(Heap_StatsTypeDef) % sizeof(uint32_t) == 0, "Heap_StatsTypeDef must contain only 32bit fields");
+
+	Heap_StatsTypeDef stats;
+	Heap_Stats_Get(&stats);
+
+	return UART_Communication_Transmit_Frame(pCommunication, ID, sizeof(stats), (uint8_t*)&stats);
+}
@@ -0,0 +1,99 @@
+/*
+ * Idle_Sleep.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Idle_Sleep.h"
+
+static void __idle_sleep_clear(Idle_SleepTypeDef* pIdle){
+	pIdle->SleepCount = 0;
+	pIdle->DataWakeCount = 0;
+	pIdle->WakePending = false;
+	pIdle->WakeCycle = 0;
+	pIdle->LastWakeLatency = 0;
+	pIdle->MaxWakeLatency = 0;
+	pIdle->TotalWakeLatency = 0;
+}
+
+Idle_SleepStatusTypeDef Idle_Sleep_Init(Idle_SleepTypeDef* pIdle){
+	if(pIdle == NULL)
+		return IDLE_SLEEP_NULL_ERROR;
+
+	__idle_sleep_clear(pIdle);
+
+	Cycle_Counter_Init();
+
+	return IDLE_SLEEP_OK;
+}
+
+Idle_SleepStatusTypeDef Idle_Sleep_Update(Idle_SleepTypeDef* pIdle, UART_CommunicationTypeDef* pCommunication){
+	if(pIdle == NULL || pCommunication == NULL)
+		return IDLE_SLEEP_NULL_ERROR;
+
+	//main loop has just processed data which woke us up, we can measure how long it took
+	if(pIdle->WakePending){
+		uint32_t latency = Cycle_Counter_Get() - pIdle->WakeCycle;
+
+		pIdle->LastWakeLatency = latency;
+		if(latency > pIdle->MaxWakeLatency)
+			pIdle->MaxWakeLatency = latency;
+		pIdle->TotalWakeLatency += latency;
+
+		pIdle->WakePending = false;
+	}
+
+	bool idle;
+
+	//interrupts have to be masked between the check and __WFI(),
+	//otherwise byte received in between would wait for the next interrupt
+	__disable_irq();
+	UART_Communication_Is_Idle(pCommunication, &idle);
+	if(!idle){
+		__enable_irq();
+		return IDLE_SLEEP_BUSY;
+	}
+
+	//pending interrupt wakes core up even with PRIMASK set
+	__DSB();
+	__WFI();
+	uint32_t wake_cycle = Cycle_Counter_Get();
+
+	//handler of the interrupt which woke us up is executed here
+	__enable_irq();
+
+	pIdle->SleepCount++;
+
+	//check if we have been woken up by data or just by the timer
+	UART_Communication_Is_Idle(pCommunication, &idle);
+	if(!idle){
+		pIdle->DataWakeCount++;
+		pIdle->WakeCycle = wake_cycle;
+		pIdle->WakePending = true;
+	}
+
+	return IDLE_SLEEP_OK;
+}
+
+UART_CommunicationStatusTypeDef Idle_Sleep_Transmit(Idle_SleepTypeDef* pIdle, UART_CommunicationTypeDef* pCommunication, uint8_t ID, bool clear){
+	_Static_assert(sizeof(Idle_SleepStatsTypeDef) % sizeof(uint32_t) == 0, "Idle_SleepStatsTypeDef must contain only 32bit fields");
+
+	if(pIdle == NULL)
+		return COMMUNICATION_NULL_ERROR;
+
+	Idle_SleepStatsTypeDef stats = {
+			.SleepCount = pIdle->SleepCount,
+			.DataWakeCount = pIdle->DataWakeCount,
+			.LastWakeLatency = pIdle->LastWakeLatency,
+			.MaxWakeLatency = pIdle->MaxWakeLatency,
+			.MeanWakeLatency = pIdle->DataWakeCount > 0 ? (uint32_t)(pIdle->TotalWakeLatency / pIdle->DataWakeCount) : 0,
+			.CoreClock = SystemCoreClock
+	};
+
+	UART_CommunicationStatusTypeDef status = UART_Communication_Transmit_Frame(pCommunication, ID, sizeof(stats), (uint8_t*)&stats);
+
+	//wake up being measured right now (the one which brought this request) is dropped as well
+	if(clear && status == COMMUNICATION_OK)
+		__idle_sleep_clear(pIdle);
+
+	return status;
+}
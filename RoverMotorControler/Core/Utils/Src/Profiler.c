@@ -0,0 +1,114 @@
+/*
+ * Profiler.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Profiler.h"
+
+#include <string.h>
+
+/*Statistics of all sites*/
+static Profiler_SiteStatsTypeDef profiler_sites[PROFILER_SITE_COUNT];
+
+/*Response being built, Profiler_Transmit() is called only from the main loop*/
+static uint8_t profiler_payload[PROFILER_FRAME_PAYLOAD_SIZE];
+
+/*Writes 32bit value in little endian order, returns pointer to next free byte*/
+static uint8_t* __profiler_put_u32(uint8_t* pBuffer, uint32_t value){
+	pBuffer[0] = (uint8_t)(value);
+	pBuffer[1] = (uint8_t)(value >> 8);
+	pBuffer[2] = (uint8_t)(value >> 16);
+	pBuffer[3] = (uint8_t)(value >> 24);
+	return pBuffer + 4;
+}
+
+/*Clears statistics of a single site*/
+static void __profiler_site_init(Profiler_SiteStatsTypeDef* pStats){
+	memset(pStats, 0, sizeof(Profiler_SiteStatsTypeDef));
+	pStats->Min = UINT32_MAX;
+}
+
+Profiler_StatusTypeDef Profiler_Init(void){
+	for(uint8_t i = 0; i < PROFILER_SITE_COUNT; i++)
+		__profiler_site_init(&profiler_sites[i]);
+
+	Cycle_Counter_Init();
+
+	return PROFILER_OK;
+}
+
+void Profiler_Record(Profiler_SiteTypeDef site, uint32_t cycles){
+	if(site >= PROFILER_SITE_COUNT)
+		return;
+
+	Profiler_SiteStatsTypeDef* pStats = &profiler_sites[site];
+
+	//site can be recorded both from main loop and interrupt, so update has to be atomic
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	pStats->Count++;
+	if(cycles < pStats->Min)
+		pStats->Min = cycles;
+	if(cycles > pStats->Max)
+		pStats->Max = cycles;
+	pStats->Total += cycles;
+
+	//index of the highest set bit, 0 and 1 cycle both land in the first bucket
+	pStats->Histogram[31U - __CLZ(cycles | 1U)]++;
+
+	__set_PRIMASK(primask);
+}
+
+Profiler_StatusTypeDef Profiler_Get(Profiler_SiteTypeDef site, Profiler_SiteStatsTypeDef* pStats){
+	if(pStats == NULL || site >= PROFILER_SITE_COUNT)
+		return PROFILER_NULL_ERROR;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	memcpy(pStats, &profiler_sites[site], sizeof(Profiler_SiteStatsTypeDef));
+	__set_PRIMASK(primask);
+
+	return PROFILER_OK;
+}
+
+Profiler_StatusTypeDef Profiler_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID, uint8_t site, bool reset){
+	if(pCommunication == NULL)
+		return PROFILER_NULL_ERROR;
+
+	uint8_t* payload = profiler_payload;
+	payload[0] = site;
+	payload[1] = PROFILER_SITE_COUNT;
+
+	//host learns the number of sites from any response
+	if(site >= PROFILER_SITE_COUNT){
+		if(UART_Communication_Transmit_Frame(pCommunication, ID, 2U, payload) != COMMUNICATION_OK)
+			return PROFILER_TRANSMIT_ERROR;
+		return PROFILER_RANGE_ERROR;
+	}
+
+	Profiler_SiteStatsTypeDef stats;
+	Profiler_Get(site, &stats);
+
+	//serialize statistics, mean is calculated here so host doesn't need 64bit sum
+	uint8_t* pData = &payload[2];
+	pData = __profiler_put_u32(pData, stats.Count);
+	pData = __profiler_put_u32(pData, stats.Count ? stats.Min : 0);
+	pData = __profiler_put_u32(pData, stats.Max);
+	pData = __profiler_put_u32(pData, stats.Count ? (uint32_t)(stats.Total / stats.Count) : 0);
+	for(uint8_t j = 0; j < PROFILER_HISTOGRAM_BUCKETS; j++)
+		pData = __profiler_put_u32(pData, stats.Histogram[j]);
+
+	//statistics which weren't sent are kept
+	if(UART_Communication_Transmit_Frame(pCommunication, ID, PROFILER_FRAME_PAYLOAD_SIZE, payload) != COMMUNICATION_OK)
+		return PROFILER_TRANSMIT_ERROR;
+
+	if(reset){
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		__profiler_site_init(&profiler_sites[site]);
+		__set_PRIMASK(primask);
+	}
+
+	return PROFILER_OK;
+}
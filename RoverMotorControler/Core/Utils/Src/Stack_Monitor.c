@@ -0,0 +1,93 @@
+/*
+ * Stack_Monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Stack_Monitor.h"
+
+/*Symbols defined in the linker script*/
+extern uint8_t _estack;
+extern uint32_t _Min_Stack_Size;
+
+static uint32_t stack_threshold_faults;
+static uint32_t stack_thread_depth_max;
+static uint32_t stack_handler_depth_max;
+
+/*Lowest address of the stack reserved by _Min_Stack_Size*/
+static inline uint32_t* __stack_bottom(void){
+	return (uint32_t*)((uint32_t)&_estack - (uint32_t)&_Min_Stack_Size);
+}
+
+/*Word which is checked by Stack_Monitor_Check()*/
+static inline uint32_t* __stack_guard(void){
+	uint32_t depth = ((uint32_t)&_Min_Stack_Size * STACK_MONITOR_THRESHOLD_PERCENT / 100U) & ~3U;
+	return (uint32_t*)((uint32_t)&_estack - depth);
+}
+
+void Stack_Monitor_Init(void){
+	stack_threshold_faults = 0;
+	stack_thread_depth_max = 0;
+	stack_handler_depth_max = 0;
+
+	//guard is far below main(), but make sure it is painted
+	if((uint32_t)__stack_guard() < __get_MSP())
+		*__stack_guard() = STACK_MONITOR_PATTERN;
+}
+
+bool Stack_Monitor_Check(void){
+	uint32_t* pGuard = __stack_guard();
+
+	if(*pGuard == STACK_MONITOR_PATTERN)
+		return false;
+
+	stack_threshold_faults++;
+
+	//paint guard again so the next crossing is detected as well,
+	//it is only safe when we are above it and no interrupt is using the stack
+	if((uint32_t)pGuard < __get_MSP() && __get_IPSR() == 0U)
+		*pGuard = STACK_MONITOR_PATTERN;
+
+	return true;
+}
+
+void Stack_Monitor_Sample(void){
+	uint32_t depth = (uint32_t)&_estack - __get_MSP();
+
+	//IPSR holds number of the active exception, 0 means thread mode
+	if(__get_IPSR() == 0U){
+		if(depth > stack_thread_depth_max)
+			stack_thread_depth_max = depth;
+	} else {
+		if(depth > stack_handler_depth_max)
+			stack_handler_depth_max = depth;
+	}
+}
+
+void Stack_Monitor_Get(Stack_MonitorTypeDef* pStats){
+	if(pStats == NULL)
+		return;
+
+	uint32_t* pWord = __stack_bottom();
+	uint32_t* pTop = (uint32_t*)&_estack;
+
+	//the guard is painted again after fault, so it can't be counted as untouched stack
+	uint32_t* pGuard = __stack_guard();
+	while(pWord < pTop && (*pWord == STACK_MONITOR_PATTERN || pWord == pGuard))
+		pWord++;
+
+	pStats->StackSize = (uint32_t)&_Min_Stack_Size;
+	pStats->HighWater = (uint32_t)pTop - (uint32_t)pWord;
+	pStats->Threshold = (uint32_t)&_estack - (uint32_t)pGuard;
+	pStats->ThresholdFaults = stack_threshold_faults;
+	pStats->ThreadDepthMax = stack_thread_depth_max;
+	pStats->HandlerDepthMax = stack_handler_depth_max;
+}
+
+UART_CommunicationStatusTypeDef Stack_Monitor_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID){
+	_Static_assert(sizeof(Stack_MonitorTypeDef) % sizeof(uint32_t) == 0, "Stack_MonitorTypeDef must contain only 32bit fields");
+
+	Stack_MonitorTypeDef stats;
+	Stack_Monitor_Get(&stats);
+
+	return UART_Communication_Transmit_Frame(pCommunication, ID, sizeof(stats), (uint8_t*)&stats);
+}
@@ -5,26 +5,118 @@
  *      Author: Lukasz
  */
 #include "UART_Communication.h"
+#include "Profiler.h"
+
+#include <string.h>
+
+/*Payload of frames generated by the library (statistics, trace, source), they are built only in UART_Communication_Update()
+ * from the main loop and enqueued before it returns, so one buffer serves all of them instead of 255 bytes of stack each*/
+static uint8_t communication_payload[UART_PAYLOAD_LENGTH_MAX];
+
+/*Largest number of bytes a generated frame adds to its payload: frame start, ID, length and escapes of the length
+ * and of the escape byte and complemented frame start, which appear at most once in 255 consecutive generated bytes*/
+#define UART_SOURCE_FRAME_OVERHEAD 6U
+
+/*
+ * @brief Enqueues one byte to the write queue, transmit interrupt dequeues from the same queue
+ * so interrupts are disabled for the time of the operation
+ * */
+static UART_QueueStatusTypeDef __enqueue_write_byte(UART_CommunicationTypeDef* pCommunication, uint8_t byte){
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	UART_QueueStatusTypeDef status = UART_Queue_Enqueue(&pCommunication->WriteBytesQueue, byte);
+	if(status == QUEUE_OK){
+		if(pCommunication->WriteBytesQueue.Size > pCommunication->Statistics.WriteQueueHighWater)
+			pCommunication->Statistics.WriteQueueHighWater = pCommunication->WriteBytesQueue.Size;
+	} else {
+		pCommunication->Statistics.TxBytesDiscarded++;
+		if(status == QUEUE_FAILED_TO_MALLOC)
+			pCommunication->Statistics.MallocErrors++;
+	}
+	__set_PRIMASK(primask);
+
+	return status;
+}
+
+/*
+ * @brief Checks if byte has to be escaped inside of the frame
+ * */
+static inline bool __needs_escape(UART_CommunicationTypeDef* pCommunication, uint8_t byte){
+	return byte == pCommunication->FrameStartByte || byte == UART_COMMUNICATION_ESCAPE_BYTE;
+}
+
+/*
+ * @brief Enqueues one byte of the frame, escaped if it is equal to frame start or escape byte
+ * */
+static UART_QueueStatusTypeDef __enqueue_frame_byte(UART_CommunicationTypeDef* pCommunication, uint8_t byte){
+	if(!__needs_escape(pCommunication, byte))
+		return __enqueue_write_byte(pCommunication, byte);
+
+	UART_QueueStatusTypeDef status = __enqueue_write_byte(pCommunication, UART_COMMUNICATION_ESCAPE_BYTE);
+	if(status != QUEUE_OK)
+		return status;
+	return __enqueue_write_byte(pCommunication, byte ^ UART_COMMUNICATION_ESCAPE_XOR);
+}
+
+/*
+ * @brief Returns number of bytes the frame takes in the write queue, escape bytes included
+ * */
+static uint32_t __frame_size(UART_CommunicationTypeDef* pCommunication, uint8_t ID, uint8_t len, const uint8_t* payload){
+	return 3U + __needs_escape(pCommunication, ID) + __needs_escape(pCommunication, len)
+			+ UART_Communication_Escaped_Size(pCommunication, payload, len);
+}
+
+/*
+ * @brief Limits number of bytes the parser can take from read queue at once, so it stops
+ * at the position of pending UART error, must be called with interrupts disabled
+ * */
+static uint32_t __bytes_before_error(UART_CommunicationTypeDef* pCommunication, uint32_t max_count){
+	if(!pCommunication->RxErrorPending)
+		return max_count;
+
+	uint32_t count = pCommunication->RxErrorFirst - pCommunication->RxDequeued;
+	return count < max_count ? count : max_count;
+}
 
 
 UART_CommunicationStatusTypeDef UART_Communication_Init(UART_CommunicationTypeDef* pCommunication, UART_HandleTypeDef* huart, uint8_t frame_start, uint32_t queue_size){
 	if(pCommunication == NULL)
 			return COMMUNICATION_NULL_ERROR;
 
+	//escaped bytes must not look like frame start
+	if(frame_start == UART_COMMUNICATION_ESCAPE_BYTE || frame_start == (UART_COMMUNICATION_ESCAPE_BYTE ^ UART_COMMUNICATION_ESCAPE_XOR))
+		return COMMUNICATION_RANGE_ERROR;
+
 	/*Initialize fields of the UART_Communication structure*/
 	pCommunication->HAL_UART_Handle = huart;
 
 	pCommunication->ReceivedByte = 0;
+	pCommunication->TransmittedByte = 0;
 	pCommunication->FrameStartByte = frame_start;
 
 	pCommunication->Transsmision = false;
 
+	pCommunication->RxEnqueued = 0;
+	pCommunication->RxDequeued = 0;
+	pCommunication->RxErrorFirst = 0;
+	pCommunication->RxErrorLast = 0;
+	pCommunication->RxErrorPending = false;
+	pCommunication->RxLastByteEnqueued = false;
+
 	pCommunication->pRegisteredCallbacks = NULL;
 	pCommunication->RegisteredCallbacksCount = 0;
 
 	__uart_frame_init(&pCommunication->CurrentFrame);
 
-	if(UART_Queue_Init(&pCommunication->ReadBytesQueue, queue_size) != QUEUE_OK){
+	memset(&pCommunication->Statistics, 0, sizeof(UART_StatisticsTypeDef));
+	memset(&pCommunication->Trace, 0, sizeof(UART_TraceTypeDef));
+	memset(&pCommunication->Source, 0, sizeof(UART_SourceTypeDef));
+
+	//received bytes are stamped with cycle counter
+	Cycle_Counter_Init();
+
+	//only received bytes need timestamps (latency trace)
+	if(UART_Queue_Init_Stamped(&pCommunication->ReadBytesQueue, queue_size) != QUEUE_OK){
 		return COMMUNICATION_QUEUE_FAILED;
 	};
 
@@ -40,9 +132,22 @@ UART_CommunicationStatusTypeDef UART_Communication_Init(UART_CommunicationTypeDe
 }
 
 UART_CommunicationStatusTypeDef UART_Communication_Register_Callback(UART_CommunicationTypeDef* pCommunication, uint8_t ID, void (*pCallback)(uint8_t len, uint8_t* payload)){
+	return UART_Communication_Register_Callback_Length(pCommunication, ID, pCallback, 0, UART_PAYLOAD_LENGTH_MAX);
+}
+
+UART_CommunicationStatusTypeDef UART_Communication_Register_Callback_Length(UART_CommunicationTypeDef* pCommunication, uint8_t ID, void (*pCallback)(uint8_t len, uint8_t* payload),
+		uint8_t min_length, uint8_t max_length){
 	if(pCommunication == NULL)
 			return COMMUNICATION_NULL_ERROR;
 
+	//those frames are handled by the library
+	if(ID >= UART_COMMUNICATION_RESERVED_ID_FIRST)
+		return COMMUNICATION_RESERVED_ID;
+
+	//empty range would drop every frame of the ID
+	if(min_length > max_length)
+		return COMMUNICATION_RANGE_ERROR;
+
 	//reallocate more memory for new callback
 	pCommunication->pRegisteredCallbacks = realloc(pCommunication->pRegisteredCallbacks, sizeof(UART_CallbackTypeDef)*(pCommunication->RegisteredCallbacksCount+1));
 
@@ -53,6 +158,9 @@ UART_CommunicationStatusTypeDef UART_Communication_Register_Callback(UART_Commun
 	//assign callback and id
 	pCommunication->pRegisteredCallbacks[pCommunication->RegisteredCallbacksCount].ID = ID;
 	pCommunication->pRegisteredCallbacks[pCommunication->RegisteredCallbacksCount].pCallback = pCallback;
+	pCommunication->pRegisteredCallbacks[pCommunication->RegisteredCallbacksCount].MinLength = min_length;
+	pCommunication->pRegisteredCallbacks[pCommunication->RegisteredCallbacksCount].MaxLength = max_length;
+	pCommunication->pRegisteredCallbacks[pCommunication->RegisteredCallbacksCount].DispatchCount = 0;
 
 	//increase size of registered callbacks
 	pCommunication->RegisteredCallbacksCount++;
@@ -60,22 +168,69 @@ UART_CommunicationStatusTypeDef UART_Communication_Register_Callback(UART_Commun
 	return COMMUNICATION_OK;
 }
 
+UART_CommunicationStatusTypeDef UART_Communication_Reject_Length(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	//only frame being dispatched can be rejected
+	if(pCommunication->CurrentFrame.State != REQUEST_COMPLETE || pCommunication->CurrentFrame.pCallback == NULL)
+		return COMMUNICATION_CALLBACK_NOT_FOUND;
+
+	pCommunication->CurrentFrame.LengthError = true;
+
+	return COMMUNICATION_OK;
+}
+
 UART_CommunicationStatusTypeDef UART_Communication_Update(UART_CommunicationTypeDef* pCommunication){
 	if(pCommunication == NULL)
 		return COMMUNICATION_NULL_ERROR;
 
+	//bytes which can't change state of the parser are skipped 4 at a time
+	if(__skip_bytes(pCommunication) == COMMUNICATION_UNKNOWN_DATA)
+		return COMMUNICATION_UNKNOWN_DATA;
+
+	//frame received while UART reported an error is damaged
+	__drop_damaged_bytes(pCommunication);
+
 	uint8_t data;
+	//cycle counter value captured when the byte was received
+	uint32_t timestamp;
+	UART_QueueStatusTypeDef dequeue_status = QUEUE_EMPTY;
+
+	//frame completed by skipped payload is dispatched before next byte is read
+	if(pCommunication->CurrentFrame.State != REQUEST_COMPLETE){
+		//receive interrupt enqueues to the same queue, so interrupts are disabled for the time of dequeuing
+		uint32_t primask = __get_PRIMASK();
+		__disable_irq();
+		if(__bytes_before_error(pCommunication, 1) > 0){
+			dequeue_status = UART_Queue_Dequeue_Stamped(&pCommunication->ReadBytesQueue, &data, &timestamp);
+			if(dequeue_status == QUEUE_OK)
+				pCommunication->RxDequeued++;
+		}
+		__set_PRIMASK(primask);
+	}
+
 	//try to dequeue one byte from queue
-	if(UART_Queue_Dequeue(&pCommunication->ReadBytesQueue, &data) == QUEUE_OK){
+	if(dequeue_status == QUEUE_OK){
 		if(data == pCommunication->FrameStartByte){
 			//if we have received frame start we cant update state of the current frame to next stage
 			if(pCommunication->CurrentFrame.State != REQUEST_EMPTY){
+				pCommunication->Statistics.Resyncs++;
 				//clean up if something went wrong
 				free(pCommunication->CurrentFrame.pPayload);
 				__uart_frame_init(&pCommunication->CurrentFrame);
 			}
 			pCommunication->CurrentFrame.State = WAITING_FOR_ID;
+			pCommunication->CurrentFrame.FirstByteCycle = timestamp;
+		} else if(data == UART_COMMUNICATION_ESCAPE_BYTE && !pCommunication->CurrentFrame.Escaped
+				&& pCommunication->CurrentFrame.State != REQUEST_EMPTY){
+			//next byte of the frame is escaped, state doesn't change
+			pCommunication->CurrentFrame.Escaped = true;
 		} else {
+			if(pCommunication->CurrentFrame.Escaped){
+				data ^= UART_COMMUNICATION_ESCAPE_XOR;
+				pCommunication->CurrentFrame.Escaped = false;
+			}
 			switch (pCommunication->CurrentFrame.State){
 				case WAITING_FOR_ID:
 					//we have received ID of the frame
@@ -85,22 +240,43 @@ UART_CommunicationStatusTypeDef UART_Communication_Update(UART_CommunicationType
 					if(__find_callback(pCommunication, pCommunication->CurrentFrame.ID, &index) == COMMUNICATION_OK){
 						//if we have found callback we can assign it in current structure
 						pCommunication->CurrentFrame.pCallback = pCommunication->pRegisteredCallbacks[index].pCallback;
+						pCommunication->CurrentFrame.CallbackIndex = index;
 					}
 					pCommunication->CurrentFrame.State++; //progress to next state
 					break;
 				case WAITING_FOR_LEN:
 					//we have received length of the payload
 					pCommunication->CurrentFrame.FinalLength = data;
+					//callback doesn't accept this length, payload is skipped as if nobody registered the ID
+					if(pCommunication->CurrentFrame.pCallback != NULL){
+						const UART_CallbackTypeDef* pRegistered = &pCommunication->pRegisteredCallbacks[pCommunication->CurrentFrame.CallbackIndex];
+						if(data < pRegistered->MinLength || data > pRegistered->MaxLength){
+							pCommunication->CurrentFrame.pCallback = NULL;
+							pCommunication->CurrentFrame.LengthError = true;
+						}
+					}
+					//frame without payload is already complete, there is nothing to allocate
+					if(pCommunication->CurrentFrame.FinalLength == 0){
+						pCommunication->CurrentFrame.State = REQUEST_COMPLETE;
+						break;
+					}
+					//nobody will read the payload, it is only counted (and skipped by __skip_bytes())
+					if(pCommunication->CurrentFrame.pCallback == NULL && pCommunication->CurrentFrame.ID < UART_COMMUNICATION_RESERVED_ID_FIRST){
+						pCommunication->CurrentFrame.State++;
+						break;
+					}
 					//we can allocate memory to store whole payload
 					pCommunication->CurrentFrame.pPayload = malloc(sizeof(uint8_t)*pCommunication->CurrentFrame.FinalLength);
 					if(pCommunication->CurrentFrame.pPayload == NULL){
+						pCommunication->Statistics.MallocErrors++;
 						return COMMUNICATION_MALLOC_ERROR;
 					}
 					pCommunication->CurrentFrame.State++; //progress to next state
 					break;
 				case WAITING_FOR_PAYLOAD:
 					//we have received one byte of payload
-					pCommunication->CurrentFrame.pPayload[pCommunication->CurrentFrame.CurrentLength] = data;
+					if(pCommunication->CurrentFrame.pPayload != NULL)
+						pCommunication->CurrentFrame.pPayload[pCommunication->CurrentFrame.CurrentLength] = data;
 					pCommunication->CurrentFrame.CurrentLength++;
 
 					//we can progress to next stage only if we have received whole payload
@@ -109,25 +285,61 @@ UART_CommunicationStatusTypeDef UART_Communication_Update(UART_CommunicationType
 					break;
 				default:
 					//something went wrong, probably bad data
+					pCommunication->Statistics.UnknownBytes++;
 					return COMMUNICATION_UNKNOWN_DATA;
 					break;
 			}
+
+			//this byte has completed the frame
+			if(pCommunication->CurrentFrame.State == REQUEST_COMPLETE){
+				pCommunication->CurrentFrame.LastByteCycle = timestamp;
+				pCommunication->CurrentFrame.ParsedCycle = Cycle_Counter_Get();
+			}
 		}
 	};
 
 	//check if current frame is complete
 	if(pCommunication->CurrentFrame.State == REQUEST_COMPLETE){
+		uint8_t trace_flags = 0;
+		uint32_t dispatch_cycle = Cycle_Counter_Get();
+
 		//if true, we have to check if we have found suitable callback for the request
 		if(pCommunication->CurrentFrame.pCallback != NULL){
 			//we can call the callback
+			PROFILER_BEGIN(FRAME_CALLBACK);
 			pCommunication->CurrentFrame.pCallback(pCommunication->CurrentFrame.FinalLength, pCommunication->CurrentFrame.pPayload);
-			//we need to free data allocated when we received length of the callback
-			free(pCommunication->CurrentFrame.pPayload);
+			PROFILER_END(FRAME_CALLBACK);
+			trace_flags = UART_TRACE_FLAG_CALLBACK;
+
+			//callback could have rejected length which depends on the payload
+			if(pCommunication->CurrentFrame.LengthError){
+				pCommunication->Statistics.FramesBadLength++;
+			} else {
+				pCommunication->Statistics.FramesDispatched++;
+				pCommunication->pRegisteredCallbacks[pCommunication->CurrentFrame.CallbackIndex].DispatchCount++;
+			}
+		} else if(pCommunication->CurrentFrame.ID >= UART_COMMUNICATION_RESERVED_ID_FIRST){
+			//frame is handled by library itself
+			__handle_reserved_frame(pCommunication);
+			trace_flags = UART_TRACE_FLAG_RESERVED;
+		} else if(pCommunication->CurrentFrame.LengthError){
+			pCommunication->Statistics.FramesBadLength++;
+		} else {
+			pCommunication->Statistics.FramesWithoutCallback++;
 		}
+		__trace_record(pCommunication, trace_flags, dispatch_cycle, Cycle_Counter_Get());
+
+		//we need to free data allocated when we received length of the frame,
+		//also when nobody was interested in it
+		free(pCommunication->CurrentFrame.pPayload);
 		//we have completed the request => we can restore current frame to default state
 		__uart_frame_init(&pCommunication->CurrentFrame);
 	}
 
+	//generated stream continues when transmission has made space for the next frame
+	if(pCommunication->Source.Remaining > 0)
+		__source_update(pCommunication);
+
 	//this if checks if we need to start transmission,
 	//we need to call this function only once per transmission,
 	//because next time it will be called in "interrupts chain"
@@ -156,6 +368,10 @@ UART_CommunicationStatusTypeDef UART_Communication_Clean(UART_CommunicationTypeD
 
 	free(pCommunication->pRegisteredCallbacks);
 
+	//frame which was being received has its payload allocated
+	free(pCommunication->CurrentFrame.pPayload);
+	__uart_frame_init(&pCommunication->CurrentFrame);
+
 	return COMMUNICATION_OK;
 }
 
@@ -164,8 +380,20 @@ UART_CommunicationStatusTypeDef UART_Communication_Receive_Interrupt_Callback(UA
 	if(pCommunication == NULL)
 			return COMMUNICATION_NULL_ERROR;
 
-	if(UART_Queue_Enqueue(&pCommunication->ReadBytesQueue, pCommunication->ReceivedByte) != QUEUE_OK){
-		return COMMUNICATION_QUEUE_FAILED;
+	pCommunication->Statistics.RxBytes++;
+
+	//byte is stamped with the time of reception, so latency of the whole frame can be traced
+	UART_QueueStatusTypeDef status = UART_Queue_Enqueue_Stamped(&pCommunication->ReadBytesQueue, pCommunication->ReceivedByte, Cycle_Counter_Get());
+	pCommunication->RxLastByteEnqueued = status == QUEUE_OK;
+	if(status == QUEUE_OK){
+		pCommunication->RxEnqueued++;
+		if(pCommunication->ReadBytesQueue.Size > pCommunication->Statistics.ReadQueueHighWater)
+			pCommunication->Statistics.ReadQueueHighWater = pCommunication->ReadBytesQueue.Size;
+	} else {
+		//byte is lost, but reading chain has to be continued
+		pCommunication->Statistics.RxBytesDiscarded++;
+		if(status == QUEUE_FAILED_TO_MALLOC)
+			pCommunication->Statistics.MallocErrors++;
 	}
 
 	//Start next read, when reading has ended this callback should be called again
@@ -180,12 +408,12 @@ UART_CommunicationStatusTypeDef UART_Communication_Transmit_Interrupt_Callback(U
 	if(pCommunication == NULL)
 			return COMMUNICATION_NULL_ERROR;
 
-	uint8_t byte;
 	//try dequeuing one byte
-	if(UART_Queue_Dequeue(&pCommunication->WriteBytesQueue, &byte) == QUEUE_OK){
+	if(UART_Queue_Dequeue(&pCommunication->WriteBytesQueue, &pCommunication->TransmittedByte) == QUEUE_OK){
 		//send one byte
-		if(HAL_UART_Transmit_IT(pCommunication->HAL_UART_Handle, &byte, 1) != HAL_OK)
+		if(HAL_UART_Transmit_IT(pCommunication->HAL_UART_Handle, &pCommunication->TransmittedByte, 1) != HAL_OK)
 			return COMMUNICATION_HAL_ERROR;
+		pCommunication->Statistics.TxBytes++;
 	} else {
 		//that means that queue is empty, all bytes send, transmission has ended
 		pCommunication->Transsmision = false;
@@ -194,6 +422,64 @@ UART_CommunicationStatusTypeDef UART_Communication_Transmit_Interrupt_Callback(U
 	return COMMUNICATION_OK;
 }
 
+/*
+ * Called from HAL_UART_ErrorCallback(), HAL stores flags of all errors which occurred in ErrorCode.
+ * On overrun HAL aborts the reception, so the reading chain is started again here,
+ * other errors leave the reception running and HAL_UART_Receive_IT() only returns HAL_BUSY
+ * */
+UART_CommunicationStatusTypeDef UART_Communication_Error_Interrupt_Callback(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	UART_HandleTypeDef* huart = pCommunication->HAL_UART_Handle;
+	uint32_t error = huart->ErrorCode;
+
+	//HAL_UART_IRQHandler() has cleared the flags already, but bytes received since reception was aborted
+	//set overrun again, it would raise another error interrupt right after re-arming
+	__HAL_UART_CLEAR_FLAG(huart, UART_CLEAR_PEF | UART_CLEAR_FEF | UART_CLEAR_NEF | UART_CLEAR_OREF);
+
+	if(error & HAL_UART_ERROR_ORE)
+		pCommunication->Statistics.OverrunErrors++;
+	if(error & HAL_UART_ERROR_FE)
+		pCommunication->Statistics.FramingErrors++;
+	if(error & HAL_UART_ERROR_NE)
+		pCommunication->Statistics.NoiseErrors++;
+	if(error & HAL_UART_ERROR_PE)
+		pCommunication->Statistics.ParityErrors++;
+
+	//parser drops the frame containing the bytes enqueued before this point (see __drop_damaged_bytes()),
+	//overrun loses bytes after the last enqueued one, other errors damaged the last enqueued byte itself,
+	//so it must not complete a frame (parser hasn't taken it, HAL calls this right after RxISR)
+	uint32_t position = pCommunication->RxEnqueued;
+	if((error & (HAL_UART_ERROR_FE | HAL_UART_ERROR_NE | HAL_UART_ERROR_PE))
+			&& pCommunication->RxLastByteEnqueued && position != pCommunication->RxDequeued)
+		position--;
+	if(!pCommunication->RxErrorPending){
+		pCommunication->RxErrorFirst = position;
+		pCommunication->RxErrorPending = true;
+	}
+	pCommunication->RxErrorLast = pCommunication->RxEnqueued;
+
+	HAL_StatusTypeDef status = HAL_UART_Receive_IT(huart, &pCommunication->ReceivedByte, 1);
+	if(status != HAL_OK && status != HAL_BUSY)
+		return COMMUNICATION_HAL_ERROR;
+
+	return COMMUNICATION_OK;
+}
+
+UART_CommunicationStatusTypeDef UART_Communication_Get_Statistics(UART_CommunicationTypeDef* pCommunication, UART_StatisticsTypeDef* pStatistics){
+	if(pCommunication == NULL || pStatistics == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	//counters are updated in interrupts, copy them all at once
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+	memcpy(pStatistics, &pCommunication->Statistics, sizeof(UART_StatisticsTypeDef));
+	__set_PRIMASK(primask);
+
+	return COMMUNICATION_OK;
+}
+
 /*Definition of __io_putchar(int ch) function from syscalls.c files, enables us to use printf to wrtie to uart*/
 UART_CommunicationStatusTypeDef UART_Communication__io_put_char(UART_CommunicationTypeDef* pCommunication, int ch){
 	if(pCommunication == NULL)
@@ -202,15 +488,78 @@ UART_CommunicationStatusTypeDef UART_Communication__io_put_char(UART_Communicati
 	//fix, for some terminals we have to set \r before \n for proper new line,
 	if(ch == '\n'){
 		uint8_t ch2 = '\r';
-		if(UART_Queue_Enqueue(&pCommunication->WriteBytesQueue, (uint8_t)ch2) != QUEUE_OK){
+		if(__enqueue_write_byte(pCommunication, ch2) != QUEUE_OK){
 			return COMMUNICATION_QUEUE_FAILED;
 		}
 	}
 
 	//try to enqueue byte to writing queue
-	if(UART_Queue_Enqueue(&pCommunication->WriteBytesQueue, (uint8_t)ch) != QUEUE_OK){
+	if(__enqueue_write_byte(pCommunication, (uint8_t)ch) != QUEUE_OK){
+		return COMMUNICATION_QUEUE_FAILED;
+	}
+	return COMMUNICATION_OK;
+}
+
+UART_CommunicationStatusTypeDef UART_Communication_Transmit_Frame(UART_CommunicationTypeDef* pCommunication, uint8_t ID, uint8_t len, uint8_t* payload){
+	if(pCommunication == NULL || (payload == NULL && len > 0))
+			return COMMUNICATION_NULL_ERROR;
+
+	//receiver can't do anything with half of the frame, so we either enqueue it whole or not at all,
+	//free space can only grow in the meantime, because transmit interrupt only dequeues
+	uint32_t size = __frame_size(pCommunication, ID, len, payload);
+	if(pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE - pCommunication->WriteBytesQueue.Size < size){
+		pCommunication->Statistics.TxBytesDiscarded += size;
 		return COMMUNICATION_QUEUE_FAILED;
 	}
+
+	if(__enqueue_write_byte(pCommunication, pCommunication->FrameStartByte) != QUEUE_OK)
+		return COMMUNICATION_QUEUE_FAILED;
+	if(__enqueue_frame_byte(pCommunication, ID) != QUEUE_OK)
+		return COMMUNICATION_QUEUE_FAILED;
+	if(__enqueue_frame_byte(pCommunication, len) != QUEUE_OK)
+		return COMMUNICATION_QUEUE_FAILED;
+
+	for(uint8_t i = 0; i < len; i++){
+		if(__enqueue_frame_byte(pCommunication, payload[i]) != QUEUE_OK)
+			return COMMUNICATION_QUEUE_FAILED;
+	}
+
+	return COMMUNICATION_OK;
+}
+
+uint32_t UART_Communication_Escaped_Size(UART_CommunicationTypeDef* pCommunication, const uint8_t* data, uint32_t size){
+	uint32_t escaped = size;
+	for(uint32_t i = 0; i < size; i++)
+		escaped += __needs_escape(pCommunication, data[i]);
+	return escaped;
+}
+
+UART_CommunicationStatusTypeDef UART_Communication_Is_Idle(UART_CommunicationTypeDef* pCommunication, bool* pIdle){
+	if(pCommunication == NULL || pIdle == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	(*pIdle) = true;
+
+	//received bytes are waiting to be processed
+	if(pCommunication->ReadBytesQueue.Size > 0)
+		(*pIdle) = false;
+
+	//complete frame is waiting for its callback
+	if(pCommunication->CurrentFrame.State == REQUEST_COMPLETE)
+		(*pIdle) = false;
+
+	//transmission has to be started from main loop
+	if(pCommunication->Transsmision == false && pCommunication->WriteBytesQueue.Size > 0)
+		(*pIdle) = false;
+
+	//next generated frame fits in the write queue, when it doesn't transmit interrupt will wake the core
+	UART_SourceTypeDef* pSource = &pCommunication->Source;
+	if(pSource->Remaining > 0){
+		uint32_t len = pSource->Remaining < pSource->FrameLength ? pSource->Remaining : pSource->FrameLength;
+		if(pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE - pCommunication->WriteBytesQueue.Size >= len + UART_SOURCE_FRAME_OVERHEAD)
+			(*pIdle) = false;
+	}
+
 	return COMMUNICATION_OK;
 }
 
@@ -232,6 +581,232 @@ UART_CommunicationStatusTypeDef __find_callback(UART_CommunicationTypeDef* pComm
 	return COMMUNICATION_CALLBACK_NOT_FOUND;
 }
 
+UART_CommunicationStatusTypeDef __handle_reserved_frame(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	UART_FrameTypeDef* pFrame = &pCommunication->CurrentFrame;
+
+	switch(pFrame->ID){
+		case UART_COMMUNICATION_STATISTICS_ID: {
+			//all counters are 32bit, so structure has no padding and can be sent as it is
+			_Static_assert(sizeof(UART_StatisticsTypeDef) % sizeof(uint32_t) == 0, "UART_StatisticsTypeDef must contain only 32bit fields");
+
+			UART_StatisticsTypeDef statistics;
+			uint8_t* payload = communication_payload;
+			uint8_t len = sizeof(UART_StatisticsTypeDef);
+			UART_Communication_Get_Statistics(pCommunication, &statistics);
+			memcpy(payload, &statistics, sizeof(statistics));
+
+			//append dispatch counter of every registered ID, as much as fits in one frame
+			for(uint8_t i = 0; i < pCommunication->RegisteredCallbacksCount && len + 5U <= UART_PAYLOAD_LENGTH_MAX; i++){
+				uint32_t count = pCommunication->pRegisteredCallbacks[i].DispatchCount;
+				payload[len++] = pCommunication->pRegisteredCallbacks[i].ID;
+				memcpy(&payload[len], &count, sizeof(count));
+				len += sizeof(count);
+			}
+
+			//optional first byte of the payload requests clearing counters after they are sent
+			if(pFrame->FinalLength > 0 && pFrame->pPayload[0] != 0){
+				uint32_t primask = __get_PRIMASK();
+				__disable_irq();
+				memset(&pCommunication->Statistics, 0, sizeof(UART_StatisticsTypeDef));
+				__set_PRIMASK(primask);
+				for(uint8_t i = 0; i < pCommunication->RegisteredCallbacksCount; i++)
+					pCommunication->pRegisteredCallbacks[i].DispatchCount = 0;
+			}
+
+			return UART_Communication_Transmit_Frame(pCommunication, pFrame->ID, len, payload);
+		}
+		case UART_COMMUNICATION_TRACE_ID: {
+			//payload: page(u8), page count(u8), SystemCoreClock(u32), records oldest first
+			_Static_assert(sizeof(UART_TraceRecordTypeDef) == 28U, "UART_TraceRecordTypeDef must not have padding");
+			_Static_assert(6U + UART_TRACE_RECORDS_PER_PAGE*sizeof(UART_TraceRecordTypeDef) <= UART_PAYLOAD_LENGTH_MAX, "trace page must fit in one frame");
+			uint8_t* payload = communication_payload;
+
+			UART_TraceTypeDef* pTrace = &pCommunication->Trace;
+			uint32_t available = pTrace->Count < UART_TRACE_DEPTH ? pTrace->Count : UART_TRACE_DEPTH;
+			uint32_t oldest = pTrace->Count - available;
+			uint8_t page_count = (available + UART_TRACE_RECORDS_PER_PAGE - 1U) / UART_TRACE_RECORDS_PER_PAGE;
+			uint8_t page = pFrame->FinalLength > 0 ? pFrame->pPayload[0] : 0;
+
+			payload[0] = page;
+			payload[1] = page_count;
+			memcpy(&payload[2], &SystemCoreClock, sizeof(uint32_t));
+			uint8_t len = 6U;
+
+			for(uint32_t i = (uint32_t)page*UART_TRACE_RECORDS_PER_PAGE; i < available && i < (page + 1U)*UART_TRACE_RECORDS_PER_PAGE; i++){
+				memcpy(&payload[len], &pTrace->Records[(oldest + i) % UART_TRACE_DEPTH], sizeof(UART_TraceRecordTypeDef));
+				len += sizeof(UART_TraceRecordTypeDef);
+			}
+
+			return UART_Communication_Transmit_Frame(pCommunication, pFrame->ID, len, payload);
+		}
+		case UART_COMMUNICATION_ECHO_ID:
+			return UART_Communication_Transmit_Frame(pCommunication, pFrame->ID, pFrame->FinalLength, pFrame->pPayload);
+		case UART_COMMUNICATION_SINK_ID:
+			pCommunication->Statistics.SinkFrames++;
+			pCommunication->Statistics.SinkBytes += pFrame->FinalLength;
+			return COMMUNICATION_OK;
+		case UART_COMMUNICATION_SOURCE_ID: {
+			//new request replaces stream which is still being generated, request without total stops it
+			UART_SourceTypeDef* pSource = &pCommunication->Source;
+			pSource->Remaining = 0;
+			pSource->Offset = 0;
+			pSource->FrameLength = UART_SOURCE_DEFAULT_LENGTH;
+			if(pFrame->FinalLength >= sizeof(uint32_t))
+				memcpy(&pSource->Remaining, pFrame->pPayload, sizeof(uint32_t));
+			if(pFrame->FinalLength > sizeof(uint32_t) && pFrame->pPayload[sizeof(uint32_t)] != 0)
+				pSource->FrameLength = pFrame->pPayload[sizeof(uint32_t)];
+			//whole frame has to fit in the write queue
+			if(pSource->FrameLength + UART_SOURCE_FRAME_OVERHEAD > pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE)
+				pSource->FrameLength = pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE > UART_SOURCE_FRAME_OVERHEAD ?
+						(uint8_t)(pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE - UART_SOURCE_FRAME_OVERHEAD) : 0U;
+			if(pSource->FrameLength == 0)
+				pSource->Remaining = 0;
+
+			return __source_update(pCommunication);
+		}
+		default:
+			//reserved ID which is not used (yet)
+			pCommunication->Statistics.FramesWithoutCallback++;
+			return COMMUNICATION_CALLBACK_NOT_FOUND;
+	}
+}
+
+UART_CommunicationStatusTypeDef __skip_bytes(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	UART_FrameTypeDef* pFrame = &pCommunication->CurrentFrame;
+	uint32_t skipped = 0;
+	uint32_t timestamp = 0;
+	uint32_t primask;
+
+	switch(pFrame->State){
+		case REQUEST_EMPTY:
+			//noise or foreign traffic, everything up to the next frame start
+			primask = __get_PRIMASK();
+			__disable_irq();
+			UART_Queue_Skip_Until(&pCommunication->ReadBytesQueue, pCommunication->FrameStartByte,
+					__bytes_before_error(pCommunication, UINT32_MAX), &skipped, NULL);
+			pCommunication->RxDequeued += skipped;
+			__set_PRIMASK(primask);
+
+			if(skipped == 0)
+				return COMMUNICATION_OK;
+			pCommunication->Statistics.UnknownBytes += skipped;
+			return COMMUNICATION_UNKNOWN_DATA;
+		case WAITING_FOR_PAYLOAD:
+			//only payload which is not stored, frame start still restarts the frame,
+			//escaped byte is counted as one byte of payload by UART_Communication_Update()
+			if(pFrame->pPayload != NULL || pFrame->Escaped)
+				return COMMUNICATION_OK;
+
+			primask = __get_PRIMASK();
+			__disable_irq();
+			UART_Queue_Skip_Until_Either(&pCommunication->ReadBytesQueue, pCommunication->FrameStartByte, UART_COMMUNICATION_ESCAPE_BYTE,
+					__bytes_before_error(pCommunication, (uint32_t)(pFrame->FinalLength - pFrame->CurrentLength)), &skipped, &timestamp);
+			pCommunication->RxDequeued += skipped;
+			__set_PRIMASK(primask);
+
+			pFrame->CurrentLength += skipped;
+			if(skipped > 0 && pFrame->CurrentLength == pFrame->FinalLength){
+				pFrame->State = REQUEST_COMPLETE;
+				pFrame->LastByteCycle = timestamp;
+				pFrame->ParsedCycle = Cycle_Counter_Get();
+			}
+			return COMMUNICATION_OK;
+		default:
+			return COMMUNICATION_OK;
+	}
+}
+
+UART_CommunicationStatusTypeDef __drop_damaged_bytes(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	uint32_t primask = __get_PRIMASK();
+	__disable_irq();
+
+	if(!pCommunication->RxErrorPending || pCommunication->RxDequeued != pCommunication->RxErrorFirst){
+		__set_PRIMASK(primask);
+		return COMMUNICATION_OK;
+	}
+
+	//bytes between the first and the last error can't be trusted, even if they look like complete frames
+	uint32_t discarded = 0;
+	uint8_t data;
+	while(pCommunication->RxDequeued != pCommunication->RxErrorLast
+			&& UART_Queue_Dequeue(&pCommunication->ReadBytesQueue, &data) == QUEUE_OK){
+		pCommunication->RxDequeued++;
+		discarded++;
+	}
+	pCommunication->Statistics.RxBytesDiscarded += discarded;
+	pCommunication->RxErrorPending = false;
+
+	__set_PRIMASK(primask);
+
+	//frame completed before the error is still valid
+	UART_FrameTypeDef* pFrame = &pCommunication->CurrentFrame;
+	if(pFrame->State != REQUEST_EMPTY && pFrame->State != REQUEST_COMPLETE){
+		pCommunication->Statistics.ErrorFramesDropped++;
+		free(pFrame->pPayload);
+		__uart_frame_init(pFrame);
+	}
+
+	return COMMUNICATION_OK;
+}
+
+UART_CommunicationStatusTypeDef __source_update(UART_CommunicationTypeDef* pCommunication){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	UART_SourceTypeDef* pSource = &pCommunication->Source;
+	uint8_t* payload = communication_payload;
+
+	while(pSource->Remaining > 0){
+		uint8_t len = pSource->Remaining < pSource->FrameLength ? (uint8_t)pSource->Remaining : pSource->FrameLength;
+		for(uint8_t i = 0; i < len; i++){
+			uint8_t byte = (uint8_t)(pSource->Offset + i);
+			payload[i] = byte == pCommunication->FrameStartByte ? (uint8_t)~byte : byte;
+		}
+		//wait for space instead of letting UART_Communication_Transmit_Frame() discard the frame
+		if(pCommunication->WriteBytesQueue.MAX_QUEUE_SIZE - pCommunication->WriteBytesQueue.Size < __frame_size(pCommunication, UART_COMMUNICATION_SOURCE_ID, len, payload))
+			break;
+		if(UART_Communication_Transmit_Frame(pCommunication, UART_COMMUNICATION_SOURCE_ID, len, payload) != COMMUNICATION_OK)
+			return COMMUNICATION_QUEUE_FAILED;
+
+		pSource->Offset += len;
+		pSource->Remaining -= len;
+	}
+
+	return COMMUNICATION_OK;
+}
+
+UART_CommunicationStatusTypeDef __trace_record(UART_CommunicationTypeDef* pCommunication, uint8_t flags, uint32_t dispatch_cycle, uint32_t return_cycle){
+	if(pCommunication == NULL)
+			return COMMUNICATION_NULL_ERROR;
+
+	UART_FrameTypeDef* pFrame = &pCommunication->CurrentFrame;
+	UART_TraceRecordTypeDef* pRecord = &pCommunication->Trace.Records[pCommunication->Trace.Count % UART_TRACE_DEPTH];
+
+	pRecord->Sequence = pCommunication->Trace.Count;
+	pRecord->ID = pFrame->ID;
+	pRecord->Length = pFrame->FinalLength;
+	pRecord->Flags = flags;
+	pRecord->Reserved = 0;
+	pRecord->FirstByte = pFrame->FirstByteCycle;
+	pRecord->LastByte = pFrame->LastByteCycle;
+	pRecord->Parsed = pFrame->ParsedCycle;
+	pRecord->DispatchStart = dispatch_cycle;
+	pRecord->CallbackReturn = return_cycle;
+
+	pCommunication->Trace.Count++;
+
+	return COMMUNICATION_OK;
+}
+
 UART_CommunicationStatusTypeDef __uart_frame_init(UART_FrameTypeDef* frame){
 	if(frame == NULL)
 		return COMMUNICATION_NULL_ERROR;
@@ -242,6 +817,12 @@ UART_CommunicationStatusTypeDef __uart_frame_init(UART_FrameTypeDef* frame){
 	frame->CurrentLength = 0;
 	frame->pPayload = NULL;
 	frame->pCallback = NULL;
+	frame->CallbackIndex = -1;
+	frame->LengthError = false;
+	frame->Escaped = false;
+	frame->FirstByteCycle = 0;
+	frame->LastByteCycle = 0;
+	frame->ParsedCycle = 0;
 
 	return COMMUNICATION_OK;
 }
@@ -7,43 +7,107 @@
 
 #include "UART_Queue.h"
 
-UART_QueueStatusTypeDef UART_Queue_Init(UART_QueueTypeDef* pQueue, uint32_t max_size){
+#include <string.h>
+
+/*Cortex-M4 compares 4 bytes at once with DSP instructions, other targets (host build) use plain 32bit arithmetic*/
+#if defined(__ARM_FEATURE_SIMD32) && !defined(HOST_BUILD)
+#include "stm32g4xx_hal.h"
+#define UART_QUEUE_SIMD 1
+#endif
+
+/*
+ * @brief Returns mask with 0x80 in every byte of the word equal to value, only the lowest set bit is exact
+ * */
+static inline uint32_t __match_bytes(uint32_t word, uint32_t pattern){
+	//bytes equal to value become zero
+	uint32_t x = word ^ pattern;
+#ifdef UART_QUEUE_SIMD
+	//byte + 0xFF carries (sets GE bit) for every non zero byte, SEL takes 0x00 for them and 0xFF for zero bytes
+	__UADD8(x, 0xFFFFFFFFU);
+	return __SEL(0U, 0x80808080U);
+#else
+	//borrow from subtraction sets the highest bit of zero bytes (and possibly of bytes above them)
+	return (x - 0x01010101U) & ~x & 0x80808080U;
+#endif
+}
+
+/*
+ * @brief Returns index of the first byte equal to value or other in data, or size if there is none
+ * */
+static uint32_t __find_byte(const uint8_t* data, uint32_t size, uint8_t value, uint8_t other){
+	uint32_t i = 0;
+
+	//bytes before the first word boundary
+	while(i < size && ((uintptr_t)&data[i] & 3U) != 0){
+		if(data[i] == value || data[i] == other)
+			return i;
+		i++;
+	}
+
+	uint32_t pattern = value * 0x01010101U;
+	uint32_t other_pattern = other * 0x01010101U;
+	for(; i + 4U <= size; i += 4U){
+		uint32_t word;
+		memcpy(&word, &data[i], sizeof(word));
+		uint32_t matches = __match_bytes(word, pattern) | __match_bytes(word, other_pattern);
+		//little endian, the lowest match is the first byte
+		if(matches != 0)
+			return i + (uint32_t)__builtin_ctz(matches) / 8U;
+	}
+
+	while(i < size && data[i] != value && data[i] != other)
+		i++;
+	return i;
+}
+
+/*
+ * @brief Allocates bytes and, when stamped, timestamps of the queue
+ * */
+static UART_QueueStatusTypeDef __queue_init(UART_QueueTypeDef* pQueue, uint32_t max_size, uint8_t stamped){
 	/*Just set default values to the queue*/
 	pQueue->MAX_QUEUE_SIZE = max_size;
-	pQueue->pFirst = NULL;
-	pQueue->pLast = NULL;
+	pQueue->Head = 0;
 	pQueue->Size = 0;
 
+	/*Memory for all bytes is allocated at once, enqueue never allocates*/
+	pQueue->pBuffer = malloc(max_size > 0 ? max_size : 1U);
+	pQueue->pTimestamps = stamped ? malloc(sizeof(uint32_t) * (max_size > 0 ? max_size : 1U)) : NULL;
+	if(pQueue->pBuffer == NULL || (stamped && pQueue->pTimestamps == NULL)){
+		free(pQueue->pBuffer);
+		free(pQueue->pTimestamps);
+		pQueue->pBuffer = NULL;
+		pQueue->pTimestamps = NULL;
+		pQueue->MAX_QUEUE_SIZE = 0;
+		return QUEUE_FAILED_TO_MALLOC;
+	}
+
 	return QUEUE_OK;
 }
 
+UART_QueueStatusTypeDef UART_Queue_Init(UART_QueueTypeDef* pQueue, uint32_t max_size){
+	return __queue_init(pQueue, max_size, 0);
+}
+
+UART_QueueStatusTypeDef UART_Queue_Init_Stamped(UART_QueueTypeDef* pQueue, uint32_t max_size){
+	return __queue_init(pQueue, max_size, 1);
+}
+
 UART_QueueStatusTypeDef UART_Queue_Enqueue(UART_QueueTypeDef* pQueue, uint8_t byte) {
+	return UART_Queue_Enqueue_Stamped(pQueue, byte, 0);
+}
+
+UART_QueueStatusTypeDef UART_Queue_Enqueue_Stamped(UART_QueueTypeDef* pQueue, uint8_t byte, uint32_t timestamp) {
 	/*if queue is full just return status message*/
 	if (pQueue->Size >= pQueue->MAX_QUEUE_SIZE)
 		return QUEUE_FULL_BYTE_DISCARDED;
 
-	/*Allocate memory for new element*/
-	UART_QueueElementTypeDef* elementToEnqueue = (UART_QueueElementTypeDef*)malloc(sizeof(UART_QueueElementTypeDef));
-
-	/*If pointer is null it means that malloc failed, return message*/
-	if (elementToEnqueue == NULL)
-	  	return QUEUE_FAILED_TO_MALLOC;
-
-	/*Initialize new element*/
-	elementToEnqueue->byte = byte;
-  	elementToEnqueue->pNext = NULL;
-
-  	if (pQueue->Size == 0) {
-  		/*If queue size is 0, pFirst and pLast pointers
-  		 * are set to the pointer of the new element */
-  		pQueue->pFirst = elementToEnqueue;
-  		pQueue->pLast = elementToEnqueue;
-  	} else {
-  		/* pNext pointer of penultimate element is set to new element,
-  		 * pLast pointer is updated */
-  		pQueue->pLast->pNext = elementToEnqueue;
-  		pQueue->pLast = elementToEnqueue;
-  	}
+	/*Store byte right after the last one*/
+	uint32_t index = pQueue->Head + pQueue->Size;
+	if (index >= pQueue->MAX_QUEUE_SIZE)
+		index -= pQueue->MAX_QUEUE_SIZE;
+	pQueue->pBuffer[index] = byte;
+	if (pQueue->pTimestamps != NULL)
+		pQueue->pTimestamps[index] = timestamp;
 
   	/*Increase size of the queue*/
   	pQueue->Size++;
@@ -53,41 +117,75 @@ UART_QueueStatusTypeDef UART_Queue_Enqueue(UART_QueueTypeDef* pQueue, uint8_t by
 }
 
 UART_QueueStatusTypeDef UART_Queue_Dequeue(UART_QueueTypeDef* pQueue, uint8_t* pByte){
+	return UART_Queue_Dequeue_Stamped(pQueue, pByte, NULL);
+}
+
+UART_QueueStatusTypeDef UART_Queue_Dequeue_Stamped(UART_QueueTypeDef* pQueue, uint8_t* pByte, uint32_t* pTimestamp){
 	/*can't dequeue from empty list*/
 	if (pQueue->Size <= 0)
 		return QUEUE_EMPTY;
 
-	/*Store pointer of the first element so it is not lost*/
-	UART_QueueElementTypeDef* elementToDequeue = pQueue->pFirst;
-	/*Read the value of the first element*/
-	uint8_t value = elementToDequeue->byte;
+	/*if pByte is NULL data is discarded*/
+	if(pByte != NULL)
+		(*pByte) = pQueue->pBuffer[pQueue->Head];
+	if(pTimestamp != NULL)
+		(*pTimestamp) = pQueue->pTimestamps != NULL ? pQueue->pTimestamps[pQueue->Head] : 0;
 
-	/*Update pFirst pointer to be pointing to second element*/
-	pQueue->pFirst = elementToDequeue->pNext;
+	/*Move head to the next byte*/
+	pQueue->Head++;
+	if (pQueue->Head == pQueue->MAX_QUEUE_SIZE)
+		pQueue->Head = 0;
 
 	/*Decrease size of the queue*/
 	pQueue->Size--;
 
-	/*if pByte is NULL data is discarded*/
-	if(pByte != NULL)
-		(*pByte) = value;
+	/*everything went well, we can return OK message*/
+	return QUEUE_OK;
+}
 
-	// remove first element
-	free(elementToDequeue);
+UART_QueueStatusTypeDef UART_Queue_Skip_Until(UART_QueueTypeDef* pQueue, uint8_t value, uint32_t max_count, uint32_t* pSkipped, uint32_t* pTimestamp){
+	return UART_Queue_Skip_Until_Either(pQueue, value, value, max_count, pSkipped, pTimestamp);
+}
 
-	/*everything went well, we can return OK message*/
+UART_QueueStatusTypeDef UART_Queue_Skip_Until_Either(UART_QueueTypeDef* pQueue, uint8_t value, uint8_t other, uint32_t max_count, uint32_t* pSkipped, uint32_t* pTimestamp){
+	uint32_t limit = pQueue->Size < max_count ? pQueue->Size : max_count;
+	uint32_t skipped = 0;
+
+	/*Bytes are contiguous up to the end of the buffer, then the rest starts at index 0*/
+	while (skipped < limit) {
+		uint32_t start = pQueue->Head;
+		uint32_t chunk = pQueue->MAX_QUEUE_SIZE - start;
+		if (chunk > limit - skipped)
+			chunk = limit - skipped;
+
+		uint32_t found = __find_byte(&pQueue->pBuffer[start], chunk, value, other);
+		if (found > 0) {
+			if (pTimestamp != NULL)
+				(*pTimestamp) = pQueue->pTimestamps != NULL ? pQueue->pTimestamps[start + found - 1U] : 0;
+			pQueue->Head = start + found == pQueue->MAX_QUEUE_SIZE ? 0 : start + found;
+			pQueue->Size -= found;
+			skipped += found;
+		}
+		/*value or other is in the queue*/
+		if (found < chunk)
+			break;
+	}
+
+	if(pSkipped != NULL)
+		(*pSkipped) = skipped;
 	return QUEUE_OK;
 }
 
 UART_QueueStatusTypeDef UART_Queue_Dispose(UART_QueueTypeDef* pQueue){
-	/*Dequeues elements while queue is not empty*/
-	while (pQueue->Size > 0) {
-		/*check if we managed to dequeued element successfully*/
-		if(UART_Queue_Dequeue(pQueue, NULL) != QUEUE_OK)
-			return QUEUE_FAILED_TO_DISPOSE; //fatal error
-	}
+	/*Stored bytes are lost together with the memory*/
+	free(pQueue->pBuffer);
+	free(pQueue->pTimestamps);
+	pQueue->pBuffer = NULL;
+	pQueue->pTimestamps = NULL;
+	pQueue->MAX_QUEUE_SIZE = 0;
+	pQueue->Head = 0;
+	pQueue->Size = 0;
 
 	/*everything went well, we can return OK message*/
 	return QUEUE_OK;
 }
-
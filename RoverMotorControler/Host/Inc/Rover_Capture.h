@@ -0,0 +1,189 @@
+/*Rover_Capture.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary capture of link traffic (raw RX/TX chunks with timestamps), written by Rover_Gateway (-c option)
+ *
+ * FILE LAYOUT
+ * 1. Rover_CaptureHeaderTypeDef at offset 0, padded to ROVER_CAPTURE_HEADER_SIZE
+ * 2. Blocks of ROVER_CAPTURE_BLOCK_SIZE bytes, block N starts at ROVER_CAPTURE_HEADER_SIZE + N*BlockSize
+ * 		- every block starts with Rover_CaptureBlockTypeDef (timestamps of first and last record, used bytes),
+ * 		  so block headers are the index: reader finds block of given time by binary search without reading records
+ * 		- records (Rover_CaptureRecordTypeDef + data) follow, record never crosses block boundary
+ * 		- rest of the block after Used bytes is unused
+ * All numbers are little endian, timestamps are CLOCK_MONOTONIC nanoseconds (header has matching CLOCK_REALTIME)
+ *
+ * ALGORITHM (writer)
+ * 1. Records are appended to the block in memory
+ * 2. Full block is written at its offset and the next block is started
+ * 3. Rover_Capture_Flush() writes partial block (it is rewritten later when it grows), so after crash
+ *    file contains everything up to the last flush
+ *
+ * ALGORITHM (reader)
+ * 1. Whole file is mapped (mmap) read only, kernel reads it ahead sequentially, nothing is copied
+ * 2. Records are walked block by block, data pointers point into the mapping
+ * */
+#ifndef ROVER_CAPTURE_H_
+#define ROVER_CAPTURE_H_
+
+#define ROVER_CAPTURE_MAGIC "RVRCAP01"
+#define ROVER_CAPTURE_VERSION 1U
+#define ROVER_CAPTURE_HEADER_SIZE 512U
+#define ROVER_CAPTURE_BLOCK_SIZE 65536U
+#define ROVER_CAPTURE_BLOCK_MAGIC 0x4B4C4252U
+#define ROVER_CAPTURE_MAX_LINKS 8U
+#define ROVER_CAPTURE_MAX_NAME 32U
+
+/*Direction of the record, same values as ROVER_CLIENT_RX/ROVER_CLIENT_TX*/
+#define ROVER_CAPTURE_RX 0U
+#define ROVER_CAPTURE_TX 1U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	ROVER_CAPTURE_OK, //Everything fine
+	ROVER_CAPTURE_NULL_ERROR, //pointer passed as an argument was null
+	ROVER_CAPTURE_IO_ERROR, //system call failed, errno is preserved
+	ROVER_CAPTURE_FORMAT_ERROR, //file is not a capture or it is damaged
+	ROVER_CAPTURE_STOP //iteration was stopped by the callback
+} Rover_CaptureStatusTypeDef;
+
+typedef struct {
+	char Magic[8];
+	uint32_t Version;
+	uint32_t BlockSize;
+	//time when capture was started
+	uint64_t StartRealtime;
+	uint64_t StartMonotonic;
+	uint32_t LinkCount;
+	uint32_t Reserved;
+	char LinkNames[ROVER_CAPTURE_MAX_LINKS][ROVER_CAPTURE_MAX_NAME];
+} Rover_CaptureHeaderTypeDef;
+
+typedef struct {
+	uint32_t Magic;
+	//bytes used by block header and records
+	uint32_t Used;
+	uint32_t RecordCount;
+	uint32_t Reserved;
+	uint64_t FirstTimestamp;
+	uint64_t LastTimestamp;
+} Rover_CaptureBlockTypeDef;
+
+/*
+ * Record header, followed by Length bytes of data, packed (12 bytes) so it has to be read with memcpy()
+ * */
+typedef struct __attribute__((packed)) {
+	uint64_t Timestamp;
+	uint8_t Link;
+	uint8_t Direction;
+	uint16_t Length;
+} Rover_CaptureRecordTypeDef;
+
+/*
+ * Writer handle
+ * */
+typedef struct {
+	int Fd;
+	Rover_CaptureHeaderTypeDef Header;
+	//block being filled
+	uint8_t* pBlock;
+	uint64_t BlockIndex;
+
+	//counters
+	uint64_t Records;
+	uint64_t Bytes;
+} Rover_CaptureWriterTypeDef;
+
+/*
+ * Reader handle
+ * */
+typedef struct {
+	const uint8_t* pMap;
+	size_t Size;
+	const Rover_CaptureHeaderTypeDef* pHeader;
+	uint64_t BlockCount;
+} Rover_CaptureReaderTypeDef;
+
+/*
+ * Called for every record, data points into the mapping,
+ * returning non zero stops iteration
+ * */
+typedef int (*Rover_CaptureCallbackTypeDef)(void* pContext, const Rover_CaptureRecordTypeDef* pRecord, const uint8_t* data);
+
+/*
+ * @brief Creates capture file (existing file is truncated)
+ *
+ * @param pWriter pointer to writer handle
+ * @param path path of the file
+ * @param link_count number of links
+ * @param link_names names of the links, index in this array is Link of the record
+ *
+ * @retval Rover_CaptureStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Create(Rover_CaptureWriterTypeDef* pWriter, const char* path, uint32_t link_count, const char* const* link_names);
+
+/*
+ * @brief Appends chunk of traffic, chunk which doesn't fit in the block is split into more records
+ *
+ * @param pWriter pointer to writer handle
+ * @param timestamp CLOCK_MONOTONIC time in nanoseconds
+ * @param link index of the link
+ * @param direction ROVER_CAPTURE_RX or ROVER_CAPTURE_TX
+ * @param data bytes
+ * @param size number of bytes
+ *
+ * @retval Rover_CaptureStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Write(Rover_CaptureWriterTypeDef* pWriter, uint64_t timestamp, uint8_t link, uint8_t direction, const uint8_t* data, size_t size);
+
+/*
+ * @brief Writes partial block to the file
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Flush(Rover_CaptureWriterTypeDef* pWriter);
+
+/*
+ * @brief Flushes and closes the file
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Close(Rover_CaptureWriterTypeDef* pWriter);
+
+/*
+ * @brief Maps capture file and checks its header
+ *
+ * @param pReader pointer to reader handle
+ * @param path path of the file
+ *
+ * @retval Rover_CaptureStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Map(Rover_CaptureReaderTypeDef* pReader, const char* path);
+
+/*
+ * @brief Finds first block which can contain records at or after timestamp (binary search over block headers)
+ *
+ * @param pReader pointer to reader handle
+ * @param timestamp CLOCK_MONOTONIC time in nanoseconds
+ *
+ * @retval index of the block
+ * */
+extern uint64_t Rover_Capture_Find_Block(const Rover_CaptureReaderTypeDef* pReader, uint64_t timestamp);
+
+/*
+ * @brief Calls callback for every record starting at the block
+ *
+ * @param pReader pointer to reader handle
+ * @param first_block index of the first block
+ * @param pCallback called for every record
+ * @param pContext passed to the callback
+ *
+ * @retval Rover_CaptureStatusTypeDef ROVER_CAPTURE_OK, ROVER_CAPTURE_STOP or ROVER_CAPTURE_FORMAT_ERROR (damaged block)
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Iterate(const Rover_CaptureReaderTypeDef* pReader, uint64_t first_block, Rover_CaptureCallbackTypeDef pCallback, void* pContext);
+
+/*
+ * @brief Unmaps capture file
+ * */
+extern Rover_CaptureStatusTypeDef Rover_Capture_Unmap(Rover_CaptureReaderTypeDef* pReader);
+
+#endif
@@ -0,0 +1,199 @@
+/*Rover_Client.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Rover_Frame.h"
+
+/*
+ * Host side client of RoverMotorControler, talks to the firmware (or virtual rover) over serial fd
+ *
+ * ALGORITHM
+ * 1. Rover_Client_Open() opens serial port (or pty) in raw, non-blocking mode and registers it in epoll
+ * 2. Frames are encoded straight into transmit buffer:
+ * 		- Rover_Client_Reserve() writes header and returns pointer to payload space in the buffer,
+ * 		  caller fills payload in place and calls Rover_Client_Commit(), which escapes the frame in place
+ * 		  (space for escaping every byte is reserved)
+ * 		- Rover_Client_Send() does the same for payload which is already in memory
+ *    nothing is written to fd yet, so any number of frames can be queued (pipelined) without waiting for responses
+ * 3. Rover_Client_Poll() waits for fd to become readable/writable:
+ * 		- writes as much of the transmit buffer as fd accepts
+ * 		- reads all available bytes and passes them to the decoder, which calls frame callback
+ *    EPOLLOUT is requested only when fd didn't accept everything, so idle client sleeps in epoll_wait()
+ * 4. Program with its own event loop (many fds) calls Rover_Client_Attach() and passes events
+ *    of the fd to Rover_Client_Process(), frames are then written only when it asks for it (EPOLLOUT)
+ * */
+#ifndef ROVER_CLIENT_H_
+#define ROVER_CLIENT_H_
+
+/*Size of transmit and receive buffers*/
+#define ROVER_CLIENT_BUFFER_SIZE 65536U
+
+/*Direction of bytes passed to the tap*/
+#define ROVER_CLIENT_RX 0U
+#define ROVER_CLIENT_TX 1U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	ROVER_CLIENT_OK, //Everything fine
+	ROVER_CLIENT_NULL_ERROR, //pointer passed as an argument was null
+	ROVER_CLIENT_IO_ERROR, //system call failed, errno is preserved
+	ROVER_CLIENT_BUFFER_FULL, //frame doesn't fit in transmit buffer, Poll() has to send some data first
+	ROVER_CLIENT_TIMEOUT, //nothing happened before timeout
+	ROVER_CLIENT_CLOSED //other side closed the connection
+} Rover_ClientStatusTypeDef;
+
+/*
+ * Called with raw bytes right after they were read from or written to fd
+ * */
+typedef void (*Rover_ClientTapTypeDef)(void* pContext, uint8_t direction, const uint8_t* data, size_t size);
+
+/*
+ * Client handle, it is big (buffers), so it should be static or allocated
+ * */
+typedef struct {
+	int Fd;
+	int EpollFd;
+	//epoll instance was created by Rover_Client_Open() (not attached)
+	uint8_t OwnsEpoll;
+	//value of epoll_event.data.u64 of the fd
+	uint64_t Token;
+	//EPOLLOUT is currently requested
+	uint8_t WaitingForWrite;
+
+	//bytes [TxStart, TxEnd) are waiting to be written, [TxEnd, TxReserved) belong to reserved frame
+	uint8_t TxBuffer[ROVER_CLIENT_BUFFER_SIZE];
+	size_t TxStart;
+	size_t TxEnd;
+	size_t TxReserved;
+
+	uint8_t RxBuffer[ROVER_CLIENT_BUFFER_SIZE];
+
+	Rover_DecoderTypeDef Decoder;
+
+	//optional observer of raw traffic (recorder)
+	Rover_ClientTapTypeDef pTap;
+	void* pTapContext;
+
+	//counters
+	uint64_t TxBytes;
+	uint64_t RxBytes;
+	uint64_t TxFrames;
+} Rover_ClientTypeDef;
+
+/*
+ * @brief Opens serial port and initializes client
+ *
+ * @param pClient pointer to client handle
+ * @param path path of the serial port or pty
+ * @param baud baud rate, 0 keeps current setting (pty)
+ * @param pCallback called for every received frame
+ * @param pContext passed to the callback
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Open(Rover_ClientTypeDef* pClient, const char* path, uint32_t baud, Rover_FrameCallbackTypeDef pCallback, void* pContext);
+
+/*
+ * @brief Moves fd from epoll instance of the client to epoll instance of the caller
+ *
+ * @param pClient pointer to client handle
+ * @param epoll_fd epoll instance of the caller
+ * @param token value of epoll_event.data.u64 reported for the fd
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Attach(Rover_ClientTypeDef* pClient, int epoll_fd, uint64_t token);
+
+/*
+ * @brief Handles events reported by epoll for the fd: reads and decodes (EPOLLIN), writes (EPOLLOUT),
+ * passing EPOLLOUT without epoll event writes queued frames right now
+ *
+ * @param pClient pointer to client handle
+ * @param events epoll events of the fd
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Process(Rover_ClientTypeDef* pClient, uint32_t events);
+
+/*
+ * @brief Sets observer of raw traffic, NULL removes it
+ *
+ * @param pClient pointer to client handle
+ * @param pTap called for every chunk of bytes read or written
+ * @param pContext passed to the tap
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Set_Tap(Rover_ClientTypeDef* pClient, Rover_ClientTapTypeDef pTap, void* pContext);
+
+/*
+ * @brief Reserves space for one frame in transmit buffer
+ *
+ * @param pClient pointer to client handle
+ * @param ID ID of the frame
+ * @param len length of the payload
+ * @param ppPayload pointer where address of payload space is written, valid until Commit()
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Reserve(Rover_ClientTypeDef* pClient, uint8_t ID, uint8_t len, uint8_t** ppPayload);
+
+/*
+ * @brief Escapes reserved frame and marks it as ready to be sent, it is written by next Poll()/Process()
+ *
+ * @param pClient pointer to client handle
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Commit(Rover_ClientTypeDef* pClient);
+
+/*
+ * @brief Queues one frame, payload is copied to transmit buffer
+ *
+ * @param pClient pointer to client handle
+ * @param ID ID of the frame
+ * @param len length of the payload
+ * @param payload pointer to the payload (can be NULL when len is 0)
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Send(Rover_ClientTypeDef* pClient, uint8_t ID, uint8_t len, const uint8_t* payload);
+
+/*
+ * @brief Writes queued frames and reads received frames, callback is called from this function,
+ * it waits on epoll instance of the client, so it can't be used after Rover_Client_Attach()
+ *
+ * @param pClient pointer to client handle
+ * @param timeout_ms max time to wait for fd (-1 waits forever, 0 doesn't wait)
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Poll(Rover_ClientTypeDef* pClient, int timeout_ms);
+
+/*
+ * @brief Polls until all queued frames are written
+ *
+ * @param pClient pointer to client handle
+ * @param timeout_ms max time to wait for a single Poll()
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Flush(Rover_ClientTypeDef* pClient, int timeout_ms);
+
+/*
+ * @brief Returns number of bytes waiting to be written (reserved frame is not counted)
+ * */
+extern size_t Rover_Client_Tx_Pending(Rover_ClientTypeDef* pClient);
+
+/*
+ * @brief Closes fd and epoll instance
+ *
+ * @param pClient pointer to client handle
+ *
+ * @retval Rover_ClientStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_ClientStatusTypeDef Rover_Client_Close(Rover_ClientTypeDef* pClient);
+
+#endif
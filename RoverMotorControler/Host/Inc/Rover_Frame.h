@@ -0,0 +1,143 @@
+/*Rover_Frame.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Host side encoder and decoder of the frame protocol of UART_Communication.h:
+ * 	FRAME_START(1 byte) ID(1 byte) LEN(1 byte) PAYLOAD(LEN bytes)
+ * ID, LEN and payload bytes equal to frame start or ROVER_FRAME_ESCAPE are sent as ROVER_FRAME_ESCAPE
+ * followed by the byte XORed with ROVER_FRAME_ESCAPE_XOR, so frame start is never inside of a frame
+ *
+ * Decoder follows state machine of UART_Communication_Update(), so host sees exactly
+ * the frames firmware would see (and the other way round):
+ * 	- frame start byte restarts the frame wherever it is received (also in ID, LEN or payload),
+ * 	  restart of unfinished frame is counted as resync
+ * 	- bytes received outside of the frame are counted as unknown
+ * 	- frame with LEN 0 is complete right after LEN byte
+ * 	- escape byte is removed and the next byte is XORed, also when it is in ID or LEN
+ *
+ * ALGORITHM (decoder)
+ * 1. Header bytes are processed one by one
+ * 2. Payload is processed in chunks, memchr() looks for frame start and escape byte in the bytes which belong to payload
+ * 		- if whole payload is in the input buffer and has no frame start or escape byte, callback gets pointer
+ * 		  into the input buffer (no copy)
+ * 		- otherwise chunk is copied to the decoder and callback gets decoder buffer when payload is complete
+ * 3. Between frames memchr() skips to the next frame start
+ * */
+#ifndef ROVER_FRAME_H_
+#define ROVER_FRAME_H_
+
+/*Frame start byte used by RoverMotorControler firmware (main.c)*/
+#define ROVER_FRAME_START 0x3CU
+/*Escape byte and XOR value of the escaped byte, same as UART_COMMUNICATION_ESCAPE_BYTE and UART_COMMUNICATION_ESCAPE_XOR*/
+#define ROVER_FRAME_ESCAPE 0x7DU
+#define ROVER_FRAME_ESCAPE_XOR 0x20U
+/*Start, ID and LEN bytes*/
+#define ROVER_FRAME_HEADER_SIZE 3U
+#define ROVER_FRAME_MAX_PAYLOAD 255U
+/*Decoded frame (header and payload without escape bytes)*/
+#define ROVER_FRAME_MAX_SIZE (ROVER_FRAME_HEADER_SIZE + ROVER_FRAME_MAX_PAYLOAD)
+/*Encoded frame when every byte after frame start is escaped*/
+#define ROVER_FRAME_MAX_ENCODED_SIZE (1U + 2U*(ROVER_FRAME_MAX_SIZE - 1U))
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	ROVER_FRAME_OK, //Everything fine
+	ROVER_FRAME_NULL_ERROR, //pointer passed as an argument was null
+	ROVER_FRAME_BUFFER_TOO_SMALL //encoded frame does not fit in the buffer
+} Rover_FrameStatusTypeDef;
+
+/*
+ * States of the decoder, same as states of UART_FrameTypeDef
+ * */
+typedef enum {
+	ROVER_DECODER_EMPTY,
+	ROVER_DECODER_WAITING_FOR_ID,
+	ROVER_DECODER_WAITING_FOR_LEN,
+	ROVER_DECODER_WAITING_FOR_PAYLOAD
+} Rover_DecoderStateTypeDef;
+
+/*
+ * Called for every complete frame, payload is valid only until callback returns
+ * */
+typedef void (*Rover_FrameCallbackTypeDef)(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload);
+
+/*
+ * Decoder of one byte stream
+ * */
+typedef struct {
+	//Symbol of frame start
+	uint8_t FrameStartByte;
+	Rover_DecoderStateTypeDef State;
+
+	//frame being decoded
+	uint8_t ID;
+	uint8_t FinalLength;
+	uint8_t CurrentLength;
+	uint8_t Payload[ROVER_FRAME_MAX_PAYLOAD];
+	//escape byte was received, next byte is XORed
+	uint8_t Escaped;
+
+	Rover_FrameCallbackTypeDef pCallback;
+	void* pContext;
+
+	//counters, same meaning as in UART_StatisticsTypeDef
+	uint64_t Frames;
+	uint64_t Resyncs;
+	uint64_t UnknownBytes;
+} Rover_DecoderTypeDef;
+
+/*
+ * @brief Encodes one frame into the buffer
+ *
+ * @param pBuffer buffer where frame is written
+ * @param size size of the buffer
+ * @param frame_start frame start byte
+ * @param ID ID of the frame
+ * @param len length of the payload
+ * @param payload pointer to the payload (can be NULL when len is 0)
+ * @param pWritten number of bytes written (ROVER_FRAME_HEADER_SIZE + len + escape bytes)
+ *
+ * @retval Rover_FrameStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_FrameStatusTypeDef Rover_Frame_Encode(uint8_t* pBuffer, size_t size, uint8_t frame_start, uint8_t ID, uint8_t len, const uint8_t* payload, size_t* pWritten);
+
+/*
+ * @brief Escapes frame which was written to the buffer decoded (frame start, ID, LEN, payload), in place
+ *
+ * @param pBuffer buffer with the decoded frame at its beginning
+ * @param size size of the buffer
+ * @param pWritten number of bytes of the encoded frame
+ *
+ * @retval Rover_FrameStatusTypeDef status if function was executed successfully, frame is not changed when
+ * it doesn't fit in the buffer
+ * */
+extern Rover_FrameStatusTypeDef Rover_Frame_Escape(uint8_t* pBuffer, size_t size, size_t* pWritten);
+
+/*
+ * @brief Initializes decoder
+ *
+ * @param pDecoder pointer to the decoder
+ * @param frame_start frame start byte
+ * @param pCallback called for every complete frame
+ * @param pContext passed to the callback
+ *
+ * @retval Rover_FrameStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_FrameStatusTypeDef Rover_Decoder_Init(Rover_DecoderTypeDef* pDecoder, uint8_t frame_start, Rover_FrameCallbackTypeDef pCallback, void* pContext);
+
+/*
+ * @brief Decodes bytes, calls callback for every frame completed by them,
+ * frame can be split between any number of calls
+ *
+ * @param pDecoder pointer to the decoder
+ * @param data received bytes
+ * @param size number of bytes
+ *
+ * @retval Rover_FrameStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_FrameStatusTypeDef Rover_Decoder_Feed(Rover_DecoderTypeDef* pDecoder, const uint8_t* data, size_t size);
+
+#endif
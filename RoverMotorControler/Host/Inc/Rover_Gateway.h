@@ -0,0 +1,121 @@
+/*Rover_Gateway.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Rover_Frame.h"
+#include "Rover_Ring.h"
+
+/*
+ * Gateway daemon (Rover_Gateway.c) owns serial links of all controllers of the rover,
+ * local programs (subscribers) talk to the controllers through it
+ *
+ * ALGORITHM
+ * 1. Every link has:
+ * 		- serial port read by Rover_Client, all ports are in one epoll loop
+ * 		- shared memory ring (Rover_Ring.h) where every received frame is written once
+ * 		- SOCK_SEQPACKET Unix socket <dir>/<link>.sock which subscribers connect to
+ * 2. After connection gateway sends name of the ring (first message), subscriber maps it read only
+ * 3. Received frames:
+ * 		- decoded once and pushed to the ring
+ * 		- after every epoll loop iteration subscribers of links with new frames get one notification
+ * 		  (uint64_t WriteCount), so gateway work per frame doesn't depend on number of subscribers
+ * 4. Commands:
+ * 		- subscriber sends whole frames (one or more per message), gateway validates them with the decoder
+ * 		  and queues them to the link
+ * 		- queued commands of every link are written together once per control tick (-t option)
+ * */
+#ifndef ROVER_GATEWAY_H_
+#define ROVER_GATEWAY_H_
+
+/*Directory of subscriber sockets*/
+#define ROVER_GATEWAY_DEFAULT_DIR "/tmp/rover-gateway"
+/*Control tick, commands are written to links every tick, 0 writes them immediately*/
+#define ROVER_GATEWAY_DEFAULT_TICK_MS 10U
+
+#define ROVER_GATEWAY_MAX_LINKS 8U
+#define ROVER_GATEWAY_MAX_SUBSCRIBERS 64U
+#define ROVER_GATEWAY_MAX_NAME 32U
+/*Max size of one command message*/
+#define ROVER_GATEWAY_MAX_MESSAGE 65536U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	ROVER_GATEWAY_OK, //Everything fine
+	ROVER_GATEWAY_NULL_ERROR, //pointer passed as an argument was null
+	ROVER_GATEWAY_IO_ERROR, //system call failed, errno is preserved
+	ROVER_GATEWAY_TIMEOUT, //nothing was received before timeout
+	ROVER_GATEWAY_CLOSED //gateway closed the connection
+} Rover_GatewayStatusTypeDef;
+
+/*
+ * Subscriber side of one link
+ * */
+typedef struct {
+	int Socket;
+	Rover_RingTypeDef* pRing;
+	//number of the next frame to read from the ring
+	uint64_t Cursor;
+	//frames lost because subscriber was too slow
+	uint64_t Overruns;
+	//frame being read from the ring
+	Rover_RingSlotTypeDef Slot;
+} Rover_Gateway_SubscriberTypeDef;
+
+/*
+ * @brief Connects to the link of the gateway, only frames received after connection are read
+ *
+ * @param pSubscriber pointer to subscriber handle
+ * @param dir directory of gateway sockets (NULL for ROVER_GATEWAY_DEFAULT_DIR)
+ * @param link name of the link
+ *
+ * @retval Rover_GatewayStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_GatewayStatusTypeDef Rover_Gateway_Connect(Rover_Gateway_SubscriberTypeDef* pSubscriber, const char* dir, const char* link);
+
+/*
+ * @brief Sends one frame to the link
+ *
+ * @param pSubscriber pointer to subscriber handle
+ * @param ID ID of the frame
+ * @param len length of the payload
+ * @param payload pointer to the payload (can be NULL when len is 0)
+ *
+ * @retval Rover_GatewayStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_GatewayStatusTypeDef Rover_Gateway_Send(Rover_Gateway_SubscriberTypeDef* pSubscriber, uint8_t ID, uint8_t len, const uint8_t* payload);
+
+/*
+ * @brief Sends already encoded frames in one message
+ *
+ * @param pSubscriber pointer to subscriber handle
+ * @param frames encoded frames
+ * @param size size in bytes (up to ROVER_GATEWAY_MAX_MESSAGE)
+ *
+ * @retval Rover_GatewayStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_GatewayStatusTypeDef Rover_Gateway_Send_Frames(Rover_Gateway_SubscriberTypeDef* pSubscriber, const uint8_t* frames, size_t size);
+
+/*
+ * @brief Waits for new frames and calls callback for every one of them
+ *
+ * @param pSubscriber pointer to subscriber handle
+ * @param timeout_ms max time to wait (-1 waits forever, 0 doesn't wait)
+ * @param pCallback called for every frame
+ * @param pContext passed to the callback
+ *
+ * @retval Rover_GatewayStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_GatewayStatusTypeDef Rover_Gateway_Receive(Rover_Gateway_SubscriberTypeDef* pSubscriber, int timeout_ms, Rover_FrameCallbackTypeDef pCallback, void* pContext);
+
+/*
+ * @brief Closes the connection and unmaps the ring
+ *
+ * @param pSubscriber pointer to subscriber handle
+ *
+ * @retval Rover_GatewayStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_GatewayStatusTypeDef Rover_Gateway_Disconnect(Rover_Gateway_SubscriberTypeDef* pSubscriber);
+
+#endif
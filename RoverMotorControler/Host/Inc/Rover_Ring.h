@@ -0,0 +1,112 @@
+/*Rover_Ring.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Rover_Frame.h"
+
+/*
+ * Frame ring buffer in POSIX shared memory, one writer (gateway) and any number of readers
+ *
+ * ALGORITHM
+ * 1. Ring is an array of fixed size slots, every slot holds one whole frame
+ * 2. Writer of frame number N (counted from 0):
+ * 		- clears Sequence of slot N % SlotCount, so readers see the slot is being rewritten
+ * 		- copies the frame, then stores Sequence = N + 1 and WriteCount = N + 1 (release)
+ * 3. Every reader has its own cursor (number of the next frame to read):
+ * 		- cursor == WriteCount means there is nothing new
+ * 		- reader copies the slot and checks Sequence before and after the copy,
+ * 		  changed Sequence means writer lapped the reader, cursor jumps to the oldest frame still in the ring
+ *    writer never waits for readers, slow reader loses frames (counted as overrun) instead of blocking the gateway
+ * */
+#ifndef ROVER_RING_H_
+#define ROVER_RING_H_
+
+#define ROVER_RING_MAGIC 0x52564F52U
+/*Default number of slots (~1MB of shared memory)*/
+#define ROVER_RING_SLOTS 4096U
+
+/*
+ * Return type of all functions
+ * */
+typedef enum {
+	ROVER_RING_OK, //Everything fine
+	ROVER_RING_NULL_ERROR, //pointer passed as an argument was null
+	ROVER_RING_IO_ERROR, //shm_open()/mmap() failed, errno is preserved
+	ROVER_RING_EMPTY, //there is no new frame
+	ROVER_RING_OVERRUN //reader was too slow, frames were lost and cursor was moved forward
+} Rover_RingStatusTypeDef;
+
+/*
+ * One frame, size of the slot is multiple of 8 bytes
+ * */
+typedef struct {
+	//frame number + 1, 0 while slot is being written
+	uint64_t Sequence;
+	//CLOCK_MONOTONIC time of reception in nanoseconds
+	uint64_t Timestamp;
+	uint16_t Size;
+	//frame start, ID, LEN and payload without escape bytes
+	uint8_t Frame[ROVER_FRAME_MAX_SIZE];
+} __attribute__((aligned(8))) Rover_RingSlotTypeDef;
+
+/*
+ * Layout of the shared memory
+ * */
+typedef struct {
+	uint32_t Magic;
+	uint32_t SlotCount;
+	//number of frames written since ring was created
+	uint64_t WriteCount;
+	Rover_RingSlotTypeDef Slots[];
+} Rover_RingTypeDef;
+
+/*
+ * @brief Creates (or recreates) shared memory ring, used by the writer
+ *
+ * @param name shm_open() name, starting with '/'
+ * @param slot_count number of slots
+ * @param ppRing pointer where address of mapped ring is written
+ *
+ * @retval Rover_RingStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_RingStatusTypeDef Rover_Ring_Create(const char* name, uint32_t slot_count, Rover_RingTypeDef** ppRing);
+
+/*
+ * @brief Maps existing ring read only, used by readers
+ *
+ * @param name shm_open() name, starting with '/'
+ * @param ppRing pointer where address of mapped ring is written
+ *
+ * @retval Rover_RingStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_RingStatusTypeDef Rover_Ring_Open(const char* name, Rover_RingTypeDef** ppRing);
+
+/*
+ * @brief Unmaps the ring
+ * */
+extern Rover_RingStatusTypeDef Rover_Ring_Close(Rover_RingTypeDef* pRing);
+
+/*
+ * @brief Appends one frame, never blocks
+ *
+ * @param pRing pointer to the ring
+ * @param timestamp time of reception
+ * @param frame whole frame (header and payload)
+ * @param size size of the frame
+ *
+ * @retval Rover_RingStatusTypeDef status if function was executed successfully
+ * */
+extern Rover_RingStatusTypeDef Rover_Ring_Push(Rover_RingTypeDef* pRing, uint64_t timestamp, const uint8_t* frame, uint16_t size);
+
+/*
+ * @brief Copies next frame for the reader
+ *
+ * @param pRing pointer to the ring
+ * @param pCursor cursor of the reader, incremented when frame is read
+ * @param pSlot pointer where frame is copied
+ *
+ * @retval Rover_RingStatusTypeDef ROVER_RING_OK, ROVER_RING_EMPTY or ROVER_RING_OVERRUN (nothing was copied, next call continues)
+ * */
+extern Rover_RingStatusTypeDef Rover_Ring_Read(const Rover_RingTypeDef* pRing, uint64_t* pCursor, Rover_RingSlotTypeDef* pSlot);
+
+#endif
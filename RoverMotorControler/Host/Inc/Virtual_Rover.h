@@ -0,0 +1,79 @@
+/*Virtual_Rover.h*/
+#include "stm32g4xx_hal.h"
+
+#include "Motor_Control.h"
+
+/*
+ * Virtual rover runs firmware main.c as a Linux process
+ *
+ * ALGORITHM
+ * 1. main() creates pseudo-terminal, prints path of its slave side (/dev/pts/N) and calls firmware main()
+ *    (main.c is compiled with -Dmain=Firmware_Main)
+ * 2. Firmware runs unchanged, when it has nothing to do Idle_Sleep_Update() calls __WFI(),
+ *    which is where virtual rover "delivers interrupts":
+ * 		- waits (poll) for bytes from pty, 1ms SysTick timer, control timer or free space in pty
+ * 		- received bytes (at most VIRTUAL_ROVER_RX_BURST per wake up) go through HAL_UART_RxCpltCallback(),
+ * 		  burst is smaller than the queue, so bytes are never lost no matter how fast client writes
+ * 		- every SysTick period calls HAL_IncTick() and checks IWDG
+ * 		- control timer plays TIM6, it runs at motor_control.Rate (armed after Motor_Control_Init()) and calls
+ * 		  Motor_Control_Timer_Interrupt_Callback() once per period
+ * 		- transmitted bytes are buffered and written to pty, when buffer is full transmission waits
+ * 		  (transmit interrupt is delivered after pty takes some bytes), like UART limited by the line speed
+ * 3. Motor callbacks in main.c log every command with Virtual_Rover_Log_Callback()
+ * 4. Encoders read simulated wheels: speed follows duty of the wheel with VIRTUAL_ROVER_WHEEL_TIME_CONSTANT lag,
+ *    model advances one control period per read, so the wheels run in real time
+ * 5. Current of a simulated wheel is duty minus speed (voltage minus back EMF), full speed at full duty takes no current
+ * */
+#ifndef VIRTUAL_ROVER_H_
+#define VIRTUAL_ROVER_H_
+
+/*Max number of bytes delivered to receive interrupt per one __WFI()*/
+#define VIRTUAL_ROVER_RX_BURST 64U
+
+/*Size of the buffer of bytes waiting to be written to pty, transmission waits when it is full*/
+#define VIRTUAL_ROVER_TX_BUFFER_SIZE 65536U
+/*Buffered bytes are also written to pty every time that many bytes were transmitted*/
+#define VIRTUAL_ROVER_TX_WRITE_SIZE 4096U
+
+/*Time constant of simulated wheels in seconds*/
+#define VIRTUAL_ROVER_WHEEL_TIME_CONSTANT 0.05
+
+/*Battery voltage reported by Motor_ADC in millivolts*/
+#define VIRTUAL_ROVER_BATTERY_VOLTAGE 12000U
+
+/*
+ * @brief Firmware entry point, main() of main.c renamed by the compiler
+ * */
+extern int Firmware_Main(void);
+
+/*
+ * @brief Logs invocation of a frame callback on stdout (unless -q option was given)
+ * @param name name of the command
+ * @param len length of the payload
+ * @param payload pointer to the payload
+ * */
+extern void Virtual_Rover_Log_Callback(const char* name, uint8_t len, const uint8_t* payload);
+
+/*
+ * @brief Encoder of a simulated wheel, advances the wheel by one control tick
+ * @param index index of the wheel
+ * @param tick_time length of the control tick in microseconds
+ * @param pCount encoder counter
+ * @param pEdgePosition counter captured on the last edge (CCR1)
+ * @param pEdgeTime time base captured on the last edge
+ * */
+extern void Virtual_Rover_Encoder_Read(uint8_t index, uint32_t tick_time, uint16_t* pCount, uint16_t* pEdgePosition, uint16_t* pEdgeTime);
+
+/*
+ * @brief Current of a simulated wheel
+ * @param index index of the wheel
+ * @retval int16_t current (Q15 fraction of the full scale of current sensing)
+ * */
+extern int16_t Virtual_Rover_Current_Read(uint8_t index);
+
+/*
+ * @brief Called from Error_Handler(), terminates the process instead of spinning forever
+ * */
+extern void Virtual_Rover_Error_Handler(void);
+
+#endif
@@ -0,0 +1,345 @@
+/*stm32g4xx_hal.h*/
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Minimal replacement of STM32G4 HAL used to build Core/Utils on a Linux host.
+ * It provides only what the library and main.c use:
+ * 	- UART handle, HAL_UART_Receive_IT() and HAL_UART_Transmit_IT()
+ * 	- PRIMASK and exclusive access intrinsics, single threaded host has nothing to mask, so only the flag is kept
+ * 	  and exclusive stores always succeed
+ * 	- DWT cycle counter, CYCCNT reads host monotonic clock in nanoseconds (SystemCoreClock is 1GHz)
+ * 	- SysTick tick counter (HAL_IncTick()/HAL_GetTick()) and IWDG timeout bookkeeping
+ * 	- clock, GPIO and peripheral initialization functions, they only return HAL_OK
+ *
+ * ALGORITHM (interrupt emulation)
+ * 1. HAL_Stub_UART_Receive() plays the role of the RX line, every byte is written to the buffer armed
+ *    by HAL_UART_Receive_IT() and HAL_UART_RxCpltCallback() is called, like receive interrupt does
+ * 		- if reception is not armed byte is lost and HAL_UART_ErrorCallback() is called with HAL_UART_ERROR_ORE
+ * 		- HAL_Stub_UART_Error() reports line errors like HAL_UART_IRQHandler() does, overrun aborts the reception
+ * 2. HAL_UART_Transmit_IT() passes bytes to the TX sink of the handle and calls HAL_UART_TxCpltCallback()
+ * 		- sink can refuse a byte (the "wire" is busy), transmission then completes in HAL_Stub_UART_Transmit_Resume()
+ * 		- transmission started from inside of the callback is completed after the callback returns,
+ * 		  so the "interrupts chain" of the library runs in a loop instead of recursion
+ * 3. __WFI() calls HAL_Stub_WFI(), it does nothing by default, virtual rover (Virtual_Rover.c)
+ *    waits there for pty data and SysTick like the core waits for interrupts
+ * 4. __get_IPSR() is non zero while UART callbacks are called, so code can tell "interrupt" from main loop
+ * 5. HAL_Stub_Set_Time() switches DWT and SysTick to virtual time given by the caller (replay of captures),
+ *    so timestamps taken by the library don't depend on the speed of the host
+ * */
+#ifndef STM32G4XX_HAL_H_
+#define STM32G4XX_HAL_H_
+
+typedef enum {
+	HAL_OK = 0x00U,
+	HAL_ERROR = 0x01U,
+	HAL_BUSY = 0x02U,
+	HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+/*Same values as in stm32g4xx_hal_uart.h*/
+#define HAL_UART_ERROR_NONE (0x00000000U)
+#define HAL_UART_ERROR_PE (0x00000001U)
+#define HAL_UART_ERROR_NE (0x00000002U)
+#define HAL_UART_ERROR_FE (0x00000004U)
+#define HAL_UART_ERROR_ORE (0x00000008U)
+
+/*Same values as in stm32g4xx_hal_uart.h, flags are written to ICR which nobody reads*/
+#define UART_CLEAR_PEF (0x00000001U)
+#define UART_CLEAR_FEF (0x00000002U)
+#define UART_CLEAR_NEF (0x00000004U)
+#define UART_CLEAR_OREF (0x00000008U)
+#define __HAL_UART_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->ICR = (__FLAG__))
+
+/*
+ * UART handle, first part mirrors fields of the real handle used by the library,
+ * second part is host only
+ * */
+/*Peripheral instances only identify the peripheral, there are no registers behind them*/
+typedef struct {
+	volatile uint32_t ICR;
+} USART_TypeDef;
+
+typedef struct {
+	uint32_t Reserved;
+} IWDG_TypeDef;
+
+extern USART_TypeDef HAL_Stub_USART1;
+extern IWDG_TypeDef HAL_Stub_IWDG;
+
+#define USART1 (&HAL_Stub_USART1)
+#define IWDG (&HAL_Stub_IWDG)
+
+/*IRQ number of USART1 + 16, value of IPSR in USART1 interrupt*/
+#define HAL_STUB_USART1_IPSR 53U
+
+typedef struct {
+	uint32_t BaudRate;
+	uint32_t WordLength;
+	uint32_t StopBits;
+	uint32_t Parity;
+	uint32_t Mode;
+	uint32_t HwFlowCtl;
+	uint32_t OverSampling;
+	uint32_t OneBitSampling;
+	uint32_t ClockPrescaler;
+} UART_InitTypeDef;
+
+typedef struct {
+	uint32_t AdvFeatureInit;
+} UART_AdvFeatureInitTypeDef;
+
+typedef struct __UART_HandleTypeDef {
+	USART_TypeDef* Instance;
+	UART_InitTypeDef Init;
+	UART_AdvFeatureInitTypeDef AdvancedInit;
+	uint8_t* pRxBuffPtr;
+	uint16_t RxXferCount;
+	volatile uint32_t ErrorCode;
+
+	//called for every transmitted byte, can be NULL when bytes are not needed,
+	//returns 0 when byte can't be taken now (transmission waits for HAL_Stub_UART_Transmit_Resume())
+	uint8_t (*pTxSink)(struct __UART_HandleTypeDef* huart, uint8_t byte);
+	//bytes of the transmission refused by the sink
+	const uint8_t* pTxBuffPtr;
+	uint16_t TxXferCount;
+	//transmission was started from inside of HAL_UART_TxCpltCallback()
+	uint8_t TxPending;
+	uint8_t InTxCallback;
+} UART_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size);
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size);
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart);
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef* huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef* huart, uint32_t Threshold);
+HAL_StatusTypeDef HAL_UARTEx_DisableFifoMode(UART_HandleTypeDef* huart);
+
+/*Defined by the application, stub provides weak versions which do nothing*/
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart);
+
+/*
+ * @brief Emulates reception of bytes on RX line, calls receive interrupt callbacks
+ * @param huart - pointer to the handle
+ * @param pData - received bytes
+ * @param Size - number of bytes
+ * @retval number of bytes which were lost because reception was not armed
+ * */
+uint32_t HAL_Stub_UART_Receive(UART_HandleTypeDef* huart, const uint8_t* pData, uint32_t Size);
+
+/*
+ * @brief Emulates error interrupt, HAL_UART_ErrorCallback() is called with given error code,
+ * on overrun reception is aborted first (like for blocking errors in HAL_UART_IRQHandler())
+ * @param huart - pointer to the handle
+ * @param error - HAL_UART_ERROR_* flags
+ * */
+void HAL_Stub_UART_Error(UART_HandleTypeDef* huart, uint32_t error);
+
+/*
+ * @brief Passes waiting bytes of the transmission to the sink again, completes transmission
+ * (calls transmit interrupt callbacks) when all of them were taken
+ * @param huart - pointer to the handle
+ * @retval number of bytes still waiting
+ * */
+uint32_t HAL_Stub_UART_Transmit_Resume(UART_HandleTypeDef* huart);
+
+
+/*UART configuration values, only stored in the handle*/
+#define UART_WORDLENGTH_8B (0x00000000U)
+#define UART_STOPBITS_1 (0x00000000U)
+#define UART_PARITY_NONE (0x00000000U)
+#define UART_MODE_TX_RX (0x0000000CU)
+#define UART_HWCONTROL_NONE (0x00000000U)
+#define UART_OVERSAMPLING_16 (0x00000000U)
+#define UART_ONE_BIT_SAMPLE_DISABLE (0x00000000U)
+#define UART_PRESCALER_DIV1 (0x00000000U)
+#define UART_ADVFEATURE_NO_INIT (0x00000000U)
+#define UART_TXFIFO_THRESHOLD_1_8 (0x00000000U)
+#define UART_RXFIFO_THRESHOLD_1_8 (0x00000000U)
+
+
+/*IWDG, timeout is calculated from LSI (32kHz), prescaler and reload like on the target*/
+#define IWDG_PRESCALER_4 (0x00000000U)
+#define IWDG_PRESCALER_8 (0x00000001U)
+#define IWDG_PRESCALER_16 (0x00000002U)
+#define IWDG_PRESCALER_32 (0x00000003U)
+#define IWDG_PRESCALER_64 (0x00000004U)
+#define IWDG_PRESCALER_128 (0x00000005U)
+#define IWDG_PRESCALER_256 (0x00000006U)
+
+typedef struct {
+	uint32_t Prescaler;
+	uint32_t Reload;
+	uint32_t Window;
+} IWDG_InitTypeDef;
+
+typedef struct {
+	IWDG_TypeDef* Instance;
+	IWDG_InitTypeDef Init;
+} IWDG_HandleTypeDef;
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef* hiwdg);
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef* hiwdg);
+
+/*
+ * @brief Checks if watchdog would have reset the core
+ * @retval 1 if IWDG is running and was not refreshed within its timeout, 0 otherwise
+ * */
+uint32_t HAL_Stub_IWDG_Expired(void);
+
+
+/*SysTick, HAL_IncTick() has to be called every 1ms by whoever emulates SysTick*/
+HAL_StatusTypeDef HAL_Init(void);
+void HAL_IncTick(void);
+uint32_t HAL_GetTick(void);
+
+
+/*Clock configuration, only stored*/
+#define PWR_REGULATOR_VOLTAGE_SCALE1_BOOST (0x00000000U)
+
+#define RCC_OSCILLATORTYPE_HSI (0x00000002U)
+#define RCC_OSCILLATORTYPE_LSI (0x00000008U)
+#define RCC_HSI_ON (0x00000100U)
+#define RCC_HSICALIBRATION_DEFAULT (0x40U)
+#define RCC_LSI_ON (0x00000001U)
+#define RCC_PLL_ON (0x00000002U)
+#define RCC_PLLSOURCE_HSI (0x00000002U)
+#define RCC_PLLM_DIV1 (0x00000001U)
+#define RCC_PLLP_DIV2 (0x00000002U)
+#define RCC_PLLQ_DIV2 (0x00000002U)
+#define RCC_PLLR_DIV2 (0x00000002U)
+
+#define RCC_CLOCKTYPE_SYSCLK (0x00000001U)
+#define RCC_CLOCKTYPE_HCLK (0x00000002U)
+#define RCC_CLOCKTYPE_PCLK1 (0x00000004U)
+#define RCC_CLOCKTYPE_PCLK2 (0x00000008U)
+#define RCC_SYSCLKSOURCE_PLLCLK (0x00000003U)
+#define RCC_SYSCLK_DIV1 (0x00000000U)
+#define RCC_HCLK_DIV1 (0x00000000U)
+#define FLASH_LATENCY_4 (0x00000004U)
+
+typedef struct {
+	uint32_t PLLState;
+	uint32_t PLLSource;
+	uint32_t PLLM;
+	uint32_t PLLN;
+	uint32_t PLLP;
+	uint32_t PLLQ;
+	uint32_t PLLR;
+} RCC_PLLInitTypeDef;
+
+typedef struct {
+	uint32_t OscillatorType;
+	uint32_t HSEState;
+	uint32_t LSEState;
+	uint32_t HSIState;
+	uint32_t HSICalibrationValue;
+	uint32_t LSIState;
+	uint32_t HSI48State;
+	RCC_PLLInitTypeDef PLL;
+} RCC_OscInitTypeDef;
+
+typedef struct {
+	uint32_t ClockType;
+	uint32_t SYSCLKSource;
+	uint32_t AHBCLKDivider;
+	uint32_t APB1CLKDivider;
+	uint32_t APB2CLKDivider;
+} RCC_ClkInitTypeDef;
+
+HAL_StatusTypeDef HAL_PWREx_ControlVoltageScaling(uint32_t VoltageScaling);
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef* RCC_OscInitStruct);
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef* RCC_ClkInitStruct, uint32_t FLatency);
+
+#define __HAL_RCC_GPIOA_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOB_CLK_ENABLE() ((void)0)
+#define __HAL_RCC_GPIOC_CLK_ENABLE() ((void)0)
+
+
+/*Core intrinsics*/
+extern uint32_t HAL_Stub_PRIMASK;
+extern uint32_t HAL_Stub_IPSR;
+
+static inline uint32_t __get_PRIMASK(void){
+	return HAL_Stub_PRIMASK;
+}
+
+static inline void __set_PRIMASK(uint32_t priMask){
+	HAL_Stub_PRIMASK = priMask & 1U;
+}
+
+static inline void __disable_irq(void){
+	HAL_Stub_PRIMASK = 1U;
+}
+
+static inline void __enable_irq(void){
+	HAL_Stub_PRIMASK = 0U;
+}
+
+static inline uint32_t __get_IPSR(void){
+	return HAL_Stub_IPSR;
+}
+
+static inline uint8_t __CLZ(uint32_t value){
+	return value == 0U ? 32U : (uint8_t)__builtin_clz(value);
+}
+
+static inline uint8_t __LDREXB(volatile uint8_t* addr){
+	return *addr;
+}
+
+static inline uint32_t __STREXB(uint8_t value, volatile uint8_t* addr){
+	*addr = value;
+	return 0U;
+}
+
+#define __DMB() __sync_synchronize()
+#define __DSB() __sync_synchronize()
+#define __ISB() __sync_synchronize()
+#define __WFI() HAL_Stub_WFI()
+
+/*
+ * @brief Called by __WFI(), weak version returns at once
+ * */
+void HAL_Stub_WFI(void);
+
+
+/*DWT cycle counter*/
+typedef struct {
+	volatile uint32_t CTRL;
+	volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct {
+	volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk (1UL)
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << 24U)
+
+/*
+ * @brief Refreshes CYCCNT with host monotonic clock (in nanoseconds) and returns emulated DWT,
+ * writes to CYCCNT are overwritten on next access, only differences of readings are meaningful
+ * */
+DWT_Type* HAL_Stub_DWT(void);
+
+/*
+ * @brief Switches cycle counter and SysTick to virtual time, from now on CYCCNT is (uint32_t)time_ns
+ * and HAL_GetTick() is time_ns in milliseconds, until next call
+ *
+ * @param time_ns virtual time in nanoseconds, should not go backwards
+ * */
+void HAL_Stub_Set_Time(uint64_t time_ns);
+
+extern CoreDebug_Type HAL_Stub_CoreDebug;
+
+#define DWT (HAL_Stub_DWT())
+#define CoreDebug (&HAL_Stub_CoreDebug)
+
+/*Cycle counter frequency, 1GHz so one cycle is one nanosecond*/
+extern uint32_t SystemCoreClock;
+
+#endif
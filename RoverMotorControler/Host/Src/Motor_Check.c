@@ -0,0 +1,291 @@
+/*
+ * Motor_Check.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "stm32g4xx_hal.h"
+
+#include "Motor_Trajectory.h"
+#include "Motor_Filter.h"
+//software CORDIC of the host build is static, the module is compiled into the check instead of being linked
+#include "../../Core/Motor/Src/Motor_FOC.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Host checks of Core/Motor modules, every case prints "ok" or what went wrong:
+ * 	1. Motor_Trajectory - final position is exact, output never passes the waypoints, velocity and acceleration
+ * 	   stay in limits, queued waypoints in the same direction blend without stopping
+ * 	2. Motor_FOC software CORDIC (HOST_BUILD fallback of the coprocessor) - cosine/sine of all angles and phase/modulus
+ * 	   of a grid of vectors are within 1 LSB of libm cos, sin, atan2 and hypot
+ * 	3. Motor_Filter software FMAC model (HOST_BUILD) - outputs are compared bit by bit with vectors calculated by hand
+ * 	   from the FMAC arithmetic: step responses, 26bit accumulator wrap, output saturation and gain
+ * */
+#define CHECK_RATE 10000U
+//limits the control uses for 40960 counts/s wheel (__default_limits() in Motor_Control.c)
+#define CHECK_VELOCITY 20480U
+#define CHECK_ACCELERATION 40960U
+#define CHECK_JERK (40960U * 40U)
+//longest profile of the cases is a few seconds
+#define CHECK_TICKS_MAX (60U * CHECK_RATE)
+
+#define CHECK_ONE ((int64_t)1 << MOTOR_TRAJECTORY_Q)
+
+static int check_report(const char* name, const char* error){
+	if(error != NULL){
+		printf("%-40s FAILED: %s\n", name, error);
+		return -1;
+	}
+	printf("%-40s ok\n", name);
+	return 0;
+}
+
+/*
+ * @brief Runs the profile through the waypoints until it stops
+ *
+ * @param jerk 0 for trapezoidal profile
+ * @param start position and velocity (counts, counts per second) the profile starts from
+ * @param pWaypoints waypoints pushed at the start
+ * @param blend if true velocity must not reach 0 before the last waypoint
+ * */
+static int check_trajectory(const char* name, uint32_t jerk, int32_t start, int32_t start_velocity,
+		const int32_t* pWaypoints, uint8_t count, bool blend){
+	static Motor_TrajectoryTypeDef trajectory;
+	const Motor_TrajectoryConfigTypeDef config = {.Velocity = CHECK_VELOCITY, .Acceleration = CHECK_ACCELERATION, .Jerk = jerk};
+	if(Motor_Trajectory_Init(&trajectory, &config, CHECK_RATE) != MOTOR_TRAJECTORY_OK)
+		return check_report(name, "init failed");
+	Motor_Trajectory_Reset(&trajectory, start, start_velocity);
+
+	//output can't leave the range of the start and all waypoints
+	int64_t low = (int64_t)start * CHECK_ONE, high = low;
+	for(uint8_t i = 0; i < count; i++){
+		if(Motor_Trajectory_Push(&trajectory, pWaypoints[i]) != MOTOR_TRAJECTORY_OK)
+			return check_report(name, "push failed");
+		int64_t waypoint = (int64_t)pWaypoints[i] * CHECK_ONE;
+		low = waypoint < low ? waypoint : low;
+		high = waypoint > high ? waypoint : high;
+	}
+	if(start_velocity != 0)
+		return check_report(name, "moving start is not supported by the check");
+
+	int64_t velocity_max = ((int64_t)CHECK_VELOCITY * CHECK_ONE + CHECK_RATE - 1) / CHECK_RATE;
+	//one tick of rounding on top of the limit
+	int64_t acceleration_max = ((int64_t)CHECK_ACCELERATION * CHECK_ONE) / ((int64_t)CHECK_RATE * CHECK_RATE) + 2;
+	int64_t last = (int64_t)pWaypoints[count - 1U] * CHECK_ONE;
+	int64_t previous_velocity = 0;
+	bool started = false;
+	uint32_t tick = 0;
+	char error[128];
+
+	for(; tick < CHECK_TICKS_MAX; tick++){
+		Motor_Trajectory_Update(&trajectory);
+		int64_t position = trajectory.OutputPosition;
+		int64_t velocity = trajectory.OutputVelocity;
+
+		if(position < low || position > high){
+			snprintf(error, sizeof(error), "tick %u position %.3f outside waypoints (%lld/2^24 past)", (unsigned)tick, (double)position / CHECK_ONE, (long long)(position > high ? position - high : low - position));
+			return check_report(name, error);
+		}
+		if(velocity > velocity_max || velocity < -velocity_max){
+			snprintf(error, sizeof(error), "tick %u velocity %lld above limit", (unsigned)tick, (long long)velocity);
+			return check_report(name, error);
+		}
+		int64_t acceleration = velocity - previous_velocity;
+		if(acceleration > acceleration_max || acceleration < -acceleration_max){
+			snprintf(error, sizeof(error), "tick %u acceleration %lld above limit", (unsigned)tick, (long long)acceleration);
+			return check_report(name, error);
+		}
+		previous_velocity = velocity;
+
+		if(velocity != 0)
+			started = true;
+		//profile stopped before it reached the last waypoint
+		if(blend && started && velocity == 0 && position != last){
+			snprintf(error, sizeof(error), "tick %u stopped at %.3f", (unsigned)tick, (double)position / CHECK_ONE);
+			return check_report(name, error);
+		}
+		if(started && !trajectory.Moving)
+			break;
+	}
+
+	if(tick == CHECK_TICKS_MAX)
+		return check_report(name, "profile didn't stop");
+	if(trajectory.OutputPosition != last || trajectory.OutputVelocity != 0){
+		snprintf(error, sizeof(error), "stopped at %lld/2^24 (expected %lld/2^24), velocity %lld",
+				(long long)trajectory.OutputPosition, (long long)last, (long long)trajectory.OutputVelocity);
+		return check_report(name, error);
+	}
+	return check_report(name, NULL);
+}
+
+static int check_trajectories(void){
+	static const int32_t single[] = {1000};
+	static const int32_t long_move[] = {-50000};
+	static const int32_t back[] = {1000, 0};
+	static const int32_t blend[] = {1000, 2000};
+	static const int32_t short_steps[] = {1, 2, 3, 7};
+
+	int result = 0;
+	result |= check_trajectory("trajectory trapezoid 0 -> 1000", 0, 0, 0, single, 1, false);
+	result |= check_trajectory("trajectory trapezoid cruise 0 -> -50000", 0, 0, 0, long_move, 1, false);
+	result |= check_trajectory("trajectory S-curve 0 -> 1000", CHECK_JERK, 0, 0, single, 1, false);
+	result |= check_trajectory("trajectory S-curve 123 -> -50000", CHECK_JERK, 123, 0, long_move, 1, false);
+	result |= check_trajectory("trajectory S-curve 0 -> 1000 -> 0", CHECK_JERK, 0, 0, back, 2, false);
+	result |= check_trajectory("trajectory trapezoid 0 -> 1000 -> 2000", 0, 0, 0, blend, 2, true);
+	result |= check_trajectory("trajectory S-curve 0 -> 1000 -> 2000", CHECK_JERK, 0, 0, blend, 2, true);
+	result |= check_trajectory("trajectory S-curve short steps", CHECK_JERK, 0, 0, short_steps, 4, false);
+	return result;
+}
+
+/*
+ * @brief Difference of two q1.15 angles, wraps at pi like the angles
+ * */
+static int32_t check_angle_error(int32_t angle, int32_t expected){
+	return (int16_t)(uint16_t)(angle - expected);
+}
+
+/*Rounded q1.15 value of a real number, saturated like CORDIC results*/
+static int32_t check_q15(double value){
+	long result = lround(value * 32768.0);
+	return result > MOTOR_Q15_ONE ? MOTOR_Q15_ONE : result < -32768 ? -32768 : (int32_t)result;
+}
+
+static int check_cordic_cosine(void){
+	const char* name = "CORDIC cosine/sine";
+	char error[128];
+
+	__cordic_configure(MOTOR_FOC_CORDIC_COSINE);
+	for(int32_t angle = -32768; angle <= 32767; angle++){
+		int16_t cosine, sine;
+		__cordic_write((int16_t)angle, MOTOR_Q15_ONE);
+		__cordic_read(&cosine, &sine);
+
+		double radians = angle * M_PI / 32768.0;
+		double modulus = MOTOR_Q15_ONE / 32768.0;
+		int32_t error_cosine = abs(cosine - check_q15(modulus * cos(radians)));
+		int32_t error_sine = abs(sine - check_q15(modulus * sin(radians)));
+		if(error_cosine > 1 || error_sine > 1){
+			snprintf(error, sizeof(error), "angle %d gives (%d, %d), error %d/%d LSB", (int)angle, cosine, sine,
+					(int)error_cosine, (int)error_sine);
+			return check_report(name, error);
+		}
+	}
+	return check_report(name, NULL);
+}
+
+static int check_cordic_phase(void){
+	const char* name = "CORDIC phase/modulus";
+	char error[128];
+
+	__cordic_configure(MOTOR_FOC_CORDIC_PHASE);
+	//odd step reaches both ends of the range and values next to the axes
+	for(int32_t x = -32768; x <= 32767; x += 257){
+		for(int32_t y = -32768; y <= 32767; y += 257){
+			if(x == 0 && y == 0)
+				continue;
+			int16_t angle, modulus;
+			__cordic_write((int16_t)x, (int16_t)y);
+			__cordic_read(&angle, &modulus);
+
+			int32_t expected_angle = (int16_t)(uint16_t)lround(atan2(y, x) / M_PI * 32768.0);
+			int32_t expected_modulus = check_q15(hypot(x, y) / 32768.0);
+			int32_t error_angle = abs(check_angle_error(angle, expected_angle));
+			int32_t error_modulus = abs(modulus - expected_modulus);
+			if(error_angle > 1 || error_modulus > 1){
+				snprintf(error, sizeof(error), "(%d, %d) gives angle %d (expected %d), modulus %d (expected %d)",
+						(int)x, (int)y, angle, (int)expected_angle, modulus, (int)expected_modulus);
+				return check_report(name, error);
+			}
+		}
+	}
+	return check_report(name, NULL);
+}
+
+/*Samples of the filter vectors, channel 1 gets zeros and has to stay 0*/
+#define CHECK_FILTER_SAMPLES 20U
+
+/*
+ * @brief Feeds constant input to channel 0 of two interleaved channels and compares the outputs
+ *
+ * @param pExpected outputs of channel 0 for every sample
+ * */
+static int check_filter(const char* name, const Motor_FilterConfigTypeDef* pConfig, int16_t input, const int16_t* pExpected){
+	static Motor_FilterTypeDef filter;
+	char error[128];
+
+	if(Motor_Filter_Init(&filter, 2) != MOTOR_FILTER_OK || Motor_Filter_Configure(&filter, pConfig) != MOTOR_FILTER_OK)
+		return check_report(name, "configuration failed");
+
+	for(uint32_t n = 0; n < CHECK_FILTER_SAMPLES; n++){
+		const int16_t samples[2] = {input, 0};
+		int16_t output[2];
+		Motor_Filter_Write(&filter, samples);
+		Motor_Filter_Read(&filter, output);
+		if(output[0] != pExpected[n] || output[1] != 0){
+			snprintf(error, sizeof(error), "sample %u gives %d/%d (expected %d/0)", (unsigned)n, output[0], output[1], pExpected[n]);
+			return check_report(name, error);
+		}
+	}
+	return check_report(name, NULL);
+}
+
+static int check_filters(void){
+	int result = 0;
+
+	//moving average of 4 samples, 0.25 * 0.5 = 2^19 in q4.22, output takes bits 7 and up
+	const Motor_FilterConfigTypeDef average = {.Type = MOTOR_FILTER_FIR, .FeedForward = 4, .B = {8192, 8192, 8192, 8192}};
+	const int16_t average_step[CHECK_FILTER_SAMPLES] = {4096, 8192, 12288, 16384, 16384, 16384, 16384, 16384, 16384, 16384,
+			16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384, 16384};
+	result |= check_filter("FMAC model FIR step", &average, 16384, average_step);
+
+	//y[n] = 0.5 * x[n] + 0.5 * y[n - 1], half of the remaining error per sample, truncation stops it 1 LSB below 0.5
+	const Motor_FilterConfigTypeDef lowpass = {.Type = MOTOR_FILTER_IIR, .FeedForward = 2, .Feedback = 1, .B = {16384, 0}, .A = {16384}};
+	const int16_t lowpass_step[CHECK_FILTER_SAMPLES] = {8192, 12288, 14336, 15360, 15872, 16128, 16256, 16320, 16352, 16368,
+			16376, 16380, 16382, 16383, 16383, 16383, 16383, 16383, 16383, 16383};
+	result |= check_filter("FMAC model IIR step", &lowpass, 16384, lowpass_step);
+
+	//product of full scale values is 4194048, sum of 9 of them passes 2^25 and wraps to -29362432,
+	//sum of all 16 taps wraps to -4096, which is -32 after the shift, outputs in between are saturated
+	const Motor_FilterConfigTypeDef wrap = {.Type = MOTOR_FILTER_FIR, .FeedForward = 16,
+			.B = {32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767, 32767}};
+	const int16_t wrap_step[CHECK_FILTER_SAMPLES] = {32766, 32767, 32767, 32767, 32767, 32767, 32767, 32767,
+			-32768, -32768, -32768, -32768, -32768, -32768, -32768, -32, -32, -32, -32, -32};
+	result |= check_filter("FMAC model accumulator wrap", &wrap, 32767, wrap_step);
+
+	//0.125 * 2^Gain, gain 5 gives 4 times the input, which is saturated
+	Motor_FilterConfigTypeDef gain = {.Type = MOTOR_FILTER_FIR, .FeedForward = 2, .B = {4096, 0}, .Gain = 3};
+	int16_t gain_output[CHECK_FILTER_SAMPLES];
+	for(uint32_t n = 0; n < CHECK_FILTER_SAMPLES; n++)
+		gain_output[n] = -10000;
+	result |= check_filter("FMAC model gain 3", &gain, -10000, gain_output);
+	gain.Gain = 4;
+	for(uint32_t n = 0; n < CHECK_FILTER_SAMPLES; n++)
+		gain_output[n] = -20000;
+	result |= check_filter("FMAC model gain 4", &gain, -10000, gain_output);
+	gain.Gain = 5;
+	for(uint32_t n = 0; n < CHECK_FILTER_SAMPLES; n++)
+		gain_output[n] = -32768;
+	result |= check_filter("FMAC model gain 5 saturation", &gain, -10000, gain_output);
+
+	//negative products are truncated towards minus infinity: -1 * 128 >> 8 is -1 (0 if rounded towards zero), output -1
+	const Motor_FilterConfigTypeDef truncation = {.Type = MOTOR_FILTER_FIR, .FeedForward = 2, .B = {128, 0}};
+	int16_t truncation_output[CHECK_FILTER_SAMPLES];
+	for(uint32_t n = 0; n < CHECK_FILTER_SAMPLES; n++)
+		truncation_output[n] = -1;
+	result |= check_filter("FMAC model truncation", &truncation, -1, truncation_output);
+
+	return result;
+}
+
+int main(void){
+	int result = 0;
+	result |= check_trajectories();
+	result |= check_cordic_cosine();
+	result |= check_cordic_phase();
+	result |= check_filters();
+
+	return result != 0 ? 1 : 0;
+}
@@ -0,0 +1,267 @@
+/*
+ * Rover_Capture.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Capture.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+_Static_assert(sizeof(Rover_CaptureHeaderTypeDef) <= ROVER_CAPTURE_HEADER_SIZE, "capture header doesn't fit");
+_Static_assert(sizeof(Rover_CaptureRecordTypeDef) == 12, "capture record has to be packed");
+
+static uint64_t __clock_ns(clockid_t clock){
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static Rover_CaptureBlockTypeDef* __block(Rover_CaptureWriterTypeDef* pWriter){
+	return (Rover_CaptureBlockTypeDef*)pWriter->pBlock;
+}
+
+static void __block_start(Rover_CaptureWriterTypeDef* pWriter){
+	Rover_CaptureBlockTypeDef* pBlock = __block(pWriter);
+	memset(pBlock, 0, sizeof(Rover_CaptureBlockTypeDef));
+	pBlock->Magic = ROVER_CAPTURE_BLOCK_MAGIC;
+	pBlock->Used = sizeof(Rover_CaptureBlockTypeDef);
+}
+
+static Rover_CaptureStatusTypeDef __write_all(int fd, const void* data, size_t size, off_t offset){
+	const uint8_t* pData = data;
+	while(size > 0){
+		ssize_t written = pwrite(fd, pData, size, offset);
+		if(written < 0){
+			if(errno == EINTR)
+				continue;
+			return ROVER_CAPTURE_IO_ERROR;
+		}
+		pData += written;
+		offset += written;
+		size -= (size_t)written;
+	}
+	return ROVER_CAPTURE_OK;
+}
+
+static Rover_CaptureStatusTypeDef __block_write(Rover_CaptureWriterTypeDef* pWriter){
+	off_t offset = (off_t)(ROVER_CAPTURE_HEADER_SIZE + pWriter->BlockIndex * ROVER_CAPTURE_BLOCK_SIZE);
+	//unused tail is written too, so every block in the file has full size and offsets stay fixed
+	return __write_all(pWriter->Fd, pWriter->pBlock, ROVER_CAPTURE_BLOCK_SIZE, offset);
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Create(Rover_CaptureWriterTypeDef* pWriter, const char* path, uint32_t link_count, const char* const* link_names){
+	if(pWriter == NULL || path == NULL || (link_count > 0 && link_names == NULL))
+		return ROVER_CAPTURE_NULL_ERROR;
+	if(link_count > ROVER_CAPTURE_MAX_LINKS){
+		errno = EINVAL;
+		return ROVER_CAPTURE_IO_ERROR;
+	}
+
+	memset(pWriter, 0, sizeof(Rover_CaptureWriterTypeDef));
+	pWriter->pBlock = calloc(1, ROVER_CAPTURE_BLOCK_SIZE);
+	if(pWriter->pBlock == NULL)
+		return ROVER_CAPTURE_IO_ERROR;
+
+	pWriter->Fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if(pWriter->Fd < 0){
+		free(pWriter->pBlock);
+		return ROVER_CAPTURE_IO_ERROR;
+	}
+
+	Rover_CaptureHeaderTypeDef* pHeader = &pWriter->Header;
+	memcpy(pHeader->Magic, ROVER_CAPTURE_MAGIC, sizeof(pHeader->Magic));
+	pHeader->Version = ROVER_CAPTURE_VERSION;
+	pHeader->BlockSize = ROVER_CAPTURE_BLOCK_SIZE;
+	pHeader->StartRealtime = __clock_ns(CLOCK_REALTIME);
+	pHeader->StartMonotonic = __clock_ns(CLOCK_MONOTONIC);
+	pHeader->LinkCount = link_count;
+	for(uint32_t i = 0; i < link_count; i++)
+		strncpy(pHeader->LinkNames[i], link_names[i], ROVER_CAPTURE_MAX_NAME - 1);
+
+	uint8_t header[ROVER_CAPTURE_HEADER_SIZE] = {0};
+	memcpy(header, pHeader, sizeof(Rover_CaptureHeaderTypeDef));
+	if(__write_all(pWriter->Fd, header, sizeof(header), 0) != ROVER_CAPTURE_OK){
+		close(pWriter->Fd);
+		free(pWriter->pBlock);
+		return ROVER_CAPTURE_IO_ERROR;
+	}
+
+	__block_start(pWriter);
+	return ROVER_CAPTURE_OK;
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Write(Rover_CaptureWriterTypeDef* pWriter, uint64_t timestamp, uint8_t link, uint8_t direction, const uint8_t* data, size_t size){
+	if(pWriter == NULL || pWriter->pBlock == NULL || (size > 0 && data == NULL))
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	while(size > 0){
+		Rover_CaptureBlockTypeDef* pBlock = __block(pWriter);
+		size_t free_space = ROVER_CAPTURE_BLOCK_SIZE - pBlock->Used;
+
+		//record header with at least one byte of data has to fit, otherwise block is closed
+		if(free_space <= sizeof(Rover_CaptureRecordTypeDef)){
+			if(__block_write(pWriter) != ROVER_CAPTURE_OK)
+				return ROVER_CAPTURE_IO_ERROR;
+			pWriter->BlockIndex++;
+			__block_start(pWriter);
+			continue;
+		}
+
+		size_t chunk = free_space - sizeof(Rover_CaptureRecordTypeDef);
+		if(chunk > size)
+			chunk = size;
+		if(chunk > UINT16_MAX)
+			chunk = UINT16_MAX;
+
+		Rover_CaptureRecordTypeDef record = {
+				.Timestamp = timestamp,
+				.Link = link,
+				.Direction = direction,
+				.Length = (uint16_t)chunk
+		};
+		uint8_t* pWrite = pWriter->pBlock + pBlock->Used;
+		memcpy(pWrite, &record, sizeof(record));
+		memcpy(pWrite + sizeof(record), data, chunk);
+
+		if(pBlock->RecordCount == 0)
+			pBlock->FirstTimestamp = timestamp;
+		pBlock->LastTimestamp = timestamp;
+		pBlock->RecordCount++;
+		pBlock->Used += (uint32_t)(sizeof(record) + chunk);
+
+		pWriter->Records++;
+		pWriter->Bytes += chunk;
+		data += chunk;
+		size -= chunk;
+	}
+
+	return ROVER_CAPTURE_OK;
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Flush(Rover_CaptureWriterTypeDef* pWriter){
+	if(pWriter == NULL || pWriter->pBlock == NULL)
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	if(__block(pWriter)->RecordCount == 0)
+		return ROVER_CAPTURE_OK;
+	return __block_write(pWriter);
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Close(Rover_CaptureWriterTypeDef* pWriter){
+	if(pWriter == NULL || pWriter->pBlock == NULL)
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	Rover_CaptureStatusTypeDef status = Rover_Capture_Flush(pWriter);
+	if(close(pWriter->Fd) != 0)
+		status = ROVER_CAPTURE_IO_ERROR;
+	free(pWriter->pBlock);
+	pWriter->pBlock = NULL;
+	pWriter->Fd = -1;
+	return status;
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Map(Rover_CaptureReaderTypeDef* pReader, const char* path){
+	if(pReader == NULL || path == NULL)
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		return ROVER_CAPTURE_IO_ERROR;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0){
+		close(fd);
+		return ROVER_CAPTURE_IO_ERROR;
+	}
+	if((size_t)st.st_size < ROVER_CAPTURE_HEADER_SIZE){
+		close(fd);
+		return ROVER_CAPTURE_FORMAT_ERROR;
+	}
+
+	void* pMemory = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(pMemory == MAP_FAILED)
+		return ROVER_CAPTURE_IO_ERROR;
+	madvise(pMemory, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	const Rover_CaptureHeaderTypeDef* pHeader = pMemory;
+	if(memcmp(pHeader->Magic, ROVER_CAPTURE_MAGIC, sizeof(pHeader->Magic)) != 0 || pHeader->Version != ROVER_CAPTURE_VERSION
+			|| pHeader->BlockSize < sizeof(Rover_CaptureBlockTypeDef) || pHeader->LinkCount > ROVER_CAPTURE_MAX_LINKS){
+		munmap(pMemory, (size_t)st.st_size);
+		return ROVER_CAPTURE_FORMAT_ERROR;
+	}
+
+	pReader->pMap = pMemory;
+	pReader->Size = (size_t)st.st_size;
+	pReader->pHeader = pHeader;
+	//partially written last block (crash during write) is ignored
+	pReader->BlockCount = (pReader->Size - ROVER_CAPTURE_HEADER_SIZE) / pHeader->BlockSize;
+	return ROVER_CAPTURE_OK;
+}
+
+static const Rover_CaptureBlockTypeDef* __reader_block(const Rover_CaptureReaderTypeDef* pReader, uint64_t index){
+	return (const Rover_CaptureBlockTypeDef*)(pReader->pMap + ROVER_CAPTURE_HEADER_SIZE + index * pReader->pHeader->BlockSize);
+}
+
+uint64_t Rover_Capture_Find_Block(const Rover_CaptureReaderTypeDef* pReader, uint64_t timestamp){
+	if(pReader == NULL || pReader->pMap == NULL)
+		return 0;
+
+	//first block whose last record is not older than timestamp
+	uint64_t low = 0;
+	uint64_t high = pReader->BlockCount;
+	while(low < high){
+		uint64_t middle = low + (high - low) / 2;
+		if(__reader_block(pReader, middle)->LastTimestamp < timestamp)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Iterate(const Rover_CaptureReaderTypeDef* pReader, uint64_t first_block, Rover_CaptureCallbackTypeDef pCallback, void* pContext){
+	if(pReader == NULL || pReader->pMap == NULL || pCallback == NULL)
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	uint32_t block_size = pReader->pHeader->BlockSize;
+	for(uint64_t i = first_block; i < pReader->BlockCount; i++){
+		const Rover_CaptureBlockTypeDef* pBlock = __reader_block(pReader, i);
+		if(pBlock->Magic != ROVER_CAPTURE_BLOCK_MAGIC || pBlock->Used > block_size)
+			return ROVER_CAPTURE_FORMAT_ERROR;
+
+		const uint8_t* pRead = (const uint8_t*)pBlock + sizeof(Rover_CaptureBlockTypeDef);
+		const uint8_t* pEnd = (const uint8_t*)pBlock + pBlock->Used;
+		for(uint32_t r = 0; r < pBlock->RecordCount; r++){
+			Rover_CaptureRecordTypeDef record;
+			if((size_t)(pEnd - pRead) < sizeof(record))
+				return ROVER_CAPTURE_FORMAT_ERROR;
+			memcpy(&record, pRead, sizeof(record));
+			pRead += sizeof(record);
+			if((size_t)(pEnd - pRead) < record.Length)
+				return ROVER_CAPTURE_FORMAT_ERROR;
+
+			if(pCallback(pContext, &record, pRead) != 0)
+				return ROVER_CAPTURE_STOP;
+			pRead += record.Length;
+		}
+	}
+
+	return ROVER_CAPTURE_OK;
+}
+
+Rover_CaptureStatusTypeDef Rover_Capture_Unmap(Rover_CaptureReaderTypeDef* pReader){
+	if(pReader == NULL || pReader->pMap == NULL)
+		return ROVER_CAPTURE_NULL_ERROR;
+
+	munmap((void*)pReader->pMap, pReader->Size);
+	memset(pReader, 0, sizeof(Rover_CaptureReaderTypeDef));
+	return ROVER_CAPTURE_OK;
+}
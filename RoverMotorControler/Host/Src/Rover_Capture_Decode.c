@@ -0,0 +1,171 @@
+/*
+ * Rover_Capture_Decode.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Capture.h"
+#include "Rover_Frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Decodes capture written by Rover_Gateway -c, one decoder per link and direction
+ * usage: Rover_Capture_Decode [-f] [-s start_s] [-k frame_start] capture_file
+ * 	-f prints every frame with its time (seconds from start of the capture)
+ * 	-s starts at that many seconds from start of the capture (blocks before are not read at all)
+ * 	-k frame start byte (default ROVER_FRAME_START)
+ * */
+
+typedef struct {
+	Rover_DecoderTypeDef Decoder;
+	uint8_t Link;
+	uint8_t Direction;
+	uint64_t Bytes;
+	uint64_t Records;
+	uint64_t IDs[256];
+} Decode_StreamTypeDef;
+
+typedef struct {
+	Decode_StreamTypeDef Streams[ROVER_CAPTURE_MAX_LINKS][2];
+	const Rover_CaptureReaderTypeDef* pReader;
+	uint64_t StartTimestamp;
+	//time of the record being decoded, for printing frames
+	uint64_t Timestamp;
+	int PrintFrames;
+	uint64_t BadRecords;
+} Decode_ContextTypeDef;
+
+static Decode_ContextTypeDef decode_context;
+
+static const char* decode_direction(uint8_t direction){
+	return direction == ROVER_CAPTURE_RX ? "rx" : "tx";
+}
+
+static void decode_frame(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	Decode_StreamTypeDef* pStream = pContext;
+	pStream->IDs[ID]++;
+	if(!decode_context.PrintFrames)
+		return;
+
+	uint64_t time = decode_context.Timestamp - decode_context.StartTimestamp;
+	printf("%llu.%09llu %s %s %02x len %u:", (unsigned long long)(time / 1000000000U), (unsigned long long)(time % 1000000000U),
+			decode_context.pReader->pHeader->LinkNames[pStream->Link], decode_direction(pStream->Direction), (unsigned)ID, (unsigned)len);
+	for(uint8_t i = 0; i < len; i++)
+		printf(" %02x", payload[i]);
+	printf("\n");
+}
+
+static int decode_record(void* pContext, const Rover_CaptureRecordTypeDef* pRecord, const uint8_t* data){
+	Decode_ContextTypeDef* pDecode = pContext;
+	if(pRecord->Link >= pDecode->pReader->pHeader->LinkCount || pRecord->Direction > ROVER_CAPTURE_TX){
+		pDecode->BadRecords++;
+		return 0;
+	}
+	if(pRecord->Timestamp < pDecode->StartTimestamp)
+		return 0;
+
+	Decode_StreamTypeDef* pStream = &pDecode->Streams[pRecord->Link][pRecord->Direction];
+	pDecode->Timestamp = pRecord->Timestamp;
+	pStream->Bytes += pRecord->Length;
+	pStream->Records++;
+	Rover_Decoder_Feed(&pStream->Decoder, data, pRecord->Length);
+	return 0;
+}
+
+static uint64_t decode_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+int main(int argc, char** argv){
+	double start_s = 0.0;
+	uint8_t frame_start = ROVER_FRAME_START;
+
+	int option;
+	while((option = getopt(argc, argv, "fs:k:")) != -1){
+		switch(option){
+			case 'f':
+				decode_context.PrintFrames = 1;
+				break;
+			case 's':
+				start_s = strtod(optarg, NULL);
+				break;
+			case 'k':
+				frame_start = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if(optind != argc - 1){
+		fprintf(stderr, "usage: %s [-f] [-s start_s] [-k frame_start] capture_file\n", argv[0]);
+		return 2;
+	}
+
+	Rover_CaptureReaderTypeDef reader;
+	Rover_CaptureStatusTypeDef status = Rover_Capture_Map(&reader, argv[optind]);
+	if(status != ROVER_CAPTURE_OK){
+		if(status == ROVER_CAPTURE_FORMAT_ERROR)
+			fprintf(stderr, "%s: not a capture file\n", argv[optind]);
+		else
+			perror(argv[optind]);
+		return 1;
+	}
+
+	const Rover_CaptureHeaderTypeDef* pHeader = reader.pHeader;
+	decode_context.pReader = &reader;
+	decode_context.StartTimestamp = pHeader->StartMonotonic + (uint64_t)(start_s * 1e9);
+	for(uint32_t i = 0; i < pHeader->LinkCount; i++){
+		for(uint8_t j = 0; j < 2U; j++){
+			Decode_StreamTypeDef* pStream = &decode_context.Streams[i][j];
+			pStream->Link = (uint8_t)i;
+			pStream->Direction = j;
+			Rover_Decoder_Init(&pStream->Decoder, frame_start, &decode_frame, pStream);
+		}
+	}
+
+	uint64_t first_block = Rover_Capture_Find_Block(&reader, decode_context.StartTimestamp);
+	uint64_t start = decode_now();
+	status = Rover_Capture_Iterate(&reader, first_block, &decode_record, &decode_context);
+	uint64_t elapsed = decode_now() - start;
+	if(status == ROVER_CAPTURE_FORMAT_ERROR)
+		fprintf(stderr, "%s: damaged block, decoded up to it\n", argv[optind]);
+
+	time_t started = (time_t)(pHeader->StartRealtime / 1000000000U);
+	char started_text[64];
+	strftime(started_text, sizeof(started_text), "%Y-%m-%d %H:%M:%S", localtime(&started));
+	uint64_t total_bytes = 0;
+
+	printf("capture started %s, %u links, %llu blocks (from block %llu)\n", started_text, (unsigned)pHeader->LinkCount,
+			(unsigned long long)reader.BlockCount, (unsigned long long)first_block);
+	for(uint32_t i = 0; i < pHeader->LinkCount; i++){
+		for(uint8_t j = 0; j < 2U; j++){
+			Decode_StreamTypeDef* pStream = &decode_context.Streams[i][j];
+			total_bytes += pStream->Bytes;
+			if(pStream->Records == 0)
+				continue;
+
+			printf("%s %s: %llu bytes in %llu records, %llu frames, %llu resyncs, %llu unknown bytes\n",
+					pHeader->LinkNames[i], decode_direction(j), (unsigned long long)pStream->Bytes, (unsigned long long)pStream->Records,
+					(unsigned long long)pStream->Decoder.Frames, (unsigned long long)pStream->Decoder.Resyncs,
+					(unsigned long long)pStream->Decoder.UnknownBytes);
+			for(uint32_t id = 0; id < 256U; id++){
+				if(pStream->IDs[id] > 0)
+					printf("\tID %02x: %llu\n", (unsigned)id, (unsigned long long)pStream->IDs[id]);
+			}
+		}
+	}
+	if(decode_context.BadRecords > 0)
+		printf("%llu records with unknown link or direction\n", (unsigned long long)decode_context.BadRecords);
+	if(!decode_context.PrintFrames && elapsed > 0)
+		printf("decoded %.1f MB in %.3f ms, %.1f MB/s\n", (double)total_bytes / 1e6, (double)elapsed / 1e6, (double)total_bytes * 1e3 / (double)elapsed);
+
+	Rover_Capture_Unmap(&reader);
+	return status == ROVER_CAPTURE_FORMAT_ERROR ? 1 : 0;
+}
@@ -0,0 +1,311 @@
+/*
+ * Rover_Client.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Client.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+
+/*Maps baud rate to termios constant, 0 if it is not supported*/
+static speed_t __client_speed(uint32_t baud){
+	switch(baud){
+		case 9600: return B9600;
+		case 19200: return B19200;
+		case 38400: return B38400;
+		case 57600: return B57600;
+		case 115200: return B115200;
+		case 230400: return B230400;
+		case 460800: return B460800;
+		case 921600: return B921600;
+		case 1000000: return B1000000;
+		case 2000000: return B2000000;
+		default: return 0;
+	}
+}
+
+/*Requests EPOLLOUT only while fd has not accepted everything*/
+static Rover_ClientStatusTypeDef __client_update_events(Rover_ClientTypeDef* pClient){
+	uint8_t waiting = pClient->TxEnd > pClient->TxStart;
+	if(waiting == pClient->WaitingForWrite)
+		return ROVER_CLIENT_OK;
+
+	struct epoll_event event = {.events = EPOLLIN | (waiting ? EPOLLOUT : 0U), .data.u64 = pClient->Token};
+	if(epoll_ctl(pClient->EpollFd, EPOLL_CTL_MOD, pClient->Fd, &event) != 0)
+		return ROVER_CLIENT_IO_ERROR;
+
+	pClient->WaitingForWrite = waiting;
+	return ROVER_CLIENT_OK;
+}
+
+/*Writes as much as fd accepts without blocking*/
+static Rover_ClientStatusTypeDef __client_write(Rover_ClientTypeDef* pClient){
+	while(pClient->TxEnd > pClient->TxStart){
+		ssize_t written = write(pClient->Fd, &pClient->TxBuffer[pClient->TxStart], pClient->TxEnd - pClient->TxStart);
+		if(written < 0){
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				break;
+			if(errno == EINTR)
+				continue;
+			return ROVER_CLIENT_IO_ERROR;
+		}
+		if(pClient->pTap != NULL)
+			pClient->pTap(pClient->pTapContext, ROVER_CLIENT_TX, &pClient->TxBuffer[pClient->TxStart], (size_t)written);
+		pClient->TxStart += (size_t)written;
+		pClient->TxBytes += (uint64_t)written;
+	}
+
+	//everything written, next frames start at the beginning of the buffer again,
+	//unless caller is filling reserved frame in place
+	if(pClient->TxStart == pClient->TxEnd && pClient->TxReserved == pClient->TxEnd){
+		pClient->TxStart = 0;
+		pClient->TxEnd = 0;
+		pClient->TxReserved = 0;
+	}
+
+	return __client_update_events(pClient);
+}
+
+/*Reads everything available and decodes it*/
+static Rover_ClientStatusTypeDef __client_read(Rover_ClientTypeDef* pClient){
+	while(1){
+		ssize_t received = read(pClient->Fd, pClient->RxBuffer, sizeof(pClient->RxBuffer));
+		if(received < 0){
+			if(errno == EAGAIN || errno == EWOULDBLOCK)
+				return ROVER_CLIENT_OK;
+			if(errno == EINTR)
+				continue;
+			//pty returns EIO when the other side is closed
+			return errno == EIO ? ROVER_CLIENT_CLOSED : ROVER_CLIENT_IO_ERROR;
+		}
+		if(received == 0)
+			return ROVER_CLIENT_CLOSED;
+
+		pClient->RxBytes += (uint64_t)received;
+		if(pClient->pTap != NULL)
+			pClient->pTap(pClient->pTapContext, ROVER_CLIENT_RX, pClient->RxBuffer, (size_t)received);
+		Rover_Decoder_Feed(&pClient->Decoder, pClient->RxBuffer, (size_t)received);
+
+		//short read means there is nothing more right now
+		if((size_t)received < sizeof(pClient->RxBuffer))
+			return ROVER_CLIENT_OK;
+	}
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Open(Rover_ClientTypeDef* pClient, const char* path, uint32_t baud, Rover_FrameCallbackTypeDef pCallback, void* pContext){
+	if(pClient == NULL || path == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	memset(pClient, 0, offsetof(Rover_ClientTypeDef, TxBuffer));
+	pClient->TxStart = 0;
+	pClient->TxEnd = 0;
+	pClient->TxReserved = 0;
+	pClient->TxBytes = 0;
+	pClient->RxBytes = 0;
+	pClient->TxFrames = 0;
+	pClient->EpollFd = -1;
+	pClient->OwnsEpoll = 1;
+	pClient->pTap = NULL;
+	pClient->pTapContext = NULL;
+	Rover_Decoder_Init(&pClient->Decoder, ROVER_FRAME_START, pCallback, pContext);
+
+	pClient->Fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+	if(pClient->Fd < 0)
+		return ROVER_CLIENT_IO_ERROR;
+
+	//binary protocol, no echo, no line editing, no CR/LF translation
+	struct termios tio;
+	if(tcgetattr(pClient->Fd, &tio) == 0){
+		cfmakeraw(&tio);
+		if(baud != 0){
+			speed_t speed = __client_speed(baud);
+			if(speed == 0 || cfsetspeed(&tio, speed) != 0){
+				Rover_Client_Close(pClient);
+				errno = EINVAL;
+				return ROVER_CLIENT_IO_ERROR;
+			}
+		}
+		if(tcsetattr(pClient->Fd, TCSANOW, &tio) != 0){
+			Rover_Client_Close(pClient);
+			return ROVER_CLIENT_IO_ERROR;
+		}
+	}
+
+	pClient->Token = (uint64_t)pClient->Fd;
+	pClient->EpollFd = epoll_create1(EPOLL_CLOEXEC);
+	struct epoll_event event = {.events = EPOLLIN, .data.u64 = pClient->Token};
+	if(pClient->EpollFd < 0 || epoll_ctl(pClient->EpollFd, EPOLL_CTL_ADD, pClient->Fd, &event) != 0){
+		Rover_Client_Close(pClient);
+		return ROVER_CLIENT_IO_ERROR;
+	}
+
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Attach(Rover_ClientTypeDef* pClient, int epoll_fd, uint64_t token){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	struct epoll_event event = {.events = EPOLLIN | (pClient->WaitingForWrite ? EPOLLOUT : 0U), .data.u64 = token};
+	if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, pClient->Fd, &event) != 0)
+		return ROVER_CLIENT_IO_ERROR;
+
+	//closing own instance removes fd from it
+	if(pClient->OwnsEpoll)
+		close(pClient->EpollFd);
+	else
+		epoll_ctl(pClient->EpollFd, EPOLL_CTL_DEL, pClient->Fd, NULL);
+
+	pClient->EpollFd = epoll_fd;
+	pClient->OwnsEpoll = 0;
+	pClient->Token = token;
+
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Process(Rover_ClientTypeDef* pClient, uint32_t events){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	if(events & (EPOLLIN | EPOLLHUP | EPOLLERR)){
+		Rover_ClientStatusTypeDef status = __client_read(pClient);
+		if(status != ROVER_CLIENT_OK)
+			return status;
+	}
+
+	if(events & EPOLLOUT)
+		return __client_write(pClient);
+
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Set_Tap(Rover_ClientTypeDef* pClient, Rover_ClientTapTypeDef pTap, void* pContext){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	pClient->pTap = pTap;
+	pClient->pTapContext = pContext;
+
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Reserve(Rover_ClientTypeDef* pClient, uint8_t ID, uint8_t len, uint8_t** ppPayload){
+	if(pClient == NULL || ppPayload == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	//frame is escaped in place by Rover_Client_Commit(), so space for escaping every byte after frame start is reserved
+	size_t frame_size = 1U + 2U*(ROVER_FRAME_HEADER_SIZE - 1U + (size_t)len);
+
+	//previous reservation which was not committed is dropped
+	pClient->TxReserved = pClient->TxEnd;
+
+	//frame has to be contiguous, move waiting bytes to the beginning when it doesn't fit at the end
+	if(ROVER_CLIENT_BUFFER_SIZE - pClient->TxEnd < frame_size && pClient->TxStart > 0){
+		memmove(pClient->TxBuffer, &pClient->TxBuffer[pClient->TxStart], pClient->TxEnd - pClient->TxStart);
+		pClient->TxEnd -= pClient->TxStart;
+		pClient->TxStart = 0;
+	}
+	if(ROVER_CLIENT_BUFFER_SIZE - pClient->TxEnd < frame_size)
+		return ROVER_CLIENT_BUFFER_FULL;
+
+	uint8_t* pFrame = &pClient->TxBuffer[pClient->TxEnd];
+	pFrame[0] = pClient->Decoder.FrameStartByte;
+	pFrame[1] = ID;
+	pFrame[2] = len;
+	pClient->TxReserved = pClient->TxEnd + frame_size;
+
+	(*ppPayload) = &pFrame[ROVER_FRAME_HEADER_SIZE];
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Commit(Rover_ClientTypeDef* pClient){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	if(pClient->TxReserved > pClient->TxEnd){
+		size_t size;
+		Rover_Frame_Escape(&pClient->TxBuffer[pClient->TxEnd], pClient->TxReserved - pClient->TxEnd, &size);
+		pClient->TxEnd += size;
+		pClient->TxReserved = pClient->TxEnd;
+		pClient->TxFrames++;
+	}
+
+	return ROVER_CLIENT_OK;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Send(Rover_ClientTypeDef* pClient, uint8_t ID, uint8_t len, const uint8_t* payload){
+	if(pClient == NULL || (payload == NULL && len > 0))
+		return ROVER_CLIENT_NULL_ERROR;
+
+	uint8_t* pPayload;
+	Rover_ClientStatusTypeDef status = Rover_Client_Reserve(pClient, ID, len, &pPayload);
+	if(status != ROVER_CLIENT_OK)
+		return status;
+
+	if(len > 0)
+		memcpy(pPayload, payload, len);
+
+	return Rover_Client_Commit(pClient);
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Poll(Rover_ClientTypeDef* pClient, int timeout_ms){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	//fd is usually writable, trying first saves one epoll_wait() round
+	Rover_ClientStatusTypeDef status = __client_write(pClient);
+	if(status != ROVER_CLIENT_OK)
+		return status;
+
+	struct epoll_event event;
+	int ready = epoll_wait(pClient->EpollFd, &event, 1, timeout_ms);
+	if(ready < 0)
+		return errno == EINTR ? ROVER_CLIENT_OK : ROVER_CLIENT_IO_ERROR;
+	if(ready == 0)
+		return ROVER_CLIENT_TIMEOUT;
+
+	return Rover_Client_Process(pClient, event.events);
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Flush(Rover_ClientTypeDef* pClient, int timeout_ms){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	while(pClient->TxEnd > pClient->TxStart){
+		Rover_ClientStatusTypeDef status = Rover_Client_Poll(pClient, timeout_ms);
+		if(status != ROVER_CLIENT_OK)
+			return status;
+	}
+
+	return ROVER_CLIENT_OK;
+}
+
+size_t Rover_Client_Tx_Pending(Rover_ClientTypeDef* pClient){
+	if(pClient == NULL)
+		return 0;
+
+	return pClient->TxEnd - pClient->TxStart;
+}
+
+Rover_ClientStatusTypeDef Rover_Client_Close(Rover_ClientTypeDef* pClient){
+	if(pClient == NULL)
+		return ROVER_CLIENT_NULL_ERROR;
+
+	if(pClient->EpollFd >= 0){
+		if(pClient->OwnsEpoll)
+			close(pClient->EpollFd);
+		else
+			epoll_ctl(pClient->EpollFd, EPOLL_CTL_DEL, pClient->Fd, NULL);
+	}
+	if(pClient->Fd >= 0)
+		close(pClient->Fd);
+	pClient->EpollFd = -1;
+	pClient->Fd = -1;
+
+	return ROVER_CLIENT_OK;
+}
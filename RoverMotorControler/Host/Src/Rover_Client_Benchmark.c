@@ -0,0 +1,212 @@
+/*
+ * Rover_Client_Benchmark.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Throughput and latency of Rover_Client against the firmware or virtual rover (make client-bench)
+ * Cases:
+ * 	1. decode - Rover_Decoder_Feed() on a buffer in memory, no I/O
+ * 	2. stream - pipelined one-way frames (MOTOR_SET_POS), finished by statistics request (0xF0),
+ * 	   FramesDispatched counter of the response has to match number of sent frames
+ * 	3. pipelined - requests (SYSTEM_GET_STACK) with BENCHMARK_WINDOW requests in flight, responses/s
+ * 	4. rtt - one request at a time, round trip time percentiles
+ * */
+#define BENCHMARK_FRAMES 100000U
+#define BENCHMARK_WINDOW 16U
+#define BENCHMARK_TIMEOUT_MS 2000
+
+/*IDs handled by RoverMotorControler main.c and UART_Communication.h*/
+#define BENCHMARK_MOTOR_SET_POS 0x13U
+#define BENCHMARK_SYSTEM_GET_STACK 0x23U
+#define BENCHMARK_STATISTICS_ID 0xF0U
+/*Offset of FramesDispatched in UART_StatisticsTypeDef*/
+#define BENCHMARK_FRAMES_DISPATCHED_OFFSET 16U
+
+static Rover_ClientTypeDef client;
+
+/*Responses received so far, statistics response payload is copied for the stream case*/
+static uint64_t responses;
+static uint64_t statistics_responses;
+static uint32_t frames_dispatched;
+
+static uint64_t benchmark_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+static void benchmark_callback(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	if(ID == BENCHMARK_STATISTICS_ID){
+		if(len >= BENCHMARK_FRAMES_DISPATCHED_OFFSET + sizeof(uint32_t))
+			memcpy(&frames_dispatched, &payload[BENCHMARK_FRAMES_DISPATCHED_OFFSET], sizeof(uint32_t));
+		statistics_responses++;
+	} else if(ID == BENCHMARK_SYSTEM_GET_STACK){
+		responses++;
+	}
+}
+
+static void benchmark_count_frame(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	(*(uint64_t*)pContext)++;
+}
+
+/*Polls until counter reaches the value*/
+static int benchmark_wait(uint64_t* pCounter, uint64_t value){
+	while(*pCounter < value){
+		Rover_ClientStatusTypeDef status = Rover_Client_Poll(&client, BENCHMARK_TIMEOUT_MS);
+		if(status != ROVER_CLIENT_OK){
+			fprintf(stderr, "poll failed (%d), %llu of %llu responses\n", (int)status, (unsigned long long)*pCounter, (unsigned long long)value);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/*Queues frame, sends some data first when transmit buffer is full*/
+static int benchmark_send(uint8_t ID, uint8_t len, const uint8_t* payload){
+	Rover_ClientStatusTypeDef status;
+	while((status = Rover_Client_Send(&client, ID, len, payload)) == ROVER_CLIENT_BUFFER_FULL){
+		if(Rover_Client_Poll(&client, BENCHMARK_TIMEOUT_MS) != ROVER_CLIENT_OK)
+			return -1;
+	}
+	return status == ROVER_CLIENT_OK ? 0 : -1;
+}
+
+static int benchmark_compare(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+static int benchmark_decode(uint32_t frames){
+	static uint8_t stream[1U << 20];
+	uint8_t payload[16];
+	size_t size = 0;
+	memset(payload, 0x55, sizeof(payload));
+
+	while(size + ROVER_FRAME_HEADER_SIZE + sizeof(payload) <= sizeof(stream)){
+		size_t written;
+		Rover_Frame_Encode(&stream[size], sizeof(stream) - size, ROVER_FRAME_START, 0x10, sizeof(payload), payload, &written);
+		size += written;
+	}
+
+	Rover_DecoderTypeDef decoder;
+	uint64_t decoded = 0;
+	Rover_Decoder_Init(&decoder, ROVER_FRAME_START, &benchmark_count_frame, &decoded);
+
+	uint64_t bytes = 0;
+	uint64_t start = benchmark_now();
+	while(decoded < frames){
+		Rover_Decoder_Feed(&decoder, stream, size);
+		bytes += size;
+	}
+	uint64_t elapsed = benchmark_now() - start;
+
+	printf("decode     %12.0f frames/s %10.2f MB/s %8.2f ns/byte\n", decoded / (elapsed / 1e9), bytes / (elapsed / 1e3), (double)elapsed / bytes);
+	return 0;
+}
+
+static int benchmark_stream(uint32_t frames){
+	uint8_t reset = 1;
+	uint8_t position[5] = {0, 0, 1, 0, 0};
+
+	//clear counters of the firmware first
+	if(benchmark_send(BENCHMARK_STATISTICS_ID, 1, &reset) != 0 || benchmark_wait(&statistics_responses, statistics_responses + 1) != 0)
+		return -1;
+
+	uint64_t start = benchmark_now();
+	for(uint32_t i = 0; i < frames; i++){
+		if(benchmark_send(BENCHMARK_MOTOR_SET_POS, sizeof(position), position) != 0)
+			return -1;
+		Rover_Client_Poll(&client, 0);
+	}
+	if(benchmark_send(BENCHMARK_STATISTICS_ID, 0, NULL) != 0 || benchmark_wait(&statistics_responses, statistics_responses + 1) != 0)
+		return -1;
+	uint64_t elapsed = benchmark_now() - start;
+
+	uint64_t bytes = (uint64_t)frames * (ROVER_FRAME_HEADER_SIZE + sizeof(position));
+	printf("stream     %12.0f frames/s %10.2f MB/s %8u dispatched\n", frames / (elapsed / 1e9), bytes / (elapsed / 1e3), (unsigned)frames_dispatched);
+	return frames_dispatched == frames ? 0 : -1;
+}
+
+static int benchmark_pipelined(uint32_t frames){
+	uint64_t first = responses;
+	uint64_t sent = 0;
+
+	uint64_t start = benchmark_now();
+	while(responses - first < frames){
+		//keep window full
+		while(sent < frames && sent - (responses - first) < BENCHMARK_WINDOW){
+			if(benchmark_send(BENCHMARK_SYSTEM_GET_STACK, 0, NULL) != 0)
+				return -1;
+			sent++;
+		}
+		if(Rover_Client_Poll(&client, BENCHMARK_TIMEOUT_MS) != ROVER_CLIENT_OK)
+			return -1;
+	}
+	uint64_t elapsed = benchmark_now() - start;
+
+	printf("pipelined  %12.0f frames/s (window %u)\n", frames / (elapsed / 1e9), BENCHMARK_WINDOW);
+	return 0;
+}
+
+static int benchmark_rtt(uint32_t frames){
+	uint64_t* rtt = malloc(sizeof(uint64_t) * frames);
+	if(rtt == NULL)
+		return -1;
+
+	for(uint32_t i = 0; i < frames; i++){
+		uint64_t start = benchmark_now();
+		if(benchmark_send(BENCHMARK_SYSTEM_GET_STACK, 0, NULL) != 0 || benchmark_wait(&responses, responses + 1) != 0){
+			free(rtt);
+			return -1;
+		}
+		rtt[i] = benchmark_now() - start;
+	}
+
+	qsort(rtt, frames, sizeof(uint64_t), &benchmark_compare);
+	printf("rtt        p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  max %8.1f us\n",
+			rtt[frames / 2] / 1e3, rtt[frames * 9 / 10] / 1e3, rtt[frames * 99 / 100] / 1e3, rtt[frames - 1] / 1e3);
+
+	free(rtt);
+	return 0;
+}
+
+int main(int argc, char** argv){
+	if(argc < 2){
+		fprintf(stderr, "usage: %s <serial port or pty> [frames] [baud]\n", argv[0]);
+		return 2;
+	}
+	uint32_t frames = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : BENCHMARK_FRAMES;
+	uint32_t baud = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0;
+	if(frames == 0)
+		frames = BENCHMARK_FRAMES;
+
+	if(Rover_Client_Open(&client, argv[1], baud, &benchmark_callback, NULL) != ROVER_CLIENT_OK){
+		perror(argv[1]);
+		return 1;
+	}
+
+	int result = benchmark_decode(frames * 10U);
+	if(result == 0)
+		result = benchmark_stream(frames);
+	if(result == 0)
+		result = benchmark_pipelined(frames / 10U + 1U);
+	if(result == 0)
+		result = benchmark_rtt(frames / 100U + 1U);
+
+	Rover_Client_Close(&client);
+
+	if(result != 0){
+		fprintf(stderr, "benchmark failed\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ * Rover_Frame.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Frame.h"
+
+#include <string.h>
+
+/*Reports complete frame and restores decoder to default state*/
+static void __decoder_complete(Rover_DecoderTypeDef* pDecoder, const uint8_t* payload){
+	pDecoder->Frames++;
+	if(pDecoder->pCallback != NULL)
+		pDecoder->pCallback(pDecoder->pContext, pDecoder->ID, pDecoder->FinalLength, payload);
+
+	pDecoder->State = ROVER_DECODER_EMPTY;
+	pDecoder->ID = 0;
+	pDecoder->FinalLength = 0;
+	pDecoder->CurrentLength = 0;
+}
+
+static inline int __needs_escape(uint8_t frame_start, uint8_t byte){
+	return byte == frame_start || byte == ROVER_FRAME_ESCAPE;
+}
+
+Rover_FrameStatusTypeDef Rover_Frame_Encode(uint8_t* pBuffer, size_t size, uint8_t frame_start, uint8_t ID, uint8_t len, const uint8_t* payload, size_t* pWritten){
+	if(pBuffer == NULL || pWritten == NULL || (payload == NULL && len > 0))
+		return ROVER_FRAME_NULL_ERROR;
+
+	if(size < ROVER_FRAME_HEADER_SIZE)
+		return ROVER_FRAME_BUFFER_TOO_SMALL;
+
+	pBuffer[0] = frame_start;
+	size_t written = 1;
+	for(size_t i = 0; i < ROVER_FRAME_HEADER_SIZE - 1U + (size_t)len; i++){
+		uint8_t byte = i == 0 ? ID : i == 1 ? len : payload[i - 2U];
+		if(__needs_escape(frame_start, byte)){
+			if(size - written < 2U)
+				return ROVER_FRAME_BUFFER_TOO_SMALL;
+			pBuffer[written++] = ROVER_FRAME_ESCAPE;
+			byte ^= ROVER_FRAME_ESCAPE_XOR;
+		}
+		if(written == size)
+			return ROVER_FRAME_BUFFER_TOO_SMALL;
+		pBuffer[written++] = byte;
+	}
+
+	(*pWritten) = written;
+	return ROVER_FRAME_OK;
+}
+
+Rover_FrameStatusTypeDef Rover_Frame_Escape(uint8_t* pBuffer, size_t size, size_t* pWritten){
+	if(pBuffer == NULL || pWritten == NULL)
+		return ROVER_FRAME_NULL_ERROR;
+
+	if(size < ROVER_FRAME_HEADER_SIZE || size < ROVER_FRAME_HEADER_SIZE + (size_t)pBuffer[2])
+		return ROVER_FRAME_BUFFER_TOO_SMALL;
+
+	uint8_t frame_start = pBuffer[0];
+	size_t decoded = ROVER_FRAME_HEADER_SIZE + (size_t)pBuffer[2];
+	size_t encoded = decoded;
+	for(size_t i = 1; i < decoded; i++)
+		encoded += __needs_escape(frame_start, pBuffer[i]);
+	if(encoded > size)
+		return ROVER_FRAME_BUFFER_TOO_SMALL;
+
+	//bytes are moved from the end, so none is overwritten before it is read
+	size_t w = encoded;
+	for(size_t i = decoded - 1U; i > 0; i--){
+		if(__needs_escape(frame_start, pBuffer[i])){
+			pBuffer[--w] = pBuffer[i] ^ ROVER_FRAME_ESCAPE_XOR;
+			pBuffer[--w] = ROVER_FRAME_ESCAPE;
+		} else {
+			pBuffer[--w] = pBuffer[i];
+		}
+	}
+
+	(*pWritten) = encoded;
+	return ROVER_FRAME_OK;
+}
+
+Rover_FrameStatusTypeDef Rover_Decoder_Init(Rover_DecoderTypeDef* pDecoder, uint8_t frame_start, Rover_FrameCallbackTypeDef pCallback, void* pContext){
+	if(pDecoder == NULL)
+		return ROVER_FRAME_NULL_ERROR;
+
+	memset(pDecoder, 0, sizeof(Rover_DecoderTypeDef));
+	pDecoder->FrameStartByte = frame_start;
+	pDecoder->State = ROVER_DECODER_EMPTY;
+	pDecoder->pCallback = pCallback;
+	pDecoder->pContext = pContext;
+
+	return ROVER_FRAME_OK;
+}
+
+Rover_FrameStatusTypeDef Rover_Decoder_Feed(Rover_DecoderTypeDef* pDecoder, const uint8_t* data, size_t size){
+	if(pDecoder == NULL || (data == NULL && size > 0))
+		return ROVER_FRAME_NULL_ERROR;
+
+	size_t i = 0;
+	while(i < size){
+		//frame start restarts the frame, same as in firmware
+		if(data[i] == pDecoder->FrameStartByte){
+			if(pDecoder->State != ROVER_DECODER_EMPTY)
+				pDecoder->Resyncs++;
+			pDecoder->State = ROVER_DECODER_WAITING_FOR_ID;
+			pDecoder->CurrentLength = 0;
+			pDecoder->Escaped = 0;
+			i++;
+			continue;
+		}
+
+		//escape byte inside of the frame only changes the next byte
+		if(data[i] == ROVER_FRAME_ESCAPE && !pDecoder->Escaped && pDecoder->State != ROVER_DECODER_EMPTY){
+			pDecoder->Escaped = 1;
+			i++;
+			continue;
+		}
+		uint8_t byte = data[i];
+		if(pDecoder->Escaped)
+			byte ^= ROVER_FRAME_ESCAPE_XOR;
+
+		switch(pDecoder->State){
+			case ROVER_DECODER_EMPTY: {
+				//skip everything up to the next frame start
+				const uint8_t* pStart = memchr(&data[i], pDecoder->FrameStartByte, size - i);
+				size_t skipped = pStart != NULL ? (size_t)(pStart - &data[i]) : size - i;
+				pDecoder->UnknownBytes += skipped;
+				i += skipped;
+				break;
+			}
+			case ROVER_DECODER_WAITING_FOR_ID:
+				pDecoder->ID = byte;
+				pDecoder->Escaped = 0;
+				i++;
+				pDecoder->State = ROVER_DECODER_WAITING_FOR_LEN;
+				break;
+			case ROVER_DECODER_WAITING_FOR_LEN:
+				pDecoder->FinalLength = byte;
+				pDecoder->Escaped = 0;
+				i++;
+				//frame without payload is already complete
+				if(pDecoder->FinalLength == 0)
+					__decoder_complete(pDecoder, NULL);
+				else
+					pDecoder->State = ROVER_DECODER_WAITING_FOR_PAYLOAD;
+				break;
+			case ROVER_DECODER_WAITING_FOR_PAYLOAD: {
+				//escaped byte is copied alone
+				if(pDecoder->Escaped){
+					pDecoder->Escaped = 0;
+					pDecoder->Payload[pDecoder->CurrentLength++] = byte;
+					i++;
+					if(pDecoder->CurrentLength == pDecoder->FinalLength)
+						__decoder_complete(pDecoder, pDecoder->Payload);
+					break;
+				}
+
+				size_t missing = pDecoder->FinalLength - pDecoder->CurrentLength;
+				size_t available = size - i < missing ? size - i : missing;
+
+				//chunk ends at frame start or escape byte if there is one, data[i] itself is neither of them
+				const uint8_t* pStart = memchr(&data[i], pDecoder->FrameStartByte, available);
+				size_t chunk = pStart != NULL ? (size_t)(pStart - &data[i]) : available;
+				const uint8_t* pEscape = memchr(&data[i], ROVER_FRAME_ESCAPE, chunk);
+				if(pEscape != NULL)
+					chunk = (size_t)(pEscape - &data[i]);
+
+				//whole payload is in the input, callback can use it in place
+				if(pDecoder->CurrentLength == 0 && chunk == pDecoder->FinalLength){
+					i += chunk;
+					__decoder_complete(pDecoder, &data[i - chunk]);
+					break;
+				}
+
+				memcpy(&pDecoder->Payload[pDecoder->CurrentLength], &data[i], chunk);
+				pDecoder->CurrentLength += chunk;
+				i += chunk;
+
+				if(pDecoder->CurrentLength == pDecoder->FinalLength)
+					__decoder_complete(pDecoder, pDecoder->Payload);
+				break;
+			}
+		}
+	}
+
+	return ROVER_FRAME_OK;
+}
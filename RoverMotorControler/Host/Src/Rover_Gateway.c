@@ -0,0 +1,475 @@
+/*
+ * Rover_Gateway.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#define _GNU_SOURCE
+#include "Rover_Gateway.h"
+#include "Rover_Client.h"
+#include "Rover_Capture.h"
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/timerfd.h>
+#include <sys/un.h>
+
+/*
+ * Gateway daemon, see Rover_Gateway.h
+ * usage: Rover_Gateway [-d dir] [-t tick_ms] [-s ring_slots] [-c capture_file] name=path[@baud] ...
+ * */
+
+/*What the fd registered in epoll is, stored in the highest byte of the token*/
+typedef enum {
+	GATEWAY_FD_SIGNAL,
+	GATEWAY_FD_TICK,
+	GATEWAY_FD_CAPTURE,
+	GATEWAY_FD_LINK,
+	GATEWAY_FD_LISTEN,
+	GATEWAY_FD_SUBSCRIBER
+} Gateway_FdTypeDef;
+
+#define GATEWAY_TOKEN(type, link, fd) (((uint64_t)(type) << 56) | ((uint64_t)(link) << 48) | (uint32_t)(fd))
+#define GATEWAY_TOKEN_TYPE(token) ((Gateway_FdTypeDef)((token) >> 56))
+#define GATEWAY_TOKEN_LINK(token) ((uint32_t)((token) >> 48) & 0xFFU)
+#define GATEWAY_TOKEN_FD(token) ((int)(uint32_t)(token))
+
+#define GATEWAY_MAX_EVENTS 64
+/*Capture is written to the file at least once per this period*/
+#define GATEWAY_CAPTURE_FLUSH_S 1
+
+typedef struct {
+	char Name[ROVER_GATEWAY_MAX_NAME];
+	//link is closed after its port reported error
+	uint8_t Up;
+
+	Rover_ClientTypeDef* pClient;
+
+	Rover_RingTypeDef* pRing;
+	char RingName[ROVER_GATEWAY_MAX_NAME*2U];
+	//WriteCount of the ring subscribers were last notified about
+	uint64_t Notified;
+
+	int ListenFd;
+	struct sockaddr_un Address;
+	int Subscribers[ROVER_GATEWAY_MAX_SUBSCRIBERS];
+	uint32_t SubscriberCount;
+
+	//counters
+	uint64_t FramesReceived;
+	uint64_t CommandsQueued;
+	uint64_t CommandsDropped;
+	uint64_t Notifications;
+} Gateway_LinkTypeDef;
+
+static Gateway_LinkTypeDef gateway_links[ROVER_GATEWAY_MAX_LINKS];
+static uint32_t gateway_link_count;
+static int gateway_epoll_fd = -1;
+static uint32_t gateway_tick_ms = ROVER_GATEWAY_DEFAULT_TICK_MS;
+
+/*Raw traffic of all links (-c option), link index in the capture is index in gateway_links*/
+static Rover_CaptureWriterTypeDef gateway_capture;
+static uint8_t gateway_capturing;
+
+/*Message buffer shared by all subscribers, messages are processed one at a time*/
+static uint8_t gateway_message[ROVER_GATEWAY_MAX_MESSAGE];
+
+static uint64_t gateway_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+/*Frame received from the controller, decoded once and written to the ring (without escape bytes)*/
+static void gateway_frame_received(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	Gateway_LinkTypeDef* pLink = pContext;
+	uint8_t frame[ROVER_FRAME_MAX_SIZE];
+
+	frame[0] = pLink->pClient->Decoder.FrameStartByte;
+	frame[1] = ID;
+	frame[2] = len;
+	if(len > 0)
+		memcpy(&frame[ROVER_FRAME_HEADER_SIZE], payload, len);
+	Rover_Ring_Push(pLink->pRing, gateway_now(), frame, (uint16_t)(ROVER_FRAME_HEADER_SIZE + len));
+	pLink->FramesReceived++;
+}
+
+/*Frame sent by a subscriber, validated by decoder and queued to the link*/
+static void gateway_command_received(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	Gateway_LinkTypeDef* pLink = pContext;
+
+	if(Rover_Client_Send(pLink->pClient, ID, len, payload) == ROVER_CLIENT_OK)
+		pLink->CommandsQueued++;
+	else
+		pLink->CommandsDropped++;
+}
+
+/*Tap of the link, every chunk read from or written to the port goes to the capture*/
+static void gateway_capture_tap(void* pContext, uint8_t direction, const uint8_t* data, size_t size){
+	Gateway_LinkTypeDef* pLink = pContext;
+
+	if(!gateway_capturing)
+		return;
+	if(Rover_Capture_Write(&gateway_capture, gateway_now(), (uint8_t)(pLink - gateway_links), direction, data, size) != ROVER_CAPTURE_OK){
+		fprintf(stderr, "gateway: capture stopped: %s\n", strerror(errno));
+		gateway_capturing = 0;
+	}
+}
+
+static void gateway_link_down(Gateway_LinkTypeDef* pLink, const char* reason){
+	if(!pLink->Up)
+		return;
+
+	fprintf(stderr, "gateway: link %s is down (%s)\n", pLink->Name, reason);
+	epoll_ctl(gateway_epoll_fd, EPOLL_CTL_DEL, pLink->pClient->Fd, NULL);
+	pLink->Up = 0;
+}
+
+static void gateway_flush(Gateway_LinkTypeDef* pLink){
+	if(pLink->Up && Rover_Client_Tx_Pending(pLink->pClient) > 0){
+		if(Rover_Client_Process(pLink->pClient, EPOLLOUT) != ROVER_CLIENT_OK)
+			gateway_link_down(pLink, strerror(errno));
+	}
+}
+
+static void gateway_remove_subscriber(Gateway_LinkTypeDef* pLink, int fd){
+	epoll_ctl(gateway_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+	close(fd);
+
+	for(uint32_t i = 0; i < pLink->SubscriberCount; i++){
+		if(pLink->Subscribers[i] == fd){
+			pLink->Subscribers[i] = pLink->Subscribers[--pLink->SubscriberCount];
+			break;
+		}
+	}
+}
+
+static void gateway_accept(uint32_t link_index){
+	Gateway_LinkTypeDef* pLink = &gateway_links[link_index];
+
+	int fd = accept4(pLink->ListenFd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+	if(fd < 0)
+		return;
+
+	struct epoll_event event = {.events = EPOLLIN, .data.u64 = GATEWAY_TOKEN(GATEWAY_FD_SUBSCRIBER, link_index, fd)};
+	if(pLink->SubscriberCount == ROVER_GATEWAY_MAX_SUBSCRIBERS
+			|| send(fd, pLink->RingName, strlen(pLink->RingName), MSG_NOSIGNAL) < 0
+			|| epoll_ctl(gateway_epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0){
+		close(fd);
+		return;
+	}
+
+	pLink->Subscribers[pLink->SubscriberCount++] = fd;
+}
+
+static void gateway_subscriber_message(uint32_t link_index, int fd){
+	Gateway_LinkTypeDef* pLink = &gateway_links[link_index];
+
+	while(1){
+		ssize_t received = recv(fd, gateway_message, sizeof(gateway_message), MSG_DONTWAIT);
+		if(received < 0){
+			if(errno == EINTR)
+				continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK)
+				gateway_remove_subscriber(pLink, fd);
+			return;
+		}
+		if(received == 0){
+			gateway_remove_subscriber(pLink, fd);
+			return;
+		}
+		if(!pLink->Up)
+			continue;
+
+		//every message has to contain whole frames, only decoded frames get to the controller
+		Rover_DecoderTypeDef decoder;
+		Rover_Decoder_Init(&decoder, pLink->pClient->Decoder.FrameStartByte, &gateway_command_received, pLink);
+		Rover_Decoder_Feed(&decoder, gateway_message, (size_t)received);
+		if(decoder.State != ROVER_DECODER_EMPTY || decoder.Resyncs > 0 || decoder.UnknownBytes > 0)
+			pLink->CommandsDropped++;
+
+		if(gateway_tick_ms == 0)
+			gateway_flush(pLink);
+	}
+}
+
+/*One notification per link per loop iteration, no matter how many frames were received*/
+static void gateway_notify(void){
+	for(uint32_t i = 0; i < gateway_link_count; i++){
+		Gateway_LinkTypeDef* pLink = &gateway_links[i];
+		uint64_t written = pLink->pRing->WriteCount;
+		if(written == pLink->Notified)
+			continue;
+		pLink->Notified = written;
+		pLink->Notifications++;
+
+		for(uint32_t j = 0; j < pLink->SubscriberCount; j++){
+			//full socket means subscriber has not read previous notification yet, it will read the ring anyway
+			if(send(pLink->Subscribers[j], &written, sizeof(written), MSG_DONTWAIT | MSG_NOSIGNAL) < 0
+					&& errno != EAGAIN && errno != EWOULDBLOCK){
+				gateway_remove_subscriber(pLink, pLink->Subscribers[j]);
+				j--;
+			}
+		}
+	}
+}
+
+static int gateway_add_fd(int fd, uint64_t token){
+	struct epoll_event event = {.events = EPOLLIN, .data.u64 = token};
+	return epoll_ctl(gateway_epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+/*Parses name=path[@baud] and opens everything the link needs*/
+static int gateway_open_link(const char* dir, const char* spec, uint32_t ring_slots){
+	if(gateway_link_count == ROVER_GATEWAY_MAX_LINKS){
+		fprintf(stderr, "gateway: too many links\n");
+		return -1;
+	}
+
+	uint32_t index = gateway_link_count;
+	Gateway_LinkTypeDef* pLink = &gateway_links[index];
+	memset(pLink, 0, sizeof(Gateway_LinkTypeDef));
+	pLink->ListenFd = -1;
+
+	char name[ROVER_GATEWAY_MAX_NAME] = {0};
+	const char* pEquals = strchr(spec, '=');
+	if(pEquals == NULL || pEquals == spec || (size_t)(pEquals - spec) >= sizeof(name)){
+		fprintf(stderr, "gateway: bad link %s, expected name=path[@baud]\n", spec);
+		return -1;
+	}
+	memcpy(name, spec, (size_t)(pEquals - spec));
+	memcpy(pLink->Name, name, sizeof(name));
+
+	char path[256];
+	snprintf(path, sizeof(path), "%s", pEquals + 1);
+	uint32_t baud = 0;
+	char* pAt = strrchr(path, '@');
+	if(pAt != NULL){
+		*pAt = '\0';
+		baud = (uint32_t)strtoul(pAt + 1, NULL, 10);
+	}
+
+	pLink->pClient = malloc(sizeof(Rover_ClientTypeDef));
+	if(pLink->pClient == NULL)
+		return -1;
+	if(Rover_Client_Open(pLink->pClient, path, baud, &gateway_frame_received, pLink) != ROVER_CLIENT_OK
+			|| Rover_Client_Attach(pLink->pClient, gateway_epoll_fd, GATEWAY_TOKEN(GATEWAY_FD_LINK, index, pLink->pClient->Fd)) != ROVER_CLIENT_OK){
+		fprintf(stderr, "gateway: %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+	Rover_Client_Set_Tap(pLink->pClient, &gateway_capture_tap, pLink);
+
+	snprintf(pLink->RingName, sizeof(pLink->RingName), "/rover-gateway-%d-%s", (int)getpid(), name);
+	if(Rover_Ring_Create(pLink->RingName, ring_slots, &pLink->pRing) != ROVER_RING_OK){
+		fprintf(stderr, "gateway: ring %s: %s\n", pLink->RingName, strerror(errno));
+		return -1;
+	}
+
+	pLink->Address.sun_family = AF_UNIX;
+	if((size_t)snprintf(pLink->Address.sun_path, sizeof(pLink->Address.sun_path), "%s/%s.sock", dir, name) >= sizeof(pLink->Address.sun_path)){
+		fprintf(stderr, "gateway: socket path too long\n");
+		return -1;
+	}
+	unlink(pLink->Address.sun_path);
+	pLink->ListenFd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+	if(pLink->ListenFd < 0
+			|| bind(pLink->ListenFd, (struct sockaddr*)&pLink->Address, sizeof(pLink->Address)) != 0
+			|| listen(pLink->ListenFd, 16) != 0
+			|| gateway_add_fd(pLink->ListenFd, GATEWAY_TOKEN(GATEWAY_FD_LISTEN, index, pLink->ListenFd)) != 0){
+		fprintf(stderr, "gateway: %s: %s\n", pLink->Address.sun_path, strerror(errno));
+		return -1;
+	}
+
+	pLink->Up = 1;
+	gateway_link_count++;
+	fprintf(stderr, "gateway: link %s on %s, subscribers connect to %s\n", pLink->Name, path, pLink->Address.sun_path);
+	return 0;
+}
+
+/*Capture is created after all links are open, it needs their names*/
+static int gateway_open_capture(const char* path){
+	const char* names[ROVER_GATEWAY_MAX_LINKS];
+	for(uint32_t i = 0; i < gateway_link_count; i++)
+		names[i] = gateway_links[i].Name;
+
+	if(Rover_Capture_Create(&gateway_capture, path, gateway_link_count, names) != ROVER_CAPTURE_OK){
+		fprintf(stderr, "gateway: capture %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	struct itimerspec period = {
+		.it_interval = {.tv_sec = GATEWAY_CAPTURE_FLUSH_S},
+		.it_value = {.tv_sec = GATEWAY_CAPTURE_FLUSH_S},
+	};
+	if(fd < 0 || timerfd_settime(fd, 0, &period, NULL) != 0 || gateway_add_fd(fd, GATEWAY_TOKEN(GATEWAY_FD_CAPTURE, 0, fd)) != 0){
+		perror("gateway: capture");
+		return -1;
+	}
+
+	gateway_capturing = 1;
+	fprintf(stderr, "gateway: capturing to %s\n", path);
+	return 0;
+}
+
+static void gateway_close(void){
+	for(uint32_t i = 0; i < gateway_link_count; i++){
+		Gateway_LinkTypeDef* pLink = &gateway_links[i];
+
+		fprintf(stderr, "gateway: link %s received %llu frames, queued %llu commands, dropped %llu, %llu notifications\n",
+				pLink->Name, (unsigned long long)pLink->FramesReceived, (unsigned long long)pLink->CommandsQueued,
+				(unsigned long long)pLink->CommandsDropped, (unsigned long long)pLink->Notifications);
+
+		for(uint32_t j = 0; j < pLink->SubscriberCount; j++)
+			close(pLink->Subscribers[j]);
+		if(pLink->ListenFd >= 0){
+			close(pLink->ListenFd);
+			unlink(pLink->Address.sun_path);
+		}
+		Rover_Client_Close(pLink->pClient);
+		free(pLink->pClient);
+		Rover_Ring_Close(pLink->pRing);
+		shm_unlink(pLink->RingName);
+	}
+
+	if(gateway_capture.pBlock != NULL){
+		fprintf(stderr, "gateway: captured %llu bytes in %llu records\n",
+				(unsigned long long)gateway_capture.Bytes, (unsigned long long)gateway_capture.Records);
+		Rover_Capture_Close(&gateway_capture);
+	}
+}
+
+int main(int argc, char** argv){
+	const char* dir = ROVER_GATEWAY_DEFAULT_DIR;
+	uint32_t ring_slots = ROVER_RING_SLOTS;
+	const char* capture_path = NULL;
+
+	int option;
+	while((option = getopt(argc, argv, "d:t:s:c:")) != -1){
+		switch(option){
+			case 'd':
+				dir = optarg;
+				break;
+			case 't':
+				gateway_tick_ms = (uint32_t)strtoul(optarg, NULL, 10);
+				break;
+			case 's':
+				ring_slots = (uint32_t)strtoul(optarg, NULL, 10);
+				break;
+			case 'c':
+				capture_path = optarg;
+				break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if(optind >= argc || ring_slots == 0){
+		fprintf(stderr, "usage: %s [-d dir] [-t tick_ms] [-s ring_slots] [-c capture_file] name=path[@baud] ...\n", argv[0]);
+		return 2;
+	}
+
+	mkdir(dir, 0755);
+
+	//signals are handled in the loop, so sockets and rings are always removed
+	sigset_t signals;
+	sigemptyset(&signals);
+	sigaddset(&signals, SIGINT);
+	sigaddset(&signals, SIGTERM);
+	sigprocmask(SIG_BLOCK, &signals, NULL);
+	int signal_fd = signalfd(-1, &signals, SFD_CLOEXEC);
+
+	gateway_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if(signal_fd < 0 || gateway_epoll_fd < 0 || gateway_add_fd(signal_fd, GATEWAY_TOKEN(GATEWAY_FD_SIGNAL, 0, signal_fd)) != 0){
+		perror("gateway");
+		return 1;
+	}
+
+	int tick_fd = -1;
+	if(gateway_tick_ms > 0){
+		tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		struct itimerspec period = {
+			.it_interval = {.tv_sec = gateway_tick_ms / 1000U, .tv_nsec = (long)(gateway_tick_ms % 1000U) * 1000000L},
+			.it_value = {.tv_sec = gateway_tick_ms / 1000U, .tv_nsec = (long)(gateway_tick_ms % 1000U) * 1000000L},
+		};
+		if(tick_fd < 0 || timerfd_settime(tick_fd, 0, &period, NULL) != 0 || gateway_add_fd(tick_fd, GATEWAY_TOKEN(GATEWAY_FD_TICK, 0, tick_fd)) != 0){
+			perror("gateway: tick");
+			return 1;
+		}
+	}
+
+	int result = 0;
+	for(int i = optind; i < argc && result == 0; i++)
+		result = gateway_open_link(dir, argv[i], ring_slots);
+	if(result == 0 && capture_path != NULL)
+		result = gateway_open_capture(capture_path);
+
+	int running = result == 0;
+	while(running){
+		struct epoll_event events[GATEWAY_MAX_EVENTS];
+		int ready = epoll_wait(gateway_epoll_fd, events, GATEWAY_MAX_EVENTS, -1);
+		if(ready < 0){
+			if(errno == EINTR)
+				continue;
+			perror("gateway: epoll_wait");
+			result = -1;
+			break;
+		}
+
+		for(int i = 0; i < ready; i++){
+			uint64_t token = events[i].data.u64;
+			Gateway_LinkTypeDef* pLink = &gateway_links[GATEWAY_TOKEN_LINK(token)];
+
+			switch(GATEWAY_TOKEN_TYPE(token)){
+				case GATEWAY_FD_SIGNAL:
+					running = 0;
+					break;
+				case GATEWAY_FD_TICK: {
+					uint64_t expirations;
+					if(read(tick_fd, &expirations, sizeof(expirations)) > 0){
+						for(uint32_t j = 0; j < gateway_link_count; j++)
+							gateway_flush(&gateway_links[j]);
+					}
+					break;
+				}
+				case GATEWAY_FD_CAPTURE: {
+					uint64_t expirations;
+					if(read(GATEWAY_TOKEN_FD(token), &expirations, sizeof(expirations)) > 0 && gateway_capturing
+							&& Rover_Capture_Flush(&gateway_capture) != ROVER_CAPTURE_OK){
+						fprintf(stderr, "gateway: capture stopped: %s\n", strerror(errno));
+						gateway_capturing = 0;
+					}
+					break;
+				}
+				case GATEWAY_FD_LINK: {
+					Rover_ClientStatusTypeDef status = Rover_Client_Process(pLink->pClient, events[i].events);
+					if(status == ROVER_CLIENT_CLOSED)
+						gateway_link_down(pLink, "closed");
+					else if(status != ROVER_CLIENT_OK)
+						gateway_link_down(pLink, strerror(errno));
+					break;
+				}
+				case GATEWAY_FD_LISTEN:
+					gateway_accept(GATEWAY_TOKEN_LINK(token));
+					break;
+				case GATEWAY_FD_SUBSCRIBER:
+					gateway_subscriber_message(GATEWAY_TOKEN_LINK(token), GATEWAY_TOKEN_FD(token));
+					break;
+			}
+		}
+
+		gateway_notify();
+	}
+
+	gateway_close();
+	return result == 0 ? 0 : 1;
+}
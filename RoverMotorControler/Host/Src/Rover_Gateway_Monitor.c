@@ -0,0 +1,141 @@
+/*
+ * Rover_Gateway_Monitor.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Gateway.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Subscriber of one gateway link, prints received frames and optionally sends frames
+ * usage: Rover_Gateway_Monitor [-d dir] [-x hex frame]... [-r repeat] [-n frames] [-q] link
+ * 	-x frame (hex, e.g. 3c2300) sent after connection, can be given many times
+ * 	-r sends frames given by -x that many times
+ * 	-n exits after that many frames were received and prints receive rate
+ * 	-q doesn't print frames
+ * */
+#define MONITOR_MAX_FRAMES_SIZE 4096U
+#define MONITOR_TIMEOUT_MS 5000
+
+static uint64_t monitor_received;
+static int monitor_quiet;
+
+static uint64_t monitor_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+static void monitor_frame(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	monitor_received++;
+	if(monitor_quiet)
+		return;
+
+	printf("%02x len %u:", (unsigned)ID, (unsigned)len);
+	for(uint8_t i = 0; i < len; i++)
+		printf(" %02x", payload[i]);
+	printf("\n");
+}
+
+/*Appends hex string to frame buffer*/
+static int monitor_parse_hex(const char* hex, uint8_t* pFrames, size_t* pSize){
+	size_t length = strlen(hex);
+	if(length % 2U != 0 || *pSize + length / 2U > MONITOR_MAX_FRAMES_SIZE)
+		return -1;
+
+	for(size_t i = 0; i < length; i += 2U){
+		char byte[3] = {hex[i], hex[i + 1U], '\0'};
+		char* pEnd;
+		pFrames[(*pSize)++] = (uint8_t)strtoul(byte, &pEnd, 16);
+		if(*pEnd != '\0')
+			return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv){
+	const char* dir = NULL;
+	uint8_t frames[MONITOR_MAX_FRAMES_SIZE];
+	size_t frames_size = 0;
+	uint64_t repeat = 1;
+	uint64_t expected = 0;
+
+	int option;
+	while((option = getopt(argc, argv, "d:x:r:n:q")) != -1){
+		switch(option){
+			case 'd':
+				dir = optarg;
+				break;
+			case 'x':
+				if(monitor_parse_hex(optarg, frames, &frames_size) != 0){
+					fprintf(stderr, "bad frame %s\n", optarg);
+					return 2;
+				}
+				break;
+			case 'r':
+				repeat = strtoull(optarg, NULL, 0);
+				break;
+			case 'n':
+				expected = strtoull(optarg, NULL, 0);
+				break;
+			case 'q':
+				monitor_quiet = 1;
+				break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if(optind != argc - 1){
+		fprintf(stderr, "usage: %s [-d dir] [-x hex frame]... [-r repeat] [-n frames] [-q] link\n", argv[0]);
+		return 2;
+	}
+
+	Rover_Gateway_SubscriberTypeDef subscriber;
+	if(Rover_Gateway_Connect(&subscriber, dir, argv[optind]) != ROVER_GATEWAY_OK){
+		perror(argv[optind]);
+		return 1;
+	}
+
+	uint64_t start = monitor_now();
+	uint64_t sent = 0;
+	int result = 0;
+	while(expected == 0 || monitor_received < expected){
+		//sending is interleaved with receiving, so ring of the gateway is never lapped by our own responses
+		if(frames_size > 0 && sent < repeat && sent < monitor_received + 64U){
+			if(Rover_Gateway_Send_Frames(&subscriber, frames, frames_size) != ROVER_GATEWAY_OK){
+				perror("send");
+				result = 1;
+				break;
+			}
+			sent++;
+			continue;
+		}
+
+		Rover_GatewayStatusTypeDef status = Rover_Gateway_Receive(&subscriber, MONITOR_TIMEOUT_MS, &monitor_frame, NULL);
+		if(status == ROVER_GATEWAY_TIMEOUT && expected > 0){
+			fprintf(stderr, "timeout, received %llu of %llu frames\n", (unsigned long long)monitor_received, (unsigned long long)expected);
+			result = 1;
+			break;
+		}
+		if(status == ROVER_GATEWAY_CLOSED || status == ROVER_GATEWAY_IO_ERROR){
+			fprintf(stderr, "gateway closed the connection\n");
+			result = 1;
+			break;
+		}
+	}
+
+	if(expected > 0){
+		double seconds = (monitor_now() - start) / 1e9;
+		fprintf(stderr, "%llu frames in %.3f s, %.0f frames/s, %llu overruns\n", (unsigned long long)monitor_received,
+				seconds, monitor_received / seconds, (unsigned long long)subscriber.Overruns);
+	}
+
+	Rover_Gateway_Disconnect(&subscriber);
+	return result;
+}
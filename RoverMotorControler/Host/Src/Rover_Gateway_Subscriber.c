@@ -0,0 +1,139 @@
+/*
+ * Rover_Gateway_Subscriber.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Gateway.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*Reads all frames from the ring which are new for the subscriber*/
+static void __subscriber_drain(Rover_Gateway_SubscriberTypeDef* pSubscriber, Rover_FrameCallbackTypeDef pCallback, void* pContext){
+	Rover_RingStatusTypeDef status;
+	while((status = Rover_Ring_Read(pSubscriber->pRing, &pSubscriber->Cursor, &pSubscriber->Slot)) != ROVER_RING_EMPTY){
+		if(status == ROVER_RING_OVERRUN){
+			pSubscriber->Overruns++;
+			continue;
+		}
+
+		const uint8_t* pFrame = pSubscriber->Slot.Frame;
+		if(pCallback != NULL && pSubscriber->Slot.Size >= ROVER_FRAME_HEADER_SIZE)
+			pCallback(pContext, pFrame[1], pFrame[2], &pFrame[ROVER_FRAME_HEADER_SIZE]);
+	}
+}
+
+Rover_GatewayStatusTypeDef Rover_Gateway_Connect(Rover_Gateway_SubscriberTypeDef* pSubscriber, const char* dir, const char* link){
+	if(pSubscriber == NULL || link == NULL)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	pSubscriber->pRing = NULL;
+	pSubscriber->Cursor = 0;
+	pSubscriber->Overruns = 0;
+
+	struct sockaddr_un address = {.sun_family = AF_UNIX};
+	if((size_t)snprintf(address.sun_path, sizeof(address.sun_path), "%s/%s.sock", dir != NULL ? dir : ROVER_GATEWAY_DEFAULT_DIR, link) >= sizeof(address.sun_path)){
+		errno = ENAMETOOLONG;
+		return ROVER_GATEWAY_IO_ERROR;
+	}
+
+	pSubscriber->Socket = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if(pSubscriber->Socket < 0)
+		return ROVER_GATEWAY_IO_ERROR;
+	if(connect(pSubscriber->Socket, (struct sockaddr*)&address, sizeof(address)) != 0){
+		Rover_Gateway_Disconnect(pSubscriber);
+		return ROVER_GATEWAY_IO_ERROR;
+	}
+
+	//first message is the name of the ring
+	char ring_name[ROVER_GATEWAY_MAX_NAME*2U];
+	ssize_t received = recv(pSubscriber->Socket, ring_name, sizeof(ring_name) - 1U, 0);
+	if(received <= 0){
+		Rover_Gateway_Disconnect(pSubscriber);
+		return received == 0 ? ROVER_GATEWAY_CLOSED : ROVER_GATEWAY_IO_ERROR;
+	}
+	ring_name[received] = '\0';
+
+	if(Rover_Ring_Open(ring_name, &pSubscriber->pRing) != ROVER_RING_OK){
+		Rover_Gateway_Disconnect(pSubscriber);
+		return ROVER_GATEWAY_IO_ERROR;
+	}
+
+	pSubscriber->Cursor = __atomic_load_n(&pSubscriber->pRing->WriteCount, __ATOMIC_ACQUIRE);
+	return ROVER_GATEWAY_OK;
+}
+
+Rover_GatewayStatusTypeDef Rover_Gateway_Send(Rover_Gateway_SubscriberTypeDef* pSubscriber, uint8_t ID, uint8_t len, const uint8_t* payload){
+	if(pSubscriber == NULL)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	uint8_t frame[ROVER_FRAME_MAX_ENCODED_SIZE];
+	size_t size;
+	if(Rover_Frame_Encode(frame, sizeof(frame), ROVER_FRAME_START, ID, len, payload, &size) != ROVER_FRAME_OK)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	return Rover_Gateway_Send_Frames(pSubscriber, frame, size);
+}
+
+Rover_GatewayStatusTypeDef Rover_Gateway_Send_Frames(Rover_Gateway_SubscriberTypeDef* pSubscriber, const uint8_t* frames, size_t size){
+	if(pSubscriber == NULL || frames == NULL)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	if(size > ROVER_GATEWAY_MAX_MESSAGE){
+		errno = EMSGSIZE;
+		return ROVER_GATEWAY_IO_ERROR;
+	}
+
+	while(send(pSubscriber->Socket, frames, size, MSG_NOSIGNAL) < 0){
+		if(errno == EINTR)
+			continue;
+		return errno == EPIPE ? ROVER_GATEWAY_CLOSED : ROVER_GATEWAY_IO_ERROR;
+	}
+
+	return ROVER_GATEWAY_OK;
+}
+
+Rover_GatewayStatusTypeDef Rover_Gateway_Receive(Rover_Gateway_SubscriberTypeDef* pSubscriber, int timeout_ms, Rover_FrameCallbackTypeDef pCallback, void* pContext){
+	if(pSubscriber == NULL)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	//frames can already be there, notification of them may have been consumed by previous call
+	uint64_t written = __atomic_load_n(&pSubscriber->pRing->WriteCount, __ATOMIC_ACQUIRE);
+	if(written == pSubscriber->Cursor){
+		struct pollfd fd = {.fd = pSubscriber->Socket, .events = POLLIN};
+		int ready = poll(&fd, 1, timeout_ms);
+		if(ready < 0)
+			return errno == EINTR ? ROVER_GATEWAY_TIMEOUT : ROVER_GATEWAY_IO_ERROR;
+		if(ready == 0)
+			return ROVER_GATEWAY_TIMEOUT;
+	}
+
+	//notifications only wake us up, ring tells what is new
+	uint64_t notification;
+	ssize_t received;
+	while((received = recv(pSubscriber->Socket, &notification, sizeof(notification), MSG_DONTWAIT)) > 0);
+	if(received == 0)
+		return ROVER_GATEWAY_CLOSED;
+
+	__subscriber_drain(pSubscriber, pCallback, pContext);
+	return ROVER_GATEWAY_OK;
+}
+
+Rover_GatewayStatusTypeDef Rover_Gateway_Disconnect(Rover_Gateway_SubscriberTypeDef* pSubscriber){
+	if(pSubscriber == NULL)
+		return ROVER_GATEWAY_NULL_ERROR;
+
+	if(pSubscriber->pRing != NULL)
+		Rover_Ring_Close(pSubscriber->pRing);
+	if(pSubscriber->Socket >= 0)
+		close(pSubscriber->Socket);
+	pSubscriber->pRing = NULL;
+	pSubscriber->Socket = -1;
+
+	return ROVER_GATEWAY_OK;
+}
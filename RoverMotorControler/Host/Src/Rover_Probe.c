@@ -0,0 +1,432 @@
+/*
+ * Rover_Probe.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Client.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Link measurement with probe frames handled by UART_Communication itself (no firmware callbacks)
+ * usage: Rover_Probe [-m echo|sink|source|trace] [-s size] [-n count] [-w window] [-r rate] port[@baud]
+ * 	-m echo   - frames of size bytes are echoed back, window frames in flight (1 measures pure round trip),
+ * 	            reports RTT percentiles and goodput (payload bytes returned per second)
+ * 	   sink   - frames of size bytes are discarded and counted by the library, empty echo frame at the end
+ * 	            returns when all of them were processed, statistics request confirms how many were accepted,
+ * 	            reports sustained command rate and goodput
+ * 	   source - library generates count*size bytes in frames of size bytes, every byte is checked,
+ * 	            reports time to the first frame and goodput
+ * 	   trace  - reads all pages of the latency trace (0xF1) and reports p50/p90/p99/max of every stage of the traced
+ * 	            frames: first byte -> last byte -> parsed -> dispatch -> callback return (trace requests are left out)
+ * 	-r frames per second sent in echo and sink modes (0 - as fast as possible)
+ * Payloads follow generated stream of UART_SourceTypeDef, so every received byte can be checked.
+ * */
+#define PROBE_DEFAULT_SIZE 16U
+#define PROBE_DEFAULT_COUNT 1000U
+#define PROBE_TIMEOUT_MS 2000
+
+/*IDs and offsets of UART_Communication.h*/
+#define PROBE_STATISTICS_ID 0xF0U
+#define PROBE_ECHO_ID 0xF2U
+#define PROBE_SINK_ID 0xF3U
+#define PROBE_SOURCE_ID 0xF4U
+#define PROBE_TRACE_ID 0xF1U
+/*Trace page: page (u8), page count (u8), SystemCoreClock (u32), records of UART_TraceRecordTypeDef*/
+#define PROBE_TRACE_HEADER_SIZE 6U
+#define PROBE_TRACE_RECORD_SIZE 28U
+/*Records kept by the host, UART_TRACE_DEPTH of the firmware with space for overlapping pages*/
+#define PROBE_TRACE_MAX_RECORDS 64U
+#define PROBE_TRACE_STAGES 5U
+#define PROBE_RX_DISCARDED_OFFSET 8U
+#define PROBE_SINK_FRAMES_OFFSET 60U
+#define PROBE_SINK_BYTES_OFFSET 64U
+
+typedef enum {
+	PROBE_ECHO,
+	PROBE_SINK,
+	PROBE_SOURCE,
+	PROBE_TRACE
+} Probe_ModeTypeDef;
+
+/*Same layout as UART_TraceRecordTypeDef, values are cycle counter values*/
+typedef struct {
+	uint32_t Sequence;
+	uint8_t ID;
+	uint8_t Length;
+	uint8_t Flags;
+	uint8_t Reserved;
+	uint32_t FirstByte;
+	uint32_t LastByte;
+	uint32_t Parsed;
+	uint32_t DispatchStart;
+	uint32_t CallbackReturn;
+} Probe_TraceRecordTypeDef;
+_Static_assert(sizeof(Probe_TraceRecordTypeDef) == PROBE_TRACE_RECORD_SIZE, "Probe_TraceRecordTypeDef must match UART_TraceRecordTypeDef");
+
+static Rover_ClientTypeDef client;
+static Probe_ModeTypeDef probe_mode = PROBE_ECHO;
+
+static uint8_t probe_size = PROBE_DEFAULT_SIZE;
+static uint32_t probe_count = PROBE_DEFAULT_COUNT;
+static uint32_t probe_window = 1;
+static uint32_t probe_rate;
+
+//echo: send time of every frame, responses come in order
+static uint64_t* probe_sent_at;
+static uint64_t* probe_rtt;
+static uint64_t probe_responses;
+//sink: empty echo frames sent after the measured frames
+static uint64_t probe_barriers;
+//source: offset of the next expected byte
+static uint64_t probe_offset;
+static uint64_t probe_first_frame;
+static uint64_t probe_errors;
+//statistics response
+static uint64_t probe_statistics_responses;
+static uint32_t probe_sink_frames;
+static uint32_t probe_sink_bytes;
+static uint32_t probe_rx_discarded;
+//trace: records of all pages (each sequence once), page count and clock of the last page
+static Probe_TraceRecordTypeDef probe_trace_records[PROBE_TRACE_MAX_RECORDS];
+static uint32_t probe_trace_count;
+static uint64_t probe_trace_responses;
+static uint8_t probe_trace_pages;
+static uint32_t probe_trace_clock;
+
+static uint64_t probe_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+/*Same pattern as UART_SourceTypeDef*/
+static uint8_t probe_byte(uint64_t offset){
+	uint8_t byte = (uint8_t)offset;
+	return byte == ROVER_FRAME_START ? (uint8_t)~byte : byte;
+}
+
+static void probe_payload(uint8_t* payload, uint64_t offset, uint8_t len){
+	for(uint8_t i = 0; i < len; i++)
+		payload[i] = probe_byte(offset + i);
+}
+
+static void probe_callback(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	switch(ID){
+		case PROBE_ECHO_ID: {
+			if(probe_mode != PROBE_ECHO){
+				probe_barriers++;
+				break;
+			}
+			uint8_t expected[ROVER_FRAME_MAX_PAYLOAD];
+			probe_payload(expected, probe_responses * probe_size, probe_size);
+			if(len != probe_size || memcmp(payload, expected, len) != 0)
+				probe_errors++;
+			if(probe_responses < probe_count)
+				probe_rtt[probe_responses] = probe_now() - probe_sent_at[probe_responses];
+			probe_responses++;
+			break;
+		}
+		case PROBE_SOURCE_ID:
+			if(probe_offset == 0)
+				probe_first_frame = probe_now();
+			for(uint8_t i = 0; i < len; i++){
+				if(payload[i] != probe_byte(probe_offset + i))
+					probe_errors++;
+			}
+			probe_offset += len;
+			probe_responses++;
+			break;
+		case PROBE_TRACE_ID:
+			if(len >= PROBE_TRACE_HEADER_SIZE){
+				probe_trace_pages = payload[1];
+				memcpy(&probe_trace_clock, &payload[2], sizeof(uint32_t));
+				for(uint32_t offset = PROBE_TRACE_HEADER_SIZE; offset + PROBE_TRACE_RECORD_SIZE <= len; offset += PROBE_TRACE_RECORD_SIZE){
+					Probe_TraceRecordTypeDef record;
+					memcpy(&record, &payload[offset], sizeof(record));
+					uint32_t i = 0;
+					while(i < probe_trace_count && probe_trace_records[i].Sequence != record.Sequence)
+						i++;
+					if(i == probe_trace_count && probe_trace_count < PROBE_TRACE_MAX_RECORDS)
+						probe_trace_records[probe_trace_count++] = record;
+				}
+			}
+			probe_trace_responses++;
+			break;
+		case PROBE_STATISTICS_ID:
+			if(len >= PROBE_SINK_BYTES_OFFSET + sizeof(uint32_t)){
+				memcpy(&probe_rx_discarded, &payload[PROBE_RX_DISCARDED_OFFSET], sizeof(uint32_t));
+				memcpy(&probe_sink_frames, &payload[PROBE_SINK_FRAMES_OFFSET], sizeof(uint32_t));
+				memcpy(&probe_sink_bytes, &payload[PROBE_SINK_BYTES_OFFSET], sizeof(uint32_t));
+			}
+			probe_statistics_responses++;
+			break;
+		default:
+			break;
+	}
+}
+
+/*Polls until counter reaches the value*/
+static int probe_wait(uint64_t* pCounter, uint64_t value){
+	while(*pCounter < value){
+		if(Rover_Client_Poll(&client, PROBE_TIMEOUT_MS) != ROVER_CLIENT_OK){
+			fprintf(stderr, "timeout, %llu of %llu responses\n", (unsigned long long)*pCounter, (unsigned long long)value);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int probe_send(uint8_t ID, uint8_t len, const uint8_t* payload){
+	Rover_ClientStatusTypeDef status;
+	while((status = Rover_Client_Send(&client, ID, len, payload)) == ROVER_CLIENT_BUFFER_FULL){
+		if(Rover_Client_Poll(&client, PROBE_TIMEOUT_MS) != ROVER_CLIENT_OK)
+			return -1;
+	}
+	return status == ROVER_CLIENT_OK ? 0 : -1;
+}
+
+/*Sends and receives what is ready, with rate limit waits (polling) until time of the frame*/
+static void probe_pace(uint64_t start, uint32_t frame){
+	if(probe_rate == 0){
+		Rover_Client_Poll(&client, 0);
+		return;
+	}
+
+	uint64_t due = start + (uint64_t)frame * 1000000000U / probe_rate;
+	uint64_t now;
+	while((now = probe_now()) < due){
+		int timeout = (int)((due - now) / 1000000U);
+		Rover_Client_Poll(&client, timeout);
+	}
+}
+
+static int probe_compare(const void* a, const void* b){
+	uint64_t x = *(const uint64_t*)a;
+	uint64_t y = *(const uint64_t*)b;
+	return x < y ? -1 : x > y;
+}
+
+/*Returns when all frames sent before were processed by the library*/
+static int probe_barrier(void){
+	if(probe_send(PROBE_ECHO_ID, 0, NULL) != 0)
+		return -1;
+	return probe_wait(&probe_barriers, probe_barriers + 1);
+}
+
+static int probe_statistics(void){
+	uint8_t reset = 0;
+	if(probe_send(PROBE_STATISTICS_ID, 1, &reset) != 0)
+		return -1;
+	return probe_wait(&probe_statistics_responses, probe_statistics_responses + 1);
+}
+
+static int probe_echo(void){
+	probe_sent_at = malloc(sizeof(uint64_t) * probe_count);
+	probe_rtt = malloc(sizeof(uint64_t) * probe_count);
+	if(probe_sent_at == NULL || probe_rtt == NULL)
+		return -1;
+
+	uint8_t payload[ROVER_FRAME_MAX_PAYLOAD];
+	uint64_t start = probe_now();
+	for(uint32_t i = 0; i < probe_count; i++){
+		//keep at most window frames in flight
+		if(i >= probe_window && probe_wait(&probe_responses, i - probe_window + 1U) != 0)
+			return -1;
+
+		probe_payload(payload, (uint64_t)i * probe_size, probe_size);
+		probe_sent_at[i] = probe_now();
+		if(probe_send(PROBE_ECHO_ID, probe_size, payload) != 0)
+			return -1;
+		probe_pace(start, i + 1U);
+	}
+	if(probe_wait(&probe_responses, probe_count) != 0)
+		return -1;
+	double seconds = (double)(probe_now() - start) / 1e9;
+
+	qsort(probe_rtt, probe_count, sizeof(uint64_t), &probe_compare);
+	printf("echo %u frames of %u bytes, window %u: %.0f frames/s, goodput %.1f kB/s, %llu bad payloads\n",
+			(unsigned)probe_count, (unsigned)probe_size, (unsigned)probe_window, probe_count / seconds,
+			(double)probe_count * probe_size / seconds / 1e3, (unsigned long long)probe_errors);
+	printf("rtt  p50 %8.1f us  p90 %8.1f us  p99 %8.1f us  max %8.1f us\n", probe_rtt[probe_count / 2] / 1e3,
+			probe_rtt[probe_count * 9 / 10] / 1e3, probe_rtt[probe_count * 99 / 100] / 1e3, probe_rtt[probe_count - 1] / 1e3);
+	return probe_errors == 0 ? 0 : -1;
+}
+
+static int probe_sink(void){
+	uint8_t payload[ROVER_FRAME_MAX_PAYLOAD];
+
+	//clear counters, so sink counters start from zero
+	uint8_t reset = 1;
+	if(probe_send(PROBE_STATISTICS_ID, 1, &reset) != 0 || probe_barrier() != 0)
+		return -1;
+
+	uint64_t start = probe_now();
+	for(uint32_t i = 0; i < probe_count; i++){
+		probe_pace(start, i);
+		probe_payload(payload, (uint64_t)i * probe_size, probe_size);
+		if(probe_send(PROBE_SINK_ID, probe_size, payload) != 0)
+			return -1;
+	}
+	if(probe_barrier() != 0)
+		return -1;
+	double seconds = (double)(probe_now() - start) / 1e9;
+
+	if(probe_statistics() != 0){
+		printf("sink %u frames of %u bytes: %.0f frames/s, %.1f kB/s, no statistics response\n",
+				(unsigned)probe_count, (unsigned)probe_size, probe_count / seconds, (double)probe_count * probe_size / seconds / 1e3);
+		return -1;
+	}
+	printf("sink %u frames of %u bytes: %u accepted, %u bytes, %u received bytes discarded\n",
+			(unsigned)probe_count, (unsigned)probe_size, (unsigned)probe_sink_frames, (unsigned)probe_sink_bytes, (unsigned)probe_rx_discarded);
+	printf("sustained %.0f frames/s, goodput %.1f kB/s\n", probe_sink_frames / seconds, probe_sink_bytes / seconds / 1e3);
+	return probe_sink_frames == probe_count ? 0 : -1;
+}
+
+static int probe_source(void){
+	uint64_t total = (uint64_t)probe_count * probe_size;
+	if(total > UINT32_MAX || probe_size == 0)
+		return -1;
+
+	uint8_t request[5];
+	uint32_t total32 = (uint32_t)total;
+	memcpy(request, &total32, sizeof(total32));
+	request[4] = probe_size;
+
+	uint64_t start = probe_now();
+	if(probe_send(PROBE_SOURCE_ID, sizeof(request), request) != 0 || probe_wait(&probe_offset, total) != 0)
+		return -1;
+	uint64_t end = probe_now();
+
+	printf("source %llu bytes in %llu frames of up to %u bytes: first frame after %.1f us, goodput %.1f kB/s, %llu bad bytes\n",
+			(unsigned long long)total, (unsigned long long)probe_responses, (unsigned)probe_size, (double)(probe_first_frame - start) / 1e3,
+			(double)total / ((double)(end - start) / 1e9) / 1e3, (unsigned long long)probe_errors);
+	return probe_errors == 0 ? 0 : -1;
+}
+
+static int probe_trace(void){
+	//first page gives page count, the rest is read from the newest page, every request is traced at the end
+	//and moves older records one position towards page 0, so pages read later overlap the previous ones instead of leaving gaps
+	uint8_t page = 0;
+	if(probe_send(PROBE_TRACE_ID, 1, &page) != 0 || probe_wait(&probe_trace_responses, 1) != 0)
+		return -1;
+	for(int i = (int)probe_trace_pages - 1; i > 0; i--){
+		page = (uint8_t)i;
+		if(probe_send(PROBE_TRACE_ID, 1, &page) != 0 || probe_wait(&probe_trace_responses, probe_trace_responses + 1) != 0)
+			return -1;
+	}
+	if(probe_trace_clock == 0)
+		return -1;
+
+	//cycles of every stage, 32bit differences are correct across counter wrap
+	static const char* names[PROBE_TRACE_STAGES] = {"receive", "parse", "dispatch", "callback", "total"};
+	uint64_t stages[PROBE_TRACE_STAGES][PROBE_TRACE_MAX_RECORDS];
+	uint32_t count = 0;
+	for(uint32_t i = 0; i < probe_trace_count; i++){
+		const Probe_TraceRecordTypeDef* pRecord = &probe_trace_records[i];
+		if(pRecord->ID == PROBE_TRACE_ID)
+			continue;
+		stages[0][count] = (uint32_t)(pRecord->LastByte - pRecord->FirstByte);
+		stages[1][count] = (uint32_t)(pRecord->Parsed - pRecord->LastByte);
+		stages[2][count] = (uint32_t)(pRecord->DispatchStart - pRecord->Parsed);
+		stages[3][count] = (uint32_t)(pRecord->CallbackReturn - pRecord->DispatchStart);
+		stages[4][count] = (uint32_t)(pRecord->CallbackReturn - pRecord->FirstByte);
+		count++;
+	}
+
+	printf("trace %u pages, %u frames (trace requests left out), SystemCoreClock %u Hz\n",
+			(unsigned)probe_trace_pages, (unsigned)count, (unsigned)probe_trace_clock);
+	if(count == 0)
+		return 0;
+
+	double us = 1e6 / probe_trace_clock;
+	for(uint32_t s = 0; s < PROBE_TRACE_STAGES; s++){
+		qsort(stages[s], count, sizeof(uint64_t), &probe_compare);
+		printf("%-9s p50 %8.2f us  p90 %8.2f us  p99 %8.2f us  max %8.2f us\n", names[s], stages[s][count / 2] * us,
+				stages[s][count * 9 / 10] * us, stages[s][count * 99 / 100] * us, stages[s][count - 1] * us);
+	}
+	return 0;
+}
+
+int main(int argc, char** argv){
+	int option;
+	while((option = getopt(argc, argv, "m:s:n:w:r:")) != -1){
+		switch(option){
+			case 'm':
+				if(strcmp(optarg, "echo") == 0)
+					probe_mode = PROBE_ECHO;
+				else if(strcmp(optarg, "sink") == 0)
+					probe_mode = PROBE_SINK;
+				else if(strcmp(optarg, "source") == 0)
+					probe_mode = PROBE_SOURCE;
+				else if(strcmp(optarg, "trace") == 0)
+					probe_mode = PROBE_TRACE;
+				else
+					optind = argc + 1;
+				break;
+			case 's':
+				probe_size = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'n':
+				probe_count = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'w':
+				probe_window = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			case 'r':
+				probe_rate = (uint32_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if(optind != argc - 1 || probe_count == 0 || probe_window == 0){
+		fprintf(stderr, "usage: %s [-m echo|sink|source|trace] [-s size] [-n count] [-w window] [-r rate] port[@baud]\n", argv[0]);
+		return 2;
+	}
+
+	char path[256];
+	snprintf(path, sizeof(path), "%s", argv[optind]);
+	uint32_t baud = 0;
+	char* pAt = strrchr(path, '@');
+	if(pAt != NULL){
+		*pAt = '\0';
+		baud = (uint32_t)strtoul(pAt + 1, NULL, 10);
+	}
+
+	if(Rover_Client_Open(&client, path, baud, &probe_callback, NULL) != ROVER_CLIENT_OK){
+		perror(path);
+		return 1;
+	}
+
+	int result;
+	switch(probe_mode){
+		case PROBE_SINK:
+			result = probe_sink();
+			break;
+		case PROBE_SOURCE:
+			result = probe_source();
+			break;
+		case PROBE_TRACE:
+			result = probe_trace();
+			break;
+		default:
+			result = probe_echo();
+			break;
+	}
+
+	Rover_Client_Close(&client);
+	free(probe_sent_at);
+	free(probe_rtt);
+
+	if(result != 0){
+		fprintf(stderr, "probe failed\n");
+		return 1;
+	}
+	return 0;
+}
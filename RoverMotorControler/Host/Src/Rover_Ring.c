@@ -0,0 +1,145 @@
+/*
+ * Rover_Ring.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Rover_Ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+static size_t __ring_size(uint32_t slot_count){
+	return sizeof(Rover_RingTypeDef) + (size_t)slot_count * sizeof(Rover_RingSlotTypeDef);
+}
+
+Rover_RingStatusTypeDef Rover_Ring_Create(const char* name, uint32_t slot_count, Rover_RingTypeDef** ppRing){
+	if(name == NULL || ppRing == NULL || slot_count == 0)
+		return ROVER_RING_NULL_ERROR;
+
+	//readers of previous instance keep their (stale) mapping, new readers get new ring
+	shm_unlink(name);
+	int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+	if(fd < 0)
+		return ROVER_RING_IO_ERROR;
+
+	size_t size = __ring_size(slot_count);
+	if(ftruncate(fd, (off_t)size) != 0){
+		close(fd);
+		return ROVER_RING_IO_ERROR;
+	}
+
+	void* pMemory = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if(pMemory == MAP_FAILED)
+		return ROVER_RING_IO_ERROR;
+
+	//ftruncate() fills the memory with zeros, so all slots are empty
+	Rover_RingTypeDef* pRing = pMemory;
+	pRing->SlotCount = slot_count;
+	pRing->WriteCount = 0;
+	__atomic_store_n(&pRing->Magic, ROVER_RING_MAGIC, __ATOMIC_RELEASE);
+
+	(*ppRing) = pRing;
+	return ROVER_RING_OK;
+}
+
+Rover_RingStatusTypeDef Rover_Ring_Open(const char* name, Rover_RingTypeDef** ppRing){
+	if(name == NULL || ppRing == NULL)
+		return ROVER_RING_NULL_ERROR;
+
+	int fd = shm_open(name, O_RDONLY | O_CLOEXEC, 0);
+	if(fd < 0)
+		return ROVER_RING_IO_ERROR;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Rover_RingTypeDef)){
+		close(fd);
+		errno = EINVAL;
+		return ROVER_RING_IO_ERROR;
+	}
+
+	void* pMemory = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if(pMemory == MAP_FAILED)
+		return ROVER_RING_IO_ERROR;
+
+	Rover_RingTypeDef* pRing = pMemory;
+	if(__atomic_load_n(&pRing->Magic, __ATOMIC_ACQUIRE) != ROVER_RING_MAGIC || __ring_size(pRing->SlotCount) > (size_t)st.st_size){
+		munmap(pMemory, (size_t)st.st_size);
+		errno = EINVAL;
+		return ROVER_RING_IO_ERROR;
+	}
+
+	(*ppRing) = pRing;
+	return ROVER_RING_OK;
+}
+
+Rover_RingStatusTypeDef Rover_Ring_Close(Rover_RingTypeDef* pRing){
+	if(pRing == NULL)
+		return ROVER_RING_NULL_ERROR;
+
+	munmap(pRing, __ring_size(pRing->SlotCount));
+	return ROVER_RING_OK;
+}
+
+Rover_RingStatusTypeDef Rover_Ring_Push(Rover_RingTypeDef* pRing, uint64_t timestamp, const uint8_t* frame, uint16_t size){
+	if(pRing == NULL || frame == NULL || size > ROVER_FRAME_MAX_SIZE)
+		return ROVER_RING_NULL_ERROR;
+
+	uint64_t number = pRing->WriteCount;
+	Rover_RingSlotTypeDef* pSlot = &pRing->Slots[number % pRing->SlotCount];
+
+	//readers which copy the slot right now will see changed Sequence
+	__atomic_store_n(&pSlot->Sequence, 0, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	pSlot->Timestamp = timestamp;
+	pSlot->Size = size;
+	memcpy(pSlot->Frame, frame, size);
+
+	__atomic_store_n(&pSlot->Sequence, number + 1U, __ATOMIC_RELEASE);
+	__atomic_store_n(&pRing->WriteCount, number + 1U, __ATOMIC_RELEASE);
+
+	return ROVER_RING_OK;
+}
+
+Rover_RingStatusTypeDef Rover_Ring_Read(const Rover_RingTypeDef* pRing, uint64_t* pCursor, Rover_RingSlotTypeDef* pSlot){
+	if(pRing == NULL || pCursor == NULL || pSlot == NULL)
+		return ROVER_RING_NULL_ERROR;
+
+	uint64_t written = __atomic_load_n(&pRing->WriteCount, __ATOMIC_ACQUIRE);
+	if(*pCursor == written)
+		return ROVER_RING_EMPTY;
+
+	//reader is more than whole ring behind, oldest frame which can still be valid is written - SlotCount
+	//(cursor newer than WriteCount means ring was recreated)
+	if(written - *pCursor > pRing->SlotCount || *pCursor > written){
+		(*pCursor) = written > pRing->SlotCount ? written - pRing->SlotCount + 1U : 0;
+		return ROVER_RING_OVERRUN;
+	}
+
+	const Rover_RingSlotTypeDef* pShared = &pRing->Slots[*pCursor % pRing->SlotCount];
+	uint64_t sequence = __atomic_load_n(&pShared->Sequence, __ATOMIC_ACQUIRE);
+	if(sequence == *pCursor + 1U){
+		pSlot->Timestamp = pShared->Timestamp;
+		pSlot->Size = pShared->Size <= ROVER_FRAME_MAX_SIZE ? pShared->Size : ROVER_FRAME_MAX_SIZE;
+		memcpy(pSlot->Frame, pShared->Frame, pSlot->Size);
+		pSlot->Sequence = sequence;
+
+		//copy is valid only if writer didn't start rewriting the slot in the meantime
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		if(__atomic_load_n(&pShared->Sequence, __ATOMIC_RELAXED) == sequence){
+			(*pCursor)++;
+			return ROVER_RING_OK;
+		}
+	}
+
+	//slot was overwritten, skip to the oldest frame which is not being written
+	written = __atomic_load_n(&pRing->WriteCount, __ATOMIC_ACQUIRE);
+	(*pCursor) = written > pRing->SlotCount ? written - pRing->SlotCount + 1U : 0;
+	return ROVER_RING_OVERRUN;
+}
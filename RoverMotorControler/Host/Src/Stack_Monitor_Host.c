@@ -0,0 +1,59 @@
+/*
+ * Stack_Monitor_Host.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "Stack_Monitor.h"
+
+/*
+ * Host version of Stack_Monitor.c, there is no painted stack and no _estack on the host,
+ * so only sampled depths (measured from the frame of Stack_Monitor_Init()) are reported,
+ * StackSize, HighWater and Threshold are always 0
+ * */
+
+/*Frame address of Stack_Monitor_Init(), it is called at the beginning of main()*/
+static uintptr_t stack_top;
+static uint32_t stack_thread_depth_max;
+static uint32_t stack_handler_depth_max;
+
+void Stack_Monitor_Init(void){
+	stack_top = (uintptr_t)__builtin_frame_address(0);
+	stack_thread_depth_max = 0;
+	stack_handler_depth_max = 0;
+}
+
+bool Stack_Monitor_Check(void){
+	return false;
+}
+
+void Stack_Monitor_Sample(void){
+	uintptr_t frame = (uintptr_t)__builtin_frame_address(0);
+	uint32_t depth = frame < stack_top ? (uint32_t)(stack_top - frame) : 0U;
+
+	if(__get_IPSR() == 0U){
+		if(depth > stack_thread_depth_max)
+			stack_thread_depth_max = depth;
+	} else {
+		if(depth > stack_handler_depth_max)
+			stack_handler_depth_max = depth;
+	}
+}
+
+void Stack_Monitor_Get(Stack_MonitorTypeDef* pStats){
+	if(pStats == NULL)
+		return;
+
+	pStats->StackSize = 0;
+	pStats->HighWater = 0;
+	pStats->Threshold = 0;
+	pStats->ThresholdFaults = 0;
+	pStats->ThreadDepthMax = stack_thread_depth_max;
+	pStats->HandlerDepthMax = stack_handler_depth_max;
+}
+
+UART_CommunicationStatusTypeDef Stack_Monitor_Transmit(UART_CommunicationTypeDef* pCommunication, uint8_t ID){
+	Stack_MonitorTypeDef stats;
+	Stack_Monitor_Get(&stats);
+
+	return UART_Communication_Transmit_Frame(pCommunication, ID, sizeof(stats), (uint8_t*)&stats);
+}
@@ -0,0 +1,195 @@
+/*
+ * UART_Benchmark.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+#include "UART_Queue.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/*
+ * Host benchmark of Core/Utils, every case processes about BENCHMARK_BYTES bytes
+ * (can be changed by the first argument) and reports:
+ * 	- frames/s (queue cases report bytes only)
+ * 	- MB/s
+ * 	- ns/byte
+ * Cases:
+ * 	1. queue - enqueue and dequeue of bytes in batches, no parsing
+ * 	2. rx - frames delivered by receive interrupt emulation (in BENCHMARK_BURST_SIZE bursts)
+ * 	   and parsed by UART_Communication_Update()
+ * 	3. tx - frames enqueued by UART_Communication_Transmit_Frame() and sent through transmit interrupt chain
+ * */
+#define BENCHMARK_BYTES (1U << 22)
+//largest frame (3 + 255 bytes) has to fit in write queue at once, UART_Communication_Transmit_Frame() is all-or-nothing
+#define BENCHMARK_QUEUE_SIZE 512U
+#define BENCHMARK_BURST_SIZE 64U
+#define BENCHMARK_FRAME_START 0x3C
+#define BENCHMARK_ID 0x10
+
+static UART_HandleTypeDef huart;
+static UART_CommunicationTypeDef uart_communication;
+
+static uint32_t dispatched_frames;
+static uint32_t transmitted_bytes;
+
+/*Payload sizes of rx/tx cases, 255 is the largest frame protocol allows*/
+static const uint8_t payload_sizes[] = {0, 1, 4, 16, 64, 128, 255};
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Receive_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Transmit_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Error_Interrupt_Callback(&uart_communication);
+}
+
+static void benchmark_callback(uint8_t len, uint8_t* payload){
+	dispatched_frames++;
+}
+
+static uint8_t benchmark_tx_sink(UART_HandleTypeDef* huart, uint8_t byte){
+	transmitted_bytes++;
+	return 1U;
+}
+
+static uint64_t benchmark_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+static void benchmark_report(const char* name, uint32_t payload, uint32_t frames, uint64_t bytes, uint64_t ns){
+	double seconds = (double)ns / 1e9;
+	if(frames > 0)
+		printf("%-6s %8u %12.0f %10.2f %10.2f\n", name, (unsigned)payload, frames / seconds, bytes / seconds / 1e6, (double)ns / bytes);
+	else
+		printf("%-6s %8s %12s %10.2f %10.2f\n", name, "-", "-", bytes / seconds / 1e6, (double)ns / bytes);
+}
+
+/*Bytes go through the queue in batches, like bursts received between two main loop iterations*/
+static int benchmark_queue(uint32_t total_bytes){
+	UART_QueueTypeDef queue;
+	if(UART_Queue_Init(&queue, BENCHMARK_QUEUE_SIZE) != QUEUE_OK)
+		return -1;
+
+	uint32_t checksum = 0;
+	uint64_t start = benchmark_now();
+	for(uint32_t done = 0; done < total_bytes; done += 64U){
+		for(uint32_t i = 0; i < 64U; i++)
+			UART_Queue_Enqueue(&queue, (uint8_t)i);
+		uint8_t byte;
+		while(UART_Queue_Dequeue(&queue, &byte) == QUEUE_OK)
+			checksum += byte;
+	}
+	uint64_t elapsed = benchmark_now() - start;
+
+	UART_Queue_Dispose(&queue);
+	if(checksum != (total_bytes / 64U + (total_bytes % 64U != 0)) * (63U*64U/2U))
+		return -1;
+
+	benchmark_report("queue", 0, 0, (total_bytes + 63U) / 64U * 64U, elapsed);
+	return 0;
+}
+
+/*Frame is received in bursts and parsed before the next burst, so read queue never overflows*/
+static int benchmark_rx(uint8_t payload_size, uint32_t total_bytes){
+	uint8_t frame[3U + 255U];
+	uint32_t frame_size = 3U + payload_size;
+	uint32_t frames = total_bytes / frame_size + 1U;
+
+	frame[0] = BENCHMARK_FRAME_START;
+	frame[1] = BENCHMARK_ID;
+	frame[2] = payload_size;
+	//payload must not contain frame start, parser would restart the frame
+	memset(&frame[3], 0x55, payload_size);
+
+	dispatched_frames = 0;
+	uint64_t start = benchmark_now();
+	for(uint32_t i = 0; i < frames; i++){
+		//main loop drains read queue between bursts of received bytes
+		for(uint32_t offset = 0; offset < frame_size; offset += BENCHMARK_BURST_SIZE){
+			uint32_t burst = frame_size - offset < BENCHMARK_BURST_SIZE ? frame_size - offset : BENCHMARK_BURST_SIZE;
+			HAL_Stub_UART_Receive(&huart, &frame[offset], burst);
+			while(uart_communication.ReadBytesQueue.Size > 0)
+				UART_Communication_Update(&uart_communication);
+		}
+	}
+	uint64_t elapsed = benchmark_now() - start;
+
+	if(dispatched_frames != frames)
+		return -1;
+
+	benchmark_report("rx", payload_size, frames, (uint64_t)frames*frame_size, elapsed);
+	return 0;
+}
+
+/*Single frame is enqueued and sent at a time, write queue is drained by the transmit chain*/
+static int benchmark_tx(uint8_t payload_size, uint32_t total_bytes){
+	uint8_t payload[255];
+	uint32_t frame_size = 3U + payload_size;
+	uint32_t frames = total_bytes / frame_size + 1U;
+
+	memset(payload, 0x55, payload_size);
+
+	transmitted_bytes = 0;
+	uint64_t start = benchmark_now();
+	for(uint32_t i = 0; i < frames; i++){
+		if(UART_Communication_Transmit_Frame(&uart_communication, BENCHMARK_ID, payload_size, payload) != COMMUNICATION_OK)
+			return -1;
+		bool idle = false;
+		while(!idle){
+			UART_Communication_Update(&uart_communication);
+			UART_Communication_Is_Idle(&uart_communication, &idle);
+		}
+	}
+	uint64_t elapsed = benchmark_now() - start;
+
+	if(transmitted_bytes != frames*frame_size)
+		return -1;
+
+	benchmark_report("tx", payload_size, frames, (uint64_t)frames*frame_size, elapsed);
+	return 0;
+}
+
+int main(int argc, char** argv){
+	uint32_t total_bytes = BENCHMARK_BYTES;
+	if(argc > 1)
+		total_bytes = (uint32_t)strtoul(argv[1], NULL, 0);
+	if(total_bytes == 0){
+		fprintf(stderr, "usage: %s [bytes per case]\n", argv[0]);
+		return 2;
+	}
+
+	memset(&huart, 0, sizeof(huart));
+	huart.pTxSink = &benchmark_tx_sink;
+
+	if(UART_Communication_Init(&uart_communication, &huart, BENCHMARK_FRAME_START, BENCHMARK_QUEUE_SIZE) != COMMUNICATION_OK)
+		return 1;
+	if(UART_Communication_Register_Callback(&uart_communication, BENCHMARK_ID, &benchmark_callback) != COMMUNICATION_OK)
+		return 1;
+
+	printf("%-6s %8s %12s %10s %10s\n", "case", "payload", "frames/s", "MB/s", "ns/byte");
+
+	int result = benchmark_queue(total_bytes);
+	for(uint32_t i = 0; i < sizeof(payload_sizes) && result == 0; i++)
+		result = benchmark_rx(payload_sizes[i], total_bytes);
+	for(uint32_t i = 0; i < sizeof(payload_sizes) && result == 0; i++)
+		result = benchmark_tx(payload_sizes[i], total_bytes);
+
+	UART_Communication_Clean(&uart_communication);
+
+	if(result != 0){
+		fprintf(stderr, "benchmark failed, frames or bytes were lost\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,242 @@
+/*
+ * UART_Check.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/*
+ * Host checks of Core/Utils behaviour which the benchmark doesn't cover, every case starts with a fresh library
+ * and prints "ok" or what went wrong:
+ * 	1. line errors (HAL_Stub_UART_Error()) on the last byte, in the middle and after a complete frame,
+ * 	   damaged frames are dropped and counted in ErrorFramesDropped, frames completed before the error are dispatched
+ * 	2. length checks: empty length range is refused, frames rejected by UART_Communication_Reject_Length() from their
+ * 	   callback are counted in FramesBadLength instead of FramesDispatched
+ * 	3. escaping: frames transmitted with frame start and escape byte in the payload contain only one frame start,
+ * 	   received back they are dispatched unchanged, also when the payload is skipped (unregistered ID)
+ * */
+#define CHECK_QUEUE_SIZE 512U
+#define CHECK_FRAME_START 0x3C
+#define CHECK_ID 0x10
+
+static UART_HandleTypeDef huart;
+static UART_CommunicationTypeDef uart_communication;
+
+static uint32_t dispatched_frames;
+static uint8_t dispatched_payload[255];
+static uint8_t dispatched_len;
+
+/*Bytes passed to the transmit sink*/
+static uint8_t transmitted[CHECK_QUEUE_SIZE];
+static uint32_t transmitted_size;
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Receive_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Transmit_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Error_Interrupt_Callback(&uart_communication);
+}
+
+static void check_callback(uint8_t len, uint8_t* payload){
+	dispatched_frames++;
+	dispatched_len = len;
+	memcpy(dispatched_payload, payload, len);
+}
+
+/*Accepts only payload whose first byte is its length*/
+static void check_length_callback(uint8_t len, uint8_t* payload){
+	if(payload[0] != len){
+		UART_Communication_Reject_Length(&uart_communication);
+		return;
+	}
+	check_callback(len, payload);
+}
+
+static uint8_t check_tx_sink(UART_HandleTypeDef* huart, uint8_t byte){
+	if(transmitted_size < sizeof(transmitted))
+		transmitted[transmitted_size++] = byte;
+	return 1U;
+}
+
+static int check_start(void){
+	memset(&huart, 0, sizeof(huart));
+	huart.Instance = USART1;
+	huart.pTxSink = &check_tx_sink;
+	dispatched_frames = 0;
+	transmitted_size = 0;
+
+	if(UART_Communication_Init(&uart_communication, &huart, CHECK_FRAME_START, CHECK_QUEUE_SIZE) != COMMUNICATION_OK)
+		return -1;
+	if(UART_Communication_Register_Callback(&uart_communication, CHECK_ID, &check_callback) != COMMUNICATION_OK)
+		return -1;
+	return 0;
+}
+
+static void check_parse(void){
+	while(uart_communication.ReadBytesQueue.Size > 0 || uart_communication.CurrentFrame.State == REQUEST_COMPLETE)
+		UART_Communication_Update(&uart_communication);
+}
+
+/*
+ * @brief Receives bytes, error is reported right after byte error_index like HAL_UART_IRQHandler() does
+ * (RxISR first, then the error callback), parser runs only after all bytes
+ * */
+static void check_receive(const uint8_t* pData, uint32_t size, uint32_t error_index, uint32_t error){
+	for(uint32_t i = 0; i < size; i++){
+		HAL_Stub_UART_Receive(&huart, &pData[i], 1);
+		if(i == error_index)
+			HAL_Stub_UART_Error(&huart, error);
+	}
+	check_parse();
+}
+
+static int check_result(const char* name, uint32_t frames, uint32_t dropped){
+	UART_StatisticsTypeDef statistics;
+	UART_Communication_Get_Statistics(&uart_communication, &statistics);
+	UART_Communication_Clean(&uart_communication);
+
+	if(dispatched_frames != frames || statistics.ErrorFramesDropped != dropped){
+		printf("%-28s FAILED: dispatched %u (expected %u), dropped %u (expected %u)\n", name,
+				(unsigned)dispatched_frames, (unsigned)frames, (unsigned)statistics.ErrorFramesDropped, (unsigned)dropped);
+		return -1;
+	}
+	printf("%-28s ok\n", name);
+	return 0;
+}
+
+/*Damaged byte completes the frame, frame must not be dispatched, next frame is*/
+static int check_error_last_byte(uint32_t error){
+	const uint8_t bytes[] = {CHECK_FRAME_START, CHECK_ID, 2, 0x11, 0x99, CHECK_FRAME_START, CHECK_ID, 1, 0x22};
+	if(check_start() != 0)
+		return -1;
+	check_receive(bytes, sizeof(bytes), 4, error);
+	if(dispatched_frames == 1 && (dispatched_len != 1 || dispatched_payload[0] != 0x22))
+		dispatched_frames = 0xFFFFFFFFU;
+
+	const char* name = error == HAL_UART_ERROR_FE ? "framing error on last byte" :
+			error == HAL_UART_ERROR_NE ? "noise error on last byte" : "parity error on last byte";
+	return check_result(name, 1, 1);
+}
+
+static int check_error_middle(void){
+	const uint8_t bytes[] = {CHECK_FRAME_START, CHECK_ID, 3, 0x11, 0x99, 0x33};
+	if(check_start() != 0)
+		return -1;
+	check_receive(bytes, sizeof(bytes), 3, HAL_UART_ERROR_FE);
+	return check_result("framing error in payload", 0, 1);
+}
+
+/*Damaged byte is the start of the next frame, complete frame before it is valid*/
+static int check_error_after_frame(void){
+	const uint8_t bytes[] = {CHECK_FRAME_START, CHECK_ID, 1, 0x11, CHECK_FRAME_START, CHECK_ID, 1, 0x22};
+	if(check_start() != 0)
+		return -1;
+	check_receive(bytes, sizeof(bytes), 4, HAL_UART_ERROR_NE);
+	//damaged start byte is dropped, rest of its frame is skipped as unknown data and isn't a dropped frame
+	return check_result("noise error after frame", 1, 0);
+}
+
+/*Overrun loses bytes after the last received one, frame it ended stays valid*/
+static int check_overrun_after_frame(void){
+	const uint8_t bytes[] = {CHECK_FRAME_START, CHECK_ID, 1, 0x11};
+	if(check_start() != 0)
+		return -1;
+	check_receive(bytes, sizeof(bytes), 3, HAL_UART_ERROR_ORE);
+	return check_result("overrun after frame", 1, 0);
+}
+
+static int check_empty_range(void){
+	const char* name = "empty length range refused";
+	if(check_start() != 0)
+		return -1;
+	UART_CommunicationStatusTypeDef status = UART_Communication_Register_Callback_Length(&uart_communication, CHECK_ID + 1U, &check_callback, 5, 4);
+	UART_Communication_Clean(&uart_communication);
+
+	if(status != COMMUNICATION_RANGE_ERROR){
+		printf("%-28s FAILED: status %d\n", name, (int)status);
+		return -1;
+	}
+	printf("%-28s ok\n", name);
+	return 0;
+}
+
+static int check_reject_length(void){
+	const char* name = "length rejected by callback";
+	const uint8_t bytes[] = {CHECK_FRAME_START, CHECK_ID + 1U, 2, 3, 0x11, CHECK_FRAME_START, CHECK_ID + 1U, 2, 2, 0x22};
+	if(check_start() != 0)
+		return -1;
+	if(UART_Communication_Register_Callback_Length(&uart_communication, CHECK_ID + 1U, &check_length_callback, 1, 16) != COMMUNICATION_OK)
+		return -1;
+	check_receive(bytes, sizeof(bytes), sizeof(bytes), 0);
+
+	UART_StatisticsTypeDef statistics;
+	UART_Communication_Get_Statistics(&uart_communication, &statistics);
+	UART_Communication_Clean(&uart_communication);
+
+	if(dispatched_frames != 1 || statistics.FramesBadLength != 1 || statistics.FramesDispatched != 1){
+		printf("%-28s FAILED: callback %u (expected 1), bad length %u (expected 1), dispatched %u (expected 1)\n", name,
+				(unsigned)dispatched_frames, (unsigned)statistics.FramesBadLength, (unsigned)statistics.FramesDispatched);
+		return -1;
+	}
+	printf("%-28s ok\n", name);
+	return 0;
+}
+
+/*Motor speeds (ID 0x15) whose payload looks like a set speed frame (0x3C 0x12 ...), sent by the library and received back*/
+static int check_escaped_payload(void){
+	const char* name = "frame start in payload";
+	uint8_t payload[] = {CHECK_FRAME_START, 0x12, 0x03, 0x00, 0xFF, 0x7F, 0x7D, 0x00};
+	if(check_start() != 0)
+		return -1;
+
+	//unregistered ID, its payload is skipped by the parser, then the same payload to the callback
+	UART_Communication_Transmit_Frame(&uart_communication, 0x15, sizeof(payload), payload);
+	UART_Communication_Transmit_Frame(&uart_communication, CHECK_ID, sizeof(payload), payload);
+	while(uart_communication.WriteBytesQueue.Size > 0)
+		UART_Communication_Update(&uart_communication);
+
+	uint32_t starts = 0;
+	for(uint32_t i = 0; i < transmitted_size; i++)
+		starts += transmitted[i] == CHECK_FRAME_START;
+
+	check_receive(transmitted, transmitted_size, transmitted_size, 0);
+
+	UART_StatisticsTypeDef statistics;
+	UART_Communication_Get_Statistics(&uart_communication, &statistics);
+	UART_Communication_Clean(&uart_communication);
+
+	if(starts != 2 || dispatched_frames != 1 || dispatched_len != sizeof(payload) || memcmp(dispatched_payload, payload, sizeof(payload)) != 0
+			|| statistics.FramesWithoutCallback != 1 || statistics.Resyncs != 0 || statistics.UnknownBytes != 0){
+		printf("%-28s FAILED: frame starts %u (expected 2), dispatched %u (expected 1), without callback %u (expected 1), resyncs %u, unknown bytes %u\n", name,
+				(unsigned)starts, (unsigned)dispatched_frames, (unsigned)statistics.FramesWithoutCallback,
+				(unsigned)statistics.Resyncs, (unsigned)statistics.UnknownBytes);
+		return -1;
+	}
+	printf("%-28s ok\n", name);
+	return 0;
+}
+
+int main(void){
+	int result = 0;
+	result |= check_error_last_byte(HAL_UART_ERROR_FE);
+	result |= check_error_last_byte(HAL_UART_ERROR_NE);
+	result |= check_error_last_byte(HAL_UART_ERROR_PE);
+	result |= check_error_middle();
+	result |= check_error_after_frame();
+	result |= check_overrun_after_frame();
+	result |= check_empty_range();
+	result |= check_reject_length();
+	result |= check_escaped_payload();
+
+	return result != 0 ? 1 : 0;
+}
@@ -0,0 +1,350 @@
+/*
+ * UART_Replay.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "stm32g4xx_hal.h"
+
+#include "UART_Communication.h"
+#include "Rover_Capture.h"
+#include "Rover_Frame.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/*
+ * Replays one link of a capture (Rover_Gateway -c) through host build of UART_Communication
+ * usage: UART_Replay [-l link] [-r] [-i ID,ID,...] [-k frame_start] capture_file
+ * 	-l name of the link (default first link of the capture)
+ * 	-r replays bytes received from the controller instead of bytes sent to it
+ * 	-i registers callbacks only for given IDs (hex), by default every not reserved ID found in the replayed bytes has a callback
+ * 	-k frame start byte (default ROVER_FRAME_START)
+ *
+ * ALGORITHM
+ * 1. Unless -i is given, replayed bytes are decoded once to find IDs which need callbacks
+ *    (registering all of them would make statistics response too long to be sent)
+ * 2. Every record of the link is delivered at its timestamp in virtual time (HAL_Stub_Set_Time()),
+ *    so cycle counter values taken by the library are the same in every run
+ * 3. Bytes go through receive interrupt emulation in bursts of REPLAY_BURST_SIZE (like in virtual rover)
+ *    and UART_Communication_Update() drains read queue after every burst, like main loop
+ * 4. Same bytes are fed to Rover_Decoder (reference parser), frames completed by the burst are compared:
+ * 		- ID and length of every frame
+ * 		- payload (FNV-1a) of frames passed to callbacks
+ * 		- dispatch time (trace record) with capture time of the record which completed the frame
+ * 5. Wall clock time spent in the library is measured, so replay is also a benchmark of real traffic
+ * Exit code is 1 if any frame differs, so capture can be used as a regression test.
+ * */
+//same as main.c and Virtual_Rover.h
+#define REPLAY_QUEUE_SIZE 256U
+#define REPLAY_BURST_SIZE 64U
+//frames completed by one burst, at most one per 3 bytes
+#define REPLAY_PENDING_FRAMES 64U
+//mismatches printed in detail
+#define REPLAY_MAX_REPORTED 10U
+
+typedef struct {
+	uint32_t Time;
+	uint32_t Hash;
+	uint8_t ID;
+	uint8_t Length;
+} Replay_FrameTypeDef;
+
+typedef struct {
+	Replay_FrameTypeDef Frames[REPLAY_PENDING_FRAMES];
+	uint32_t Count;
+} Replay_PendingTypeDef;
+
+static UART_HandleTypeDef huart;
+static UART_CommunicationTypeDef uart_communication;
+static Rover_DecoderTypeDef replay_decoder;
+
+static uint8_t replay_registered[256];
+static uint8_t replay_link;
+static uint8_t replay_direction = ROVER_CAPTURE_TX;
+static uint64_t replay_time;
+
+static Replay_PendingTypeDef replay_reference;
+static Replay_PendingTypeDef replay_library;
+//payload hash of the frame passed to the callback during last UART_Communication_Update()
+static uint32_t replay_callback_hash;
+static uint32_t replay_trace_count;
+
+//results
+static uint64_t replay_bytes;
+static uint64_t replay_records;
+static uint64_t replay_frames;
+static uint64_t replay_payload_bytes;
+static uint64_t replay_mismatches;
+static uint64_t replay_lost_bytes;
+static uint64_t replay_response_bytes;
+static uint64_t replay_elapsed;
+static uint64_t replay_first_time;
+//first byte to dispatch time in virtual time, shows how frames were spread over chunks of the capture
+static uint64_t replay_latency_sum;
+static uint32_t replay_latency_max;
+
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Receive_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Transmit_Interrupt_Callback(&uart_communication);
+}
+
+void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart){
+	UART_Communication_Error_Interrupt_Callback(&uart_communication);
+}
+
+static uint64_t replay_now(void){
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec;
+}
+
+static uint32_t replay_hash(const uint8_t* data, uint8_t len){
+	uint32_t hash = 2166136261U;
+	for(uint8_t i = 0; i < len; i++)
+		hash = (hash ^ data[i]) * 16777619U;
+	return hash;
+}
+
+static void replay_push(Replay_PendingTypeDef* pPending, uint32_t time, uint8_t ID, uint8_t len, uint32_t hash){
+	if(pPending->Count == REPLAY_PENDING_FRAMES)
+		return;
+	Replay_FrameTypeDef* pFrame = &pPending->Frames[pPending->Count++];
+	pFrame->Time = time;
+	pFrame->Hash = hash;
+	pFrame->ID = ID;
+	pFrame->Length = len;
+}
+
+/*Callback registered in the library, ID is taken from the frame being dispatched*/
+static void replay_callback(uint8_t len, uint8_t* payload){
+	replay_callback_hash = replay_hash(payload, len);
+}
+
+/*Callback of the reference decoder*/
+static void replay_reference_frame(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	uint32_t hash = ID < UART_COMMUNICATION_RESERVED_ID_FIRST && replay_registered[ID] ? replay_hash(payload, len) : 0U;
+	replay_push(&replay_reference, (uint32_t)replay_time, ID, len, hash);
+}
+
+static uint8_t replay_tx_sink(UART_HandleTypeDef* huart, uint8_t byte){
+	replay_response_bytes++;
+	return 1U;
+}
+
+/*Every completed frame leaves trace record, callback frames have their payload hashed*/
+static void replay_library_update(void){
+	replay_callback_hash = 0;
+	UART_Communication_Update(&uart_communication);
+	if(uart_communication.Trace.Count == replay_trace_count)
+		return;
+
+	replay_trace_count = uart_communication.Trace.Count;
+	const UART_TraceRecordTypeDef* pRecord = &uart_communication.Trace.Records[(replay_trace_count - 1U) % UART_TRACE_DEPTH];
+	uint32_t hash = (pRecord->Flags & UART_TRACE_FLAG_CALLBACK) ? replay_callback_hash : 0U;
+	replay_push(&replay_library, pRecord->DispatchStart, pRecord->ID, pRecord->Length, hash);
+
+	uint32_t latency = pRecord->DispatchStart - pRecord->FirstByte;
+	replay_latency_sum += latency;
+	if(latency > replay_latency_max)
+		replay_latency_max = latency;
+}
+
+static void replay_report_mismatch(const char* reason, const Replay_FrameTypeDef* pReference, const Replay_FrameTypeDef* pLibrary){
+	replay_mismatches++;
+	if(replay_mismatches > REPLAY_MAX_REPORTED)
+		return;
+
+	double time = (double)(replay_time - replay_first_time) / 1e9;
+	printf("frame %llu at %.6f s: %s", (unsigned long long)replay_frames, time, reason);
+	if(pReference != NULL)
+		printf(", reference %02x len %u", (unsigned)pReference->ID, (unsigned)pReference->Length);
+	if(pLibrary != NULL)
+		printf(", library %02x len %u", (unsigned)pLibrary->ID, (unsigned)pLibrary->Length);
+	printf("\n");
+}
+
+/*Frames completed by the burst have to be the same on both sides*/
+static void replay_compare(void){
+	uint32_t count = replay_reference.Count > replay_library.Count ? replay_reference.Count : replay_library.Count;
+
+	for(uint32_t i = 0; i < count; i++){
+		const Replay_FrameTypeDef* pReference = i < replay_reference.Count ? &replay_reference.Frames[i] : NULL;
+		const Replay_FrameTypeDef* pLibrary = i < replay_library.Count ? &replay_library.Frames[i] : NULL;
+
+		if(pReference == NULL)
+			replay_report_mismatch("frame not found by reference parser", NULL, pLibrary);
+		else if(pLibrary == NULL)
+			replay_report_mismatch("frame not dispatched by library", pReference, NULL);
+		else if(pReference->ID != pLibrary->ID || pReference->Length != pLibrary->Length)
+			replay_report_mismatch("different frame", pReference, pLibrary);
+		else if(pReference->Hash != pLibrary->Hash)
+			replay_report_mismatch("different payload", pReference, pLibrary);
+		else if(pReference->Time != pLibrary->Time)
+			replay_report_mismatch("dispatched late", pReference, pLibrary);
+
+		if(pReference != NULL){
+			replay_frames++;
+			replay_payload_bytes += pReference->Length;
+		}
+	}
+
+	replay_reference.Count = 0;
+	replay_library.Count = 0;
+}
+
+static int replay_record(void* pContext, const Rover_CaptureRecordTypeDef* pRecord, const uint8_t* data){
+	if(pRecord->Link != replay_link || pRecord->Direction != replay_direction)
+		return 0;
+
+	if(replay_records == 0)
+		replay_first_time = pRecord->Timestamp;
+	replay_records++;
+	replay_bytes += pRecord->Length;
+	replay_time = pRecord->Timestamp;
+	HAL_Stub_Set_Time(replay_time);
+
+	for(uint32_t offset = 0; offset < pRecord->Length; offset += REPLAY_BURST_SIZE){
+		uint32_t burst = pRecord->Length - offset < REPLAY_BURST_SIZE ? pRecord->Length - offset : REPLAY_BURST_SIZE;
+
+		uint64_t start = replay_now();
+		replay_lost_bytes += HAL_Stub_UART_Receive(&huart, &data[offset], burst);
+		while(uart_communication.ReadBytesQueue.Size > 0)
+			replay_library_update();
+		replay_elapsed += replay_now() - start;
+
+		Rover_Decoder_Feed(&replay_decoder, &data[offset], burst);
+		replay_compare();
+	}
+	return 0;
+}
+
+static void replay_scan_frame(void* pContext, uint8_t ID, uint8_t len, const uint8_t* payload){
+	if(ID < UART_COMMUNICATION_RESERVED_ID_FIRST)
+		replay_registered[ID] = 1U;
+}
+
+static int replay_scan_record(void* pContext, const Rover_CaptureRecordTypeDef* pRecord, const uint8_t* data){
+	if(pRecord->Link == replay_link && pRecord->Direction == replay_direction)
+		Rover_Decoder_Feed(pContext, data, pRecord->Length);
+	return 0;
+}
+
+static int replay_parse_ids(const char* list){
+	memset(replay_registered, 0, sizeof(replay_registered));
+	while(*list != '\0'){
+		char* pEnd;
+		unsigned long ID = strtoul(list, &pEnd, 16);
+		if(pEnd == list || ID >= UART_COMMUNICATION_RESERVED_ID_FIRST)
+			return -1;
+		replay_registered[ID] = 1U;
+		list = *pEnd == ',' ? pEnd + 1 : pEnd;
+		if(*pEnd != ',' && *pEnd != '\0')
+			return -1;
+	}
+	return 0;
+}
+
+int main(int argc, char** argv){
+	const char* link_name = NULL;
+	uint8_t frame_start = ROVER_FRAME_START;
+	int ids_given = 0;
+
+	int option;
+	while((option = getopt(argc, argv, "l:ri:k:")) != -1){
+		switch(option){
+			case 'l':
+				link_name = optarg;
+				break;
+			case 'r':
+				replay_direction = ROVER_CAPTURE_RX;
+				break;
+			case 'i':
+				if(replay_parse_ids(optarg) != 0)
+					optind = argc + 1;
+				ids_given = 1;
+				break;
+			case 'k':
+				frame_start = (uint8_t)strtoul(optarg, NULL, 0);
+				break;
+			default:
+				optind = argc + 1;
+				break;
+		}
+	}
+	if(optind != argc - 1){
+		fprintf(stderr, "usage: %s [-l link] [-r] [-i ID,ID,...] [-k frame_start] capture_file\n", argv[0]);
+		return 2;
+	}
+
+	Rover_CaptureReaderTypeDef reader;
+	Rover_CaptureStatusTypeDef status = Rover_Capture_Map(&reader, argv[optind]);
+	if(status != ROVER_CAPTURE_OK){
+		if(status == ROVER_CAPTURE_FORMAT_ERROR)
+			fprintf(stderr, "%s: not a capture file\n", argv[optind]);
+		else
+			perror(argv[optind]);
+		return 1;
+	}
+
+	const Rover_CaptureHeaderTypeDef* pHeader = reader.pHeader;
+	if(pHeader->LinkCount == 0){
+		fprintf(stderr, "%s: capture has no links\n", argv[optind]);
+		return 1;
+	}
+	for(replay_link = 0; link_name != NULL && replay_link < pHeader->LinkCount; replay_link++){
+		if(strncmp(pHeader->LinkNames[replay_link], link_name, ROVER_CAPTURE_MAX_NAME) == 0)
+			break;
+	}
+	if(replay_link == pHeader->LinkCount){
+		fprintf(stderr, "%s: no link %s\n", argv[optind], link_name);
+		return 1;
+	}
+
+	if(!ids_given){
+		Rover_Decoder_Init(&replay_decoder, frame_start, &replay_scan_frame, NULL);
+		Rover_Capture_Iterate(&reader, 0, &replay_scan_record, &replay_decoder);
+	}
+
+	//library starts in virtual time of the capture, before its first record
+	HAL_Stub_Set_Time(pHeader->StartMonotonic);
+	memset(&huart, 0, sizeof(huart));
+	huart.pTxSink = &replay_tx_sink;
+	if(UART_Communication_Init(&uart_communication, &huart, frame_start, REPLAY_QUEUE_SIZE) != COMMUNICATION_OK)
+		return 1;
+	for(uint32_t ID = 0; ID < UART_COMMUNICATION_RESERVED_ID_FIRST; ID++){
+		if(replay_registered[ID] && UART_Communication_Register_Callback(&uart_communication, (uint8_t)ID, &replay_callback) != COMMUNICATION_OK)
+			return 1;
+	}
+	Rover_Decoder_Init(&replay_decoder, frame_start, &replay_reference_frame, NULL);
+
+	status = Rover_Capture_Iterate(&reader, 0, &replay_record, NULL);
+	if(status == ROVER_CAPTURE_FORMAT_ERROR)
+		fprintf(stderr, "%s: damaged block, replayed up to it\n", argv[optind]);
+
+	double duration = (double)(replay_time - replay_first_time) / 1e9;
+	double seconds = (double)replay_elapsed / 1e9;
+	printf("link %s %s: %llu bytes in %llu records over %.3f s of capture\n", pHeader->LinkNames[replay_link],
+			replay_direction == ROVER_CAPTURE_TX ? "sent to controller" : "received from controller",
+			(unsigned long long)replay_bytes, (unsigned long long)replay_records, duration);
+	printf("frames: %llu (average payload %.1f bytes), %llu resyncs, %llu unknown bytes, %llu lost bytes, %llu response bytes\n",
+			(unsigned long long)replay_frames, replay_frames > 0 ? (double)replay_payload_bytes / (double)replay_frames : 0.0,
+			(unsigned long long)replay_decoder.Resyncs, (unsigned long long)replay_decoder.UnknownBytes,
+			(unsigned long long)replay_lost_bytes, (unsigned long long)replay_response_bytes);
+	if(replay_frames > 0)
+		printf("first byte to dispatch (virtual time): average %.1f us, max %.1f us\n",
+				(double)replay_latency_sum / (double)replay_frames / 1e3, (double)replay_latency_max / 1e3);
+	if(replay_bytes > 0 && seconds > 0)
+		printf("library: %.3f ms, %.0f frames/s, %.2f MB/s, %.2f ns/byte\n", seconds * 1e3, (double)replay_frames / seconds,
+				(double)replay_bytes / seconds / 1e6, (double)replay_elapsed / (double)replay_bytes);
+	printf("%llu mismatches\n", (unsigned long long)replay_mismatches);
+
+	UART_Communication_Clean(&uart_communication);
+	Rover_Capture_Unmap(&reader);
+	return replay_mismatches > 0 || status == ROVER_CAPTURE_FORMAT_ERROR ? 1 : 0;
+}
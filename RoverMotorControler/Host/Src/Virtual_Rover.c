@@ -0,0 +1,309 @@
+/*
+ * Virtual_Rover.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#define _GNU_SOURCE
+#include "Virtual_Rover.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/timerfd.h>
+
+/*Defined in main.c*/
+extern UART_HandleTypeDef huart1;
+extern Motor_ControlTypeDef motor_control;
+
+static int rover_master_fd = -1;
+/*Slave side is kept open, so pty works (and keeps raw mode) when no client is connected*/
+static int rover_slave_fd = -1;
+static int rover_tick_fd = -1;
+/*TIM6, armed with motor_control.Rate once Motor_Control_Init() has run*/
+static int rover_control_fd = -1;
+static uint32_t rover_control_rate;
+
+static const char* rover_link_path;
+static int rover_quiet;
+
+/*Simulated wheel, speed follows duty of the wheel with first order lag*/
+typedef struct {
+	//counts per second
+	double Speed;
+	//position in counts
+	double Position;
+	//time of the wheel model in microseconds, advanced by one control tick per read
+	double Time;
+	//counter captured on the last edge and time base value copied by "DMA"
+	uint16_t EdgePosition;
+	uint16_t EdgeTime;
+} Virtual_Rover_WheelTypeDef;
+
+static Virtual_Rover_WheelTypeDef rover_wheels[MOTOR_WHEEL_COUNT];
+
+/*Bytes transmitted by firmware, waiting to be written to pty*/
+static uint8_t rover_tx_buffer[VIRTUAL_ROVER_TX_BUFFER_SIZE];
+static uint32_t rover_tx_head;
+static uint32_t rover_tx_count;
+
+/*Writes as much of the buffer as pty accepts without blocking*/
+static void rover_tx_write(void){
+	while(rover_tx_count > 0){
+		uint32_t chunk = VIRTUAL_ROVER_TX_BUFFER_SIZE - rover_tx_head;
+		if(chunk > rover_tx_count)
+			chunk = rover_tx_count;
+
+		ssize_t written = write(rover_master_fd, &rover_tx_buffer[rover_tx_head], chunk);
+		if(written <= 0)
+			return;
+
+		rover_tx_head = (rover_tx_head + (uint32_t)written) % VIRTUAL_ROVER_TX_BUFFER_SIZE;
+		rover_tx_count -= (uint32_t)written;
+	}
+}
+
+/*TIM6 interrupt, control loop runs at the rate it was initialized with, timer counts periods which passed while main loop was busy*/
+static void rover_control_tick(void){
+	if(motor_control.Rate != rover_control_rate){
+		rover_control_rate = motor_control.Rate;
+		long interval = rover_control_rate > 0 ? (long)(1000000000U / rover_control_rate) : 0;
+		struct itimerspec period = {
+			.it_interval = {.tv_sec = 0, .tv_nsec = interval},
+			.it_value = {.tv_sec = 0, .tv_nsec = interval},
+		};
+		timerfd_settime(rover_control_fd, 0, &period, NULL);
+	}
+
+	uint64_t expirations;
+	if(read(rover_control_fd, &expirations, sizeof(expirations)) == sizeof(expirations)){
+		while(expirations--)
+			Motor_Control_Timer_Interrupt_Callback(&motor_control);
+	}
+}
+
+/*SysTick, timer counts periods which passed while main loop was busy*/
+static void rover_systick(void){
+	uint64_t expirations;
+	if(read(rover_tick_fd, &expirations, sizeof(expirations)) == sizeof(expirations)){
+		while(expirations--)
+			HAL_IncTick();
+	}
+	rover_control_tick();
+	if(HAL_Stub_IWDG_Expired()){
+		fprintf(stderr, "virtual rover: IWDG reset, main loop was stalled\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static uint8_t rover_tx_sink(UART_HandleTypeDef* huart, uint8_t byte){
+	//full buffer plays the role of the line speed, transmission waits until pty takes some bytes
+	if(rover_tx_count == VIRTUAL_ROVER_TX_BUFFER_SIZE)
+		return 0U;
+	rover_tx_buffer[(rover_tx_head + rover_tx_count) % VIRTUAL_ROVER_TX_BUFFER_SIZE] = byte;
+	rover_tx_count++;
+
+	//firmware which transmits all the time doesn't reach __WFI(), client gets data while it is generated
+	//and SysTick keeps running
+	if(rover_tx_count % VIRTUAL_ROVER_TX_WRITE_SIZE == 0U){
+		rover_tx_write();
+		rover_systick();
+	}
+	return 1U;
+}
+
+static void rover_tx_flush(void){
+	rover_tx_write();
+	//USART1 transmit interrupt of the byte which was waiting for space
+	while(huart1.TxXferCount > 0U && rover_tx_count < VIRTUAL_ROVER_TX_BUFFER_SIZE)
+		HAL_Stub_UART_Transmit_Resume(&huart1);
+}
+
+/*Called by __WFI() in Idle_Sleep_Update(), returns after at least one "interrupt" was handled*/
+void HAL_Stub_WFI(void){
+	rover_tx_flush();
+
+	//timer of the control loop is armed when main loop sleeps for the first time, after Motor_Control_Init()
+	rover_control_tick();
+
+	struct pollfd fds[3] = {
+		{.fd = rover_master_fd, .events = POLLIN | (rover_tx_count > 0 ? POLLOUT : 0)},
+		{.fd = rover_tick_fd, .events = POLLIN},
+		{.fd = rover_control_fd, .events = POLLIN},
+	};
+
+	if(poll(fds, 3, -1) < 0){
+		if(errno == EINTR)
+			return;
+		perror("virtual rover: poll");
+		exit(EXIT_FAILURE);
+	}
+
+	if((fds[1].revents | fds[2].revents) & POLLIN)
+		rover_systick();
+
+	//USART1 receive interrupt
+	if(fds[0].revents & POLLIN){
+		uint8_t burst[VIRTUAL_ROVER_RX_BURST];
+		ssize_t received = read(rover_master_fd, burst, sizeof(burst));
+		if(received > 0)
+			HAL_Stub_UART_Receive(&huart1, burst, (uint32_t)received);
+	}
+
+	//USART1 transmit, pty has space again
+	if(fds[0].revents & POLLOUT)
+		rover_tx_flush();
+}
+
+void Virtual_Rover_Log_Callback(const char* name, uint8_t len, const uint8_t* payload){
+	if(rover_quiet)
+		return;
+
+	printf("[%10lu ms] %s len %u:", (unsigned long)HAL_GetTick(), name, (unsigned)len);
+	for(uint8_t i = 0; i < len; i++)
+		printf(" %02x", payload[i]);
+	printf("\n");
+}
+
+/*Largest integer not greater than value (floor() without libm)*/
+static int64_t rover_floor(double value){
+	int64_t result = (int64_t)value;
+	return (double)result > value ? result - 1 : result;
+}
+
+/*Multiple of MOTOR_ENCODER_COUNTS_PER_EDGE not greater than position*/
+static double rover_edge_below(double position){
+	return (double)(rover_floor(position / MOTOR_ENCODER_COUNTS_PER_EDGE) * MOTOR_ENCODER_COUNTS_PER_EDGE);
+}
+
+void Virtual_Rover_Encoder_Read(uint8_t index, uint32_t tick_time, uint16_t* pCount, uint16_t* pEdgePosition, uint16_t* pEdgeTime){
+	Virtual_Rover_WheelTypeDef* pModel = &rover_wheels[index];
+	const Motor_WheelTypeDef* pWheel = &motor_control.Wheels[index];
+
+	double dt = tick_time * 1e-6;
+	//duty applied by the bridge (it is 0 for one tick when direction changes)
+	double target = (double)motor_control.PWM.Duty[index] / MOTOR_Q15_ONE * pWheel->Encoder.MaxSpeed;
+	pModel->Speed += (target - pModel->Speed) * dt / VIRTUAL_ROVER_WHEEL_TIME_CONSTANT;
+
+	double start = pModel->Position;
+	double end = start + pModel->Speed * dt;
+
+	//last edge crossed in this tick, moving forward it is the edge below the end, moving backward the edge above it
+	double edge = end >= start ? rover_edge_below(end) : rover_edge_below(end) + MOTOR_ENCODER_COUNTS_PER_EDGE;
+	if(end != start && (end >= start ? edge > start : edge < start)){
+		double edge_time = pModel->Time + tick_time * (edge - start) / (end - start);
+		pModel->EdgePosition = (uint16_t)(int64_t)edge;
+		pModel->EdgeTime = (uint16_t)(uint64_t)edge_time;
+	}
+
+	pModel->Position = end;
+	pModel->Time += tick_time;
+
+	*pCount = (uint16_t)rover_floor(end);
+	*pEdgePosition = pModel->EdgePosition;
+	*pEdgeTime = pModel->EdgeTime;
+}
+
+int16_t Virtual_Rover_Current_Read(uint8_t index){
+	const Virtual_Rover_WheelTypeDef* pModel = &rover_wheels[index];
+	const Motor_WheelTypeDef* pWheel = &motor_control.Wheels[index];
+
+	double back_emf = pModel->Speed / pWheel->Encoder.MaxSpeed * MOTOR_Q15_ONE;
+	return (int16_t)Motor_Q15_Saturate((int32_t)(motor_control.PWM.Duty[index] - back_emf));
+}
+
+void Virtual_Rover_Error_Handler(void){
+	fprintf(stderr, "virtual rover: Error_Handler() called\n");
+	exit(EXIT_FAILURE);
+}
+
+static void rover_signal_handler(int signal){
+	if(rover_link_path != NULL)
+		unlink(rover_link_path);
+	_exit(0);
+}
+
+static int rover_open_pty(void){
+	rover_master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if(rover_master_fd < 0 || grantpt(rover_master_fd) != 0 || unlockpt(rover_master_fd) != 0)
+		return -1;
+
+	const char* slave_path = ptsname(rover_master_fd);
+	if(slave_path == NULL)
+		return -1;
+
+	rover_slave_fd = open(slave_path, O_RDWR | O_NOCTTY);
+	if(rover_slave_fd < 0)
+		return -1;
+
+	//binary protocol, no echo, no line editing, no CR/LF translation
+	struct termios tio;
+	if(tcgetattr(rover_slave_fd, &tio) != 0)
+		return -1;
+	cfmakeraw(&tio);
+	if(tcsetattr(rover_slave_fd, TCSANOW, &tio) != 0)
+		return -1;
+
+	if(rover_link_path != NULL){
+		unlink(rover_link_path);
+		if(symlink(slave_path, rover_link_path) != 0)
+			return -1;
+	}
+
+	printf("%s\n", slave_path);
+	return 0;
+}
+
+static int rover_open_systick(void){
+	rover_tick_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	rover_control_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if(rover_tick_fd < 0 || rover_control_fd < 0)
+		return -1;
+
+	struct itimerspec period = {
+		.it_interval = {.tv_sec = 0, .tv_nsec = 1000000},
+		.it_value = {.tv_sec = 0, .tv_nsec = 1000000},
+	};
+	return timerfd_settime(rover_tick_fd, 0, &period, NULL);
+}
+
+int main(int argc, char** argv){
+	int option;
+	while((option = getopt(argc, argv, "l:q")) != -1){
+		switch(option){
+			case 'l':
+				rover_link_path = optarg;
+				break;
+			case 'q':
+				rover_quiet = 1;
+				break;
+			default:
+				fprintf(stderr, "usage: %s [-l link to pty] [-q]\n", argv[0]);
+				return 2;
+		}
+	}
+
+	//callbacks are logged line by line, so they can be followed with a pipe
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	if(rover_open_pty() != 0){
+		perror("virtual rover: pty");
+		return 1;
+	}
+	if(rover_open_systick() != 0){
+		perror("virtual rover: SysTick timer");
+		return 1;
+	}
+
+	signal(SIGINT, rover_signal_handler);
+	signal(SIGTERM, rover_signal_handler);
+
+	huart1.pTxSink = &rover_tx_sink;
+
+	return Firmware_Main();
+}
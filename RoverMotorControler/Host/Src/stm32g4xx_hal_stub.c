@@ -0,0 +1,242 @@
+/*
+ * stm32g4xx_hal_stub.c
+ *
+ *  Created on: Oct 18, 2026
+ */
+#include "stm32g4xx_hal.h"
+
+#include <time.h>
+
+uint32_t HAL_Stub_PRIMASK = 0;
+uint32_t HAL_Stub_IPSR = 0;
+uint32_t SystemCoreClock = 1000000000U;
+CoreDebug_Type HAL_Stub_CoreDebug;
+
+USART_TypeDef HAL_Stub_USART1;
+IWDG_TypeDef HAL_Stub_IWDG;
+
+static DWT_Type hal_stub_dwt;
+
+/*Set by HAL_Stub_Set_Time(), host clock is not read anymore*/
+static uint8_t hal_stub_virtual_time;
+static uint64_t hal_stub_time_ns;
+
+/*Incremented by HAL_IncTick()*/
+static volatile uint32_t hal_stub_tick;
+
+/*IWDG timeout in ms, 0 until HAL_IWDG_Init() is called*/
+static uint32_t hal_stub_iwdg_timeout;
+static uint32_t hal_stub_iwdg_refresh_tick;
+
+DWT_Type* HAL_Stub_DWT(void){
+	if(hal_stub_virtual_time){
+		hal_stub_dwt.CYCCNT = (uint32_t)hal_stub_time_ns;
+		return &hal_stub_dwt;
+	}
+
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	//counter wraps around every ~4.3s, same as 32bit CYCCNT would at 1GHz
+	hal_stub_dwt.CYCCNT = (uint32_t)((uint64_t)now.tv_sec*1000000000U + (uint64_t)now.tv_nsec);
+	return &hal_stub_dwt;
+}
+
+void HAL_Stub_Set_Time(uint64_t time_ns){
+	hal_stub_virtual_time = 1U;
+	hal_stub_time_ns = time_ns;
+	hal_stub_tick = (uint32_t)(time_ns / 1000000U);
+}
+
+__attribute__((weak)) void HAL_Stub_WFI(void){
+}
+
+HAL_StatusTypeDef HAL_Init(void){
+	hal_stub_tick = 0;
+	return HAL_OK;
+}
+
+void HAL_IncTick(void){
+	hal_stub_tick++;
+}
+
+uint32_t HAL_GetTick(void){
+	return hal_stub_tick;
+}
+
+HAL_StatusTypeDef HAL_PWREx_ControlVoltageScaling(uint32_t VoltageScaling){
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_OscConfig(RCC_OscInitTypeDef* RCC_OscInitStruct){
+	return RCC_OscInitStruct == NULL ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_RCC_ClockConfig(RCC_ClkInitTypeDef* RCC_ClkInitStruct, uint32_t FLatency){
+	//SystemCoreClock stays at 1GHz, cycle counter is based on host clock
+	return RCC_ClkInitStruct == NULL ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Init(IWDG_HandleTypeDef* hiwdg){
+	if(hiwdg == NULL || hiwdg->Init.Prescaler > IWDG_PRESCALER_256)
+		return HAL_ERROR;
+
+	//counter is clocked by 32kHz LSI divided by 4 << Prescaler
+	hal_stub_iwdg_timeout = (uint32_t)(((uint64_t)hiwdg->Init.Reload + 1U) * (4U << hiwdg->Init.Prescaler) / 32U);
+	hal_stub_iwdg_refresh_tick = hal_stub_tick;
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_IWDG_Refresh(IWDG_HandleTypeDef* hiwdg){
+	hal_stub_iwdg_refresh_tick = hal_stub_tick;
+	return HAL_OK;
+}
+
+uint32_t HAL_Stub_IWDG_Expired(void){
+	return hal_stub_iwdg_timeout > 0U && hal_stub_tick - hal_stub_iwdg_refresh_tick > hal_stub_iwdg_timeout;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef* huart){
+	return huart == NULL ? HAL_ERROR : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetTxFifoThreshold(UART_HandleTypeDef* huart, uint32_t Threshold){
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_SetRxFifoThreshold(UART_HandleTypeDef* huart, uint32_t Threshold){
+	return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UARTEx_DisableFifoMode(UART_HandleTypeDef* huart){
+	return HAL_OK;
+}
+
+__attribute__((weak)) void HAL_UART_RxCpltCallback(UART_HandleTypeDef* huart){
+	(void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_TxCpltCallback(UART_HandleTypeDef* huart){
+	(void)huart;
+}
+
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef* huart){
+	(void)huart;
+}
+
+HAL_StatusTypeDef HAL_UART_Receive_IT(UART_HandleTypeDef* huart, uint8_t* pData, uint16_t Size){
+	if(huart == NULL || pData == NULL || Size == 0U)
+		return HAL_ERROR;
+
+	//previous reception has not completed yet
+	if(huart->RxXferCount > 0U)
+		return HAL_BUSY;
+
+	huart->pRxBuffPtr = pData;
+	huart->RxXferCount = Size;
+
+	return HAL_OK;
+}
+
+/*Passes bytes to the sink until it refuses one*/
+static void hal_stub_tx_push(UART_HandleTypeDef* huart){
+	while(huart->TxXferCount > 0U){
+		if(huart->pTxSink != NULL && !huart->pTxSink(huart, *huart->pTxBuffPtr))
+			return;
+		huart->pTxBuffPtr++;
+		huart->TxXferCount--;
+	}
+}
+
+/*Transmit complete interrupt*/
+static void hal_stub_tx_complete(UART_HandleTypeDef* huart){
+	huart->TxPending = 1U;
+	//we are inside of the callback, next completion is delivered after it returns
+	if(huart->InTxCallback)
+		return;
+
+	huart->InTxCallback = 1U;
+	uint32_t ipsr = HAL_Stub_IPSR;
+	HAL_Stub_IPSR = HAL_STUB_USART1_IPSR;
+	while(huart->TxPending){
+		huart->TxPending = 0U;
+		HAL_UART_TxCpltCallback(huart);
+	}
+	HAL_Stub_IPSR = ipsr;
+	huart->InTxCallback = 0U;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_IT(UART_HandleTypeDef* huart, const uint8_t* pData, uint16_t Size){
+	if(huart == NULL || pData == NULL || Size == 0U)
+		return HAL_ERROR;
+
+	//previous transmission is still waiting for the sink
+	if(huart->TxXferCount > 0U)
+		return HAL_BUSY;
+
+	//the "wire" is infinitely fast, bytes are sent at once unless sink refuses them
+	huart->pTxBuffPtr = pData;
+	huart->TxXferCount = Size;
+	hal_stub_tx_push(huart);
+	if(huart->TxXferCount == 0U)
+		hal_stub_tx_complete(huart);
+
+	return HAL_OK;
+}
+
+uint32_t HAL_Stub_UART_Transmit_Resume(UART_HandleTypeDef* huart){
+	if(huart == NULL || huart->TxXferCount == 0U)
+		return 0;
+
+	hal_stub_tx_push(huart);
+	if(huart->TxXferCount == 0U)
+		hal_stub_tx_complete(huart);
+
+	return huart->TxXferCount;
+}
+
+void HAL_Stub_UART_Error(UART_HandleTypeDef* huart, uint32_t error){
+	if(huart == NULL)
+		return;
+
+	uint32_t ipsr = HAL_Stub_IPSR;
+	HAL_Stub_IPSR = HAL_STUB_USART1_IPSR;
+
+	huart->ErrorCode |= error;
+	//blocking error, HAL ends the reception before the callback
+	if(error & HAL_UART_ERROR_ORE){
+		huart->pRxBuffPtr = NULL;
+		huart->RxXferCount = 0U;
+	}
+	HAL_UART_ErrorCallback(huart);
+	huart->ErrorCode = HAL_UART_ERROR_NONE;
+
+	HAL_Stub_IPSR = ipsr;
+}
+
+uint32_t HAL_Stub_UART_Receive(UART_HandleTypeDef* huart, const uint8_t* pData, uint32_t Size){
+	if(huart == NULL || pData == NULL)
+		return Size;
+
+	uint32_t lost = 0;
+	uint32_t ipsr = HAL_Stub_IPSR;
+	HAL_Stub_IPSR = HAL_STUB_USART1_IPSR;
+
+	for(uint32_t i = 0; i < Size; i++){
+		//nobody is waiting for the byte, real UART would report overrun
+		if(huart->RxXferCount == 0U){
+			lost++;
+			HAL_Stub_UART_Error(huart, HAL_UART_ERROR_ORE);
+			continue;
+		}
+
+		*huart->pRxBuffPtr++ = pData[i];
+		huart->RxXferCount--;
+
+		if(huart->RxXferCount == 0U)
+			HAL_UART_RxCpltCallback(huart);
+	}
+
+	HAL_Stub_IPSR = ipsr;
+	return lost;
+}